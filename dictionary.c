@@ -6,25 +6,82 @@
 #include <storage/storage.h>
 #include <gui/gui.h>
 #include <gui/modules/submenu.h>
-#include <gui/modules/text_input.h>
 #include <gui/modules/text_box.h>
 #include <gui/view_dispatcher.h>
 #include <input/input.h>
 #include <ctype.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <toolbox/stream/file_stream.h>
 #include <toolbox/stream/buffered_file_stream.h>
 
+#include "dictionary_history.h"
+#include "dictionary_result_view.h"
+#include "dictionary_search_view.h"
+#include "dictionary_storage_furi.h"
+#include "dictionary_worker.h"
+
 #define APP_NAME "Dictionary"
 #define VERSION  "V1"
 
-#define DICTIONARY_APP_ASSETS_PATH EXT_PATH("apps_assets/dictionary")
-#define DICTIONARY_IDX_PATH        DICTIONARY_APP_ASSETS_PATH "/engdict.idx"
-#define DICTIONARY_DAT_PATH        DICTIONARY_APP_ASSETS_PATH "/engdict.dat"
-#define DICTIONARY_HISTORY_PATH    DICTIONARY_APP_ASSETS_PATH "/history.txt" // History file path
-#define MAX_HISTORY_ITEMS          10
-#define MAX_WORD_LENGTH            50
+#define DICTIONARY_APP_ASSETS_PATH  EXT_PATH("apps_assets/dictionary")
+#define DICTIONARY_IDX_PATH         DICTIONARY_APP_ASSETS_PATH "/engdict.idx"
+#define DICTIONARY_DAT_PATH         DICTIONARY_APP_ASSETS_PATH "/engdict.dat"
+#define DICTIONARY_HISTORY_PATH     DICTIONARY_APP_ASSETS_PATH "/history.bin" // History journal
+#define DICTIONARY_HISTORY_TMP_PATH DICTIONARY_APP_ASSETS_PATH "/history.tmp" // Compacted journal
+#define DICTIONARY_HISTORY_TXT_PATH DICTIONARY_APP_ASSETS_PATH "/history.txt" // Before the journal
+#define DICTIONARY_CACHE_PATH       DICTIONARY_APP_ASSETS_PATH "/cache.bin" // Warm result cache
+#define DICTIONARY_STATS_PATH       DICTIONARY_APP_ASSETS_PATH "/stats.csv" // Recent lookups
+#define DICTIONARY_WORDS_PATH       DICTIONARY_APP_ASSETS_PATH "/words.txt" // Glossary word list
+#define DICTIONARY_GLOSSARY_PATH    DICTIONARY_APP_ASSETS_PATH "/glossary.txt" // Written glossary
+#define DICTIONARY_RUNS_PATH        DICTIONARY_APP_ASSETS_PATH "/glossary.tmp" // Glossary runs
+#define MAX_HISTORY_ITEMS           30 // most recent words listed in the History menu
+#define HISTORY_TXT_ITEMS           10 // most words history.txt ever held
+#define PREFETCH_HISTORY_ITEMS      3 // read into the cache when the History menu opens
+
+// Heap the RAM key index may use; blocks that do not fit are read from SD.
+// Override with cdefines in application.fam.
+#ifndef DICTIONARY_INDEX_RAM_BUDGET
+#define DICTIONARY_INDEX_RAM_BUDGET (48 * 1024)
+#endif
+// Largest free block that must remain after loading the index
+#define DICTIONARY_INDEX_HEAP_RESERVE (24 * 1024)
+// Heap the signature table of Wildcard and Anagram may use while one of them
+// is open (4 bytes a key); with less free it is read from SD per query.
+// Override with cdefines in application.fam.
+#ifndef DICTIONARY_PATTERN_RAM_BUDGET
+#define DICTIONARY_PATTERN_RAM_BUDGET (56 * 1024)
+#endif
+// Heap Glossary may sort words in; a longer list is sorted in runs on the SD
+// card (glossary.tmp) and merged. Override with cdefines in application.fam.
+#ifndef DICTIONARY_GLOSSARY_RAM_BUDGET
+#define DICTIONARY_GLOSSARY_RAM_BUDGET (16 * 1024)
+#endif
+
+// Definitions kept in RAM, and how much of them is saved for the next
+// launch. Override with cdefines in application.fam.
+#ifndef DICTIONARY_CACHE_BUDGET
+#define DICTIONARY_CACHE_BUDGET (8 * 1024)
+#endif
+#ifndef DICTIONARY_CACHE_WARM_BYTES
+#define DICTIONARY_CACHE_WARM_BYTES (2 * 1024)
+#endif
+
+// Words kept in the history and the RAM their text may take (a word costs its
+// length plus 3 bytes). Override with cdefines in application.fam.
+#ifndef DICTIONARY_HISTORY_CAPACITY
+#define DICTIONARY_HISTORY_CAPACITY 1024
+#endif
+#ifndef DICTIONARY_HISTORY_WORD_BYTES
+#define DICTIONARY_HISTORY_WORD_BYTES (DICTIONARY_HISTORY_CAPACITY * 12)
+#endif
+// Idle time after which queued history records are written to the card
+#define DICTIONARY_HISTORY_SYNC_MS 1000
+
+// Lookup statistics are off by default. With DICTIONARY_STATS in cdefines the
+// Stats menu item shows them; with DICTIONARY_STATS_CSV as well, opening it
+// saves the recent lookups to stats.csv.
 
 // --- Enums for Views and Menu Items ---
 typedef enum {
@@ -33,14 +90,23 @@ typedef enum {
     DictionaryViewResult,
     DictionaryViewHistory, // View for history
     DictionaryViewAbout, // View for About page
+    DictionaryViewSuggestions, // "Did you mean" list after a miss
+    DictionaryViewReverse, // Headwords matching a description
+    DictionaryViewPatterns, // Keys matching a pattern or spelt with the same letters
+    DictionaryViewStats, // Lookup statistics, with DICTIONARY_STATS
 } DictionaryViewId;
 
 typedef enum {
     DictionaryMenuSearch = 0,
     DictionaryMenuHistory,
     DictionaryMenuRandom,
-    DictionaryMenuSettings, // (reserved)
+    DictionaryMenuSettings, // Stats, with DICTIONARY_STATS
     DictionaryMenuAbout, // About menu item
+    DictionaryMenuRandomCommon, // Random weighted towards common words
+    DictionaryMenuReverse, // Find a word by words of its definition
+    DictionaryMenuPattern, // Crossword pattern with '?' and '*'
+    DictionaryMenuAnagram, // Words spelt with the same letters
+    DictionaryMenuGlossary, // Definitions of the words in words.txt
 } DictionaryMenuId;
 
 // --- Application State Structure ---
@@ -48,103 +114,80 @@ typedef struct {
     Gui* gui;
     ViewDispatcher* vd;
     Submenu* submenu;
-    TextInput* text_input;
-    TextBox* text_box;
+    DictionarySearchView* search_view;
+    DictionaryResultView* result_view;
     Submenu* history_submenu; // Submenu for history view
     TextBox* about_box; // TextBox for the About page
+    Submenu* suggest_submenu; // Submenu for "did you mean" suggestions
+    Submenu* reverse_submenu; // Submenu for reverse lookup matches
+    Submenu* pattern_submenu; // Submenu for pattern and anagram matches
+#ifdef DICTIONARY_STATS
+    TextBox* stats_box; // TextBox for the Stats page
+    FuriString* stats_text;
+#endif
 
     char* search_buffer;
     size_t search_buffer_size;
+    uint32_t search_menu; // DictionaryMenuId the search view was opened from
 
-    FuriString* result_text;
+    FuriString* result_text; // messages shown in result_view
+    DictionaryWorkerResult result; // latest lookup
 
     uint32_t current_view;
 
-    // History data
-    char history_words[MAX_HISTORY_ITEMS][MAX_WORD_LENGTH];
+    // History data: the journal in RAM, and the items listed in the menu
+    DictionaryHistory* history;
+    DictionaryHistoryItem history_items[MAX_HISTORY_ITEMS];
     uint8_t history_count;
+
+    DictionarySuggestions suggestions; // shown in suggest_submenu
+    DictionaryReverseResults matches; // shown in reverse_submenu
+    DictionaryPatternResults patterns; // shown in pattern_submenu
+
+    // Lookup session: keeps both files open and the RAM key index loaded for
+    // the app's lifetime. The worker thread owns it once started.
+    DictionaryStorage* storage;
+    Dictionary* dict;
+    DictionaryCache* cache; // definitions of recent lookups
+    DictionaryWorker* worker;
 } DictionaryApp;
 
 // --- Forward Declarations ---
-static void dictionary_search_done_cb(void* context);
+static void dictionary_search_changed_cb(void* context, const char* text);
+static void dictionary_search_done_cb(void* context, const char* text);
 static bool dictionary_navigation_event_callback(void* context);
-static bool dictionary_app_search_word(DictionaryApp* app, const char* word_to_find);
-static void dictionary_app_save_history(DictionaryApp* app);
+static void dictionary_app_lookup(DictionaryApp* app, const char* word, bool suggest);
+static void dictionary_app_reverse_lookup(DictionaryApp* app, const char* query);
+static void dictionary_app_pattern_lookup(DictionaryApp* app, const char* query);
+static void dictionary_app_glossary(DictionaryApp* app);
+static void dictionary_app_sync_history(DictionaryApp* app, bool exiting);
 static void dictionary_history_menu_cb(void* context, uint32_t index);
+static void dictionary_suggest_menu_cb(void* context, uint32_t index);
+static void dictionary_reverse_menu_cb(void* context, uint32_t index);
+static void dictionary_pattern_menu_cb(void* context, uint32_t index);
 static void dictionary_app_add_to_history(DictionaryApp* app, const char* word);
-// NEW: random-word picker
-static bool dictionary_app_random_word(DictionaryApp* app);
-
-// Helper: split phonetic and defs, then format output
-static void format_result_with_phonetic(FuriString* out, const char* word, const char* raw) {
-    furi_string_reset(out);
-    if(!raw) return;
-
-    const char* defs = raw;
-    if(raw[0] == '[') {
-        const char* closing = strchr(raw, ']');
-        if(closing) {
-            size_t phon_len = closing - raw + 1;
-            furi_string_cat_printf(out, "%s %.*s", word, (int)phon_len, raw);
-            furi_string_push_back(out, '\n');
-            defs = closing + 1;
-            while(*defs && isspace((unsigned char)*defs))
-                defs++;
-        }
-    } else {
-        furi_string_cat_printf(out, "%s", word);
-        furi_string_push_back(out, '\n');
-    }
-
-    size_t raw_len = strlen(defs);
-    char* buf = malloc(raw_len + 1);
-    if(!buf) {
-        furi_string_cat(out, defs);
-        return;
-    }
-    memcpy(buf, defs, raw_len + 1);
-
-    unsigned count = 0;
-    char* token = strtok(buf, ";");
-    while(token) {
-        while(*token && isspace((unsigned char)*token))
-            token++;
-        size_t tlen = strlen(token);
-        while(tlen > 0 && isspace((unsigned char)token[tlen - 1])) {
-            token[--tlen] = '\0';
-        }
-        if(tlen > 0) {
-            furi_string_cat_printf(out, "%u. %s\n", ++count, token);
-        }
-        token = strtok(NULL, ";");
-    }
-
-    if(count == 0) {
-        furi_string_cat(out, defs);
-    }
-
-    free(buf);
-}
+static void dictionary_app_show_text(DictionaryApp* app);
 
 // --- History Management Functions ---
 
-static void dictionary_app_load_history(DictionaryApp* app) {
+// Imports history.txt, the plain list kept before the journal (most recent
+// first, ten words at most). It is removed once the journal is written.
+static void dictionary_app_import_history(DictionaryApp* app) {
     Storage* storage = furi_record_open(RECORD_STORAGE);
     Stream* file_stream = buffered_file_stream_alloc(storage);
-    app->history_count = 0;
+    // 1.5 KB would not fit next to the callers on the 2 KB GUI stack
+    char(*words)[MAX_WORD_LENGTH] = malloc(HISTORY_TXT_ITEMS * sizeof(*words));
+    uint8_t count = 0;
 
     if(buffered_file_stream_open(
-           file_stream, DICTIONARY_HISTORY_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+           file_stream, DICTIONARY_HISTORY_TXT_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
         FuriString* line = furi_string_alloc();
-        while(app->history_count < MAX_HISTORY_ITEMS && stream_read_line(file_stream, line)) {
+        while(count < HISTORY_TXT_ITEMS && stream_read_line(file_stream, line)) {
             furi_string_trim(line);
             if(furi_string_size(line) > 0) {
-                strncpy(
-                    app->history_words[app->history_count],
-                    furi_string_get_cstr(line),
-                    MAX_WORD_LENGTH - 1);
-                app->history_words[app->history_count][MAX_WORD_LENGTH - 1] = '\0';
-                app->history_count++;
+                strncpy(words[count], furi_string_get_cstr(line), MAX_WORD_LENGTH - 1);
+                words[count][MAX_WORD_LENGTH - 1] = '\0';
+                count++;
             }
         }
         furi_string_free(line);
@@ -153,76 +196,164 @@ static void dictionary_app_load_history(DictionaryApp* app) {
     buffered_file_stream_close(file_stream);
     stream_free(file_stream);
     furi_record_close(RECORD_STORAGE);
+
+    // Oldest first, with no time recorded
+    while(count > 0) {
+        dictionary_history_add(app->history, words[--count], 0);
+    }
+    free(words);
+}
+
+static void dictionary_app_load_history(DictionaryApp* app) {
+    // A compaction interrupted between removing the journal and renaming the
+    // new one leaves only the new one
+    DictionaryFile* file = dictionary_storage_open(app->storage, DICTIONARY_HISTORY_PATH);
+    if(!file) file = dictionary_storage_open(app->storage, DICTIONARY_HISTORY_TMP_PATH);
+    if(file) {
+        if(!dictionary_history_load(app->history, app->storage, file)) {
+            FURI_LOG_W(APP_NAME, "History journal damaged, keeping what was read");
+        }
+        dictionary_storage_close(app->storage, file);
+    } else {
+        dictionary_app_import_history(app);
+    }
 }
 
-static void dictionary_app_save_history(DictionaryApp* app) {
+typedef struct {
+    Stream* stream;
+    bool failed;
+} DictionaryAppWriter;
+
+static void dictionary_app_writer_write(void* context, const char* text, size_t length) {
+    DictionaryAppWriter* writer = context;
+    if(stream_write(writer->stream, (const uint8_t*)text, length) != length) {
+        writer->failed = true;
+    }
+}
+
+// Appends the queued lookups to the journal, or rewrites it when it is due
+// for compaction. Runs when the app has been idle for a while and on exit,
+// so a lookup never waits for the card.
+static void dictionary_app_sync_history(DictionaryApp* app, bool exiting) {
+    bool compact = dictionary_history_needs_compaction(app->history, exiting);
+    if(!compact && !dictionary_history_has_pending(app->history)) return;
+
     Storage* storage = furi_record_open(RECORD_STORAGE);
     Stream* file_stream = buffered_file_stream_alloc(storage);
-
-    if(buffered_file_stream_open(
-           file_stream, DICTIONARY_HISTORY_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
-        for(uint8_t i = 0; i < app->history_count; ++i) {
-            stream_write_format(file_stream, "%s\n", app->history_words[i]);
+    DictionaryAppWriter writer = {file_stream, false};
+    DictionaryOutput out = {dictionary_app_writer_write, &writer};
+
+    if(compact) {
+        // Written aside and renamed, so the journal is never half written
+        writer.failed = !buffered_file_stream_open(
+            file_stream, DICTIONARY_HISTORY_TMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+        if(!writer.failed) dictionary_history_save(app->history, &out);
+        writer.failed = !buffered_file_stream_close(file_stream) || writer.failed;
+        if(!writer.failed) {
+            storage_simply_remove(storage, DICTIONARY_HISTORY_PATH);
+            writer.failed = storage_common_rename(
+                                storage, DICTIONARY_HISTORY_TMP_PATH, DICTIONARY_HISTORY_PATH) !=
+                            FSE_OK;
         }
+        if(!writer.failed) storage_simply_remove(storage, DICTIONARY_HISTORY_TXT_PATH);
+    } else {
+        writer.failed = !buffered_file_stream_open(
+            file_stream, DICTIONARY_HISTORY_PATH, FSAM_WRITE, FSOM_OPEN_APPEND);
+        if(!writer.failed) dictionary_history_write_pending(app->history, &out);
+        writer.failed = !buffered_file_stream_close(file_stream) || writer.failed;
     }
 
-    buffered_file_stream_close(file_stream);
+    if(writer.failed) {
+        // RAM still has every lookup: the next sync rewrites the journal
+        dictionary_history_set_journal_failed(app->history);
+        FURI_LOG_W(APP_NAME, "History journal write failed");
+    }
     stream_free(file_stream);
     furi_record_close(RECORD_STORAGE);
 }
 
 static void dictionary_app_add_to_history(DictionaryApp* app, const char* word) {
     if(!word || strlen(word) == 0) return;
+    dictionary_history_add(app->history, word, furi_hal_rtc_get_timestamp());
+}
 
-    // Check for duplicates and remove if found
-    int found_index = -1;
-    for(uint8_t i = 0; i < app->history_count; ++i) {
-        if(strcasecmp(app->history_words[i], word) == 0) {
-            found_index = i;
-            break;
-        }
-    }
+static void dictionary_tick_event_callback(void* context) {
+    DictionaryApp* app = context;
+    dictionary_app_sync_history(app, false);
+}
 
-    if(found_index != -1) {
-        // If found, move it to the top (most recent)
-        char temp[MAX_WORD_LENGTH];
-        strncpy(temp, app->history_words[found_index], MAX_WORD_LENGTH);
-        for(int i = found_index; i > 0; --i) {
-            strncpy(app->history_words[i], app->history_words[i - 1], MAX_WORD_LENGTH);
-        }
-        strncpy(app->history_words[0], temp, MAX_WORD_LENGTH);
-    } else {
-        // If not found, add it to the top
-        if(app->history_count < MAX_HISTORY_ITEMS) {
-            app->history_count++;
-        }
-        // Shift existing items down
-        for(int i = app->history_count - 1; i > 0; --i) {
-            strncpy(app->history_words[i], app->history_words[i - 1], MAX_WORD_LENGTH);
-        }
-        // Add the new word at the top
-        strncpy(app->history_words[0], word, MAX_WORD_LENGTH - 1);
-        app->history_words[0][MAX_WORD_LENGTH - 1] = '\0';
+// --- Lookup Statistics ---
+
+#ifdef DICTIONARY_STATS
+static void dictionary_app_string_write(void* context, const char* text, size_t length) {
+    FuriString* string = context;
+    for(size_t i = 0; i < length; i++) {
+        furi_string_push_back(string, text[i]);
     }
+}
 
-    dictionary_app_save_history(app);
+#ifdef DICTIONARY_STATS_CSV
+static bool dictionary_app_save_stats(DictionaryApp* app) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* file_stream = buffered_file_stream_alloc(storage);
+    DictionaryAppWriter writer = {file_stream, false};
+    writer.failed = !buffered_file_stream_open(
+        file_stream, DICTIONARY_STATS_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if(!writer.failed) {
+        DictionaryOutput out = {dictionary_app_writer_write, &writer};
+        dictionary_worker_write_stats(app->worker, &out, true);
+    }
+    writer.failed = !buffered_file_stream_close(file_stream) || writer.failed;
+    stream_free(file_stream);
+    furi_record_close(RECORD_STORAGE);
+    return !writer.failed;
+}
+#endif
+
+static void dictionary_app_show_stats(DictionaryApp* app) {
+    furi_string_reset(app->stats_text);
+    DictionaryOutput out = {dictionary_app_string_write, app->stats_text};
+    dictionary_worker_write_stats(app->worker, &out, false);
+#ifdef DICTIONARY_STATS_CSV
+    furi_string_cat_str(
+        app->stats_text,
+        dictionary_app_save_stats(app) ? "\nSaved to stats.csv" : "\nstats.csv not saved");
+#endif
+    text_box_reset(app->stats_box);
+    text_box_set_font(app->stats_box, TextBoxFontText);
+    text_box_set_text(app->stats_box, furi_string_get_cstr(app->stats_text));
+    app->current_view = DictionaryViewStats;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewStats);
 }
+#endif
 
 // --- UI Callback Functions ---
 
+// Wildcard and Anagram share the search view and the signature table
+static bool dictionary_app_is_pattern_search(const DictionaryApp* app) {
+    return app->search_menu == DictionaryMenuPattern || app->search_menu == DictionaryMenuAnagram;
+}
+
 static void dictionary_menu_cb(void* context, uint32_t index) {
     DictionaryApp* app = context;
     switch(index) {
     case DictionaryMenuSearch:
+    case DictionaryMenuReverse:
+    case DictionaryMenuPattern:
+    case DictionaryMenuAnagram:
         memset(app->search_buffer, 0, app->search_buffer_size);
-        text_input_set_header_text(app->text_input, "Search for a word");
-        text_input_set_result_callback(
-            app->text_input,
-            dictionary_search_done_cb,
-            app,
-            app->search_buffer,
-            app->search_buffer_size,
-            true);
+        dictionary_search_view_reset(app->search_view);
+        app->search_menu = index;
+        if(index == DictionaryMenuReverse) {
+            dictionary_search_view_set_mode(
+                app->search_view, DictionarySearchViewModePhrase, "Describe the word");
+        } else if(index == DictionaryMenuPattern) {
+            dictionary_search_view_set_mode(
+                app->search_view, DictionarySearchViewModePattern, "? one letter, * any letters");
+        } else if(index == DictionaryMenuAnagram) {
+            dictionary_search_view_set_mode(
+                app->search_view, DictionarySearchViewModeLetters, "Letters to rearrange");
+        }
         app->current_view = DictionaryViewSearchInput;
         view_dispatcher_switch_to_view(app->vd, DictionaryViewSearchInput);
         break;
@@ -230,39 +361,44 @@ static void dictionary_menu_cb(void* context, uint32_t index) {
     case DictionaryMenuHistory:
         submenu_reset(app->history_submenu);
         submenu_set_header(app->history_submenu, "Search History");
+        app->history_count =
+            dictionary_history_get_recent(app->history, app->history_items, MAX_HISTORY_ITEMS);
         for(uint8_t i = 0; i < app->history_count; ++i) {
-            submenu_add_item(
-                app->history_submenu, app->history_words[i], i, dictionary_history_menu_cb, app);
+            // Words looked up more than once show their count
+            const DictionaryHistoryItem* item = &app->history_items[i];
+            char label[MAX_WORD_LENGTH + 8];
+            if(item->hits > 1) {
+                snprintf(label, sizeof(label), "%s (%u)", item->word, item->hits);
+            } else {
+                snprintf(label, sizeof(label), "%s", item->word);
+            }
+            submenu_add_item(app->history_submenu, label, i, dictionary_history_menu_cb, app);
+        }
+        // A word is often looked up again soon
+        for(uint8_t i = 0; i < app->history_count && i < PREFETCH_HISTORY_ITEMS; ++i) {
+            dictionary_worker_prefetch(app->worker, app->history_items[i].word);
         }
         app->current_view = DictionaryViewHistory;
         view_dispatcher_switch_to_view(app->vd, DictionaryViewHistory);
         break;
 
-    case DictionaryMenuRandom: {
-        bool found = dictionary_app_random_word(app);
-
-        text_box_reset(app->text_box);
-        text_box_set_font(app->text_box, TextBoxFontText);
-
-        if(found) {
-            text_box_set_text(app->text_box, furi_string_get_cstr(app->result_text));
-            // 从首行提取真实单词（避免把 [phonetic] 带进历史）
-            const char* cstr = furi_string_get_cstr(app->result_text);
-            char word[MAX_WORD_LENGTH] = {0};
-            size_t i = 0;
-            while(cstr[i] && cstr[i] != '\n' && cstr[i] != ' ' && i < MAX_WORD_LENGTH - 1) {
-                word[i] = cstr[i];
-                i++;
-            }
-            dictionary_app_add_to_history(app, word);
-        } else {
-            furi_string_set(app->result_text, "Error: Failed to pick a random word.");
-            text_box_set_text(app->text_box, furi_string_get_cstr(app->result_text));
-        }
-
+    case DictionaryMenuRandom:
+    case DictionaryMenuRandomCommon:
+        dictionary_result_view_set_loading(app->result_view);
+        dictionary_worker_random(app->worker, index == DictionaryMenuRandomCommon);
         app->current_view = DictionaryViewResult;
         view_dispatcher_switch_to_view(app->vd, DictionaryViewResult);
-    } break;
+        break;
+
+    case DictionaryMenuGlossary:
+        dictionary_app_glossary(app);
+        break;
+
+#ifdef DICTIONARY_STATS
+    case DictionaryMenuSettings:
+        dictionary_app_show_stats(app);
+        break;
+#endif
 
     case DictionaryMenuAbout:
         text_box_reset(app->about_box);
@@ -280,55 +416,114 @@ static void dictionary_history_menu_cb(void* context, uint32_t index) {
     DictionaryApp* app = context;
     if(index < app->history_count) {
         // Perform search with the selected history word
-        bool found = dictionary_app_search_word(app, app->history_words[index]);
-        text_box_reset(app->text_box);
-        text_box_set_font(app->text_box, TextBoxFontText);
-
-        if(found) {
-            text_box_set_text(app->text_box, furi_string_get_cstr(app->result_text));
-            // Add to history again to move it to the top
-            dictionary_app_add_to_history(app, app->history_words[index]);
-        } else {
-            furi_string_printf(
-                app->result_text, "Word not found:\n\"%s\"", app->history_words[index]);
-            text_box_set_text(app->text_box, furi_string_get_cstr(app->result_text));
-        }
+        dictionary_app_lookup(app, app->history_items[index].word, false);
+    }
+}
 
-        app->current_view = DictionaryViewResult;
-        view_dispatcher_switch_to_view(app->vd, DictionaryViewResult);
+static void dictionary_suggest_menu_cb(void* context, uint32_t index) {
+    DictionaryApp* app = context;
+    if(index < app->suggestions.count) {
+        dictionary_app_lookup(app, app->suggestions.words[index], false);
+    }
+}
+
+static void dictionary_reverse_menu_cb(void* context, uint32_t index) {
+    DictionaryApp* app = context;
+    if(index < app->matches.count) {
+        dictionary_app_lookup(app, app->matches.words[index], false);
+    }
+}
+
+static void dictionary_pattern_menu_cb(void* context, uint32_t index) {
+    DictionaryApp* app = context;
+    if(index < app->patterns.count) {
+        dictionary_app_lookup(app, app->patterns.words[index], false);
+    }
+}
+
+// On a miss, lists the closest headwords instead of the bare "not found"
+static void dictionary_app_show_suggestions(DictionaryApp* app) {
+    app->suggestions = app->result.suggestions;
+    submenu_reset(app->suggest_submenu);
+    submenu_set_header(app->suggest_submenu, "Did you mean?");
+    for(uint8_t i = 0; i < app->suggestions.count; ++i) {
+        submenu_add_item(
+            app->suggest_submenu, app->suggestions.words[i], i, dictionary_suggest_menu_cb, app);
     }
+    app->current_view = DictionaryViewSuggestions;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewSuggestions);
 }
 
-static void dictionary_search_done_cb(void* context) {
+// Lists the headwords a description matched, best first
+static void dictionary_app_show_matches(DictionaryApp* app) {
+    app->matches = app->result.matches;
+    submenu_reset(app->reverse_submenu);
+    // With no entry using every word, the list holds the closest ones
+    submenu_set_header(
+        app->reverse_submenu, app->matches.matches > 0 ? "Matches" : "Closest matches");
+    for(uint8_t i = 0; i < app->matches.count; ++i) {
+        submenu_add_item(
+            app->reverse_submenu, app->matches.words[i], i, dictionary_reverse_menu_cb, app);
+    }
+    app->current_view = DictionaryViewReverse;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewReverse);
+}
+
+// Lists the keys a pattern or anagram matched, in key order
+static void dictionary_app_show_patterns(DictionaryApp* app) {
+    app->patterns = app->result.patterns;
+    submenu_reset(app->pattern_submenu);
+    // A cut short search has more matches than listed
+    submenu_set_header(
+        app->pattern_submenu, app->patterns.truncated ? "First matches" : "Matches");
+    for(uint8_t i = 0; i < app->patterns.count; ++i) {
+        submenu_add_item(
+            app->pattern_submenu, app->patterns.words[i], i, dictionary_pattern_menu_cb, app);
+    }
+    app->current_view = DictionaryViewPatterns;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewPatterns);
+}
+
+static void dictionary_search_changed_cb(void* context, const char* text) {
     DictionaryApp* app = context;
+    // Shown when the worker posts them; only headword searches have them
+    if(app->search_menu == DictionaryMenuSearch) dictionary_worker_complete(app->worker, text);
+}
+
+static void dictionary_search_done_cb(void* context, const char* text) {
+    DictionaryApp* app = context;
+    strncpy(app->search_buffer, text, app->search_buffer_size - 1);
+    app->search_buffer[app->search_buffer_size - 1] = '\0';
     size_t len = strlen(app->search_buffer);
     while(len > 0 && isspace((unsigned char)app->search_buffer[len - 1])) {
         app->search_buffer[--len] = '\0';
     }
 
-    bool found = dictionary_app_search_word(app, app->search_buffer);
-    text_box_reset(app->text_box);
-    text_box_set_font(app->text_box, TextBoxFontText);
-
-    if(found) {
-        text_box_set_text(app->text_box, furi_string_get_cstr(app->result_text));
-        // Add successful search to history
-        dictionary_app_add_to_history(app, app->search_buffer);
+    if(app->search_menu == DictionaryMenuReverse) {
+        dictionary_app_reverse_lookup(app, app->search_buffer);
+    } else if(dictionary_app_is_pattern_search(app)) {
+        dictionary_app_pattern_lookup(app, app->search_buffer);
     } else {
-        furi_string_printf(app->result_text, "Word not found:\n\"%s\"", app->search_buffer);
-        text_box_set_text(app->text_box, furi_string_get_cstr(app->result_text));
+        dictionary_app_lookup(app, app->search_buffer, true);
     }
-
-    app->current_view = DictionaryViewResult;
-    view_dispatcher_switch_to_view(app->vd, DictionaryViewResult);
 }
 
 // Back button handling: go back to previous view instead of exiting
 static bool dictionary_navigation_event_callback(void* context) {
     DictionaryApp* app = context;
+    // Nothing pending is wanted any more
+    dictionary_worker_cancel(app->worker);
     if(app->current_view == DictionaryViewSearchInput ||
        app->current_view == DictionaryViewResult || app->current_view == DictionaryViewHistory ||
-       app->current_view == DictionaryViewAbout) {
+       app->current_view == DictionaryViewAbout ||
+       app->current_view == DictionaryViewSuggestions ||
+       app->current_view == DictionaryViewReverse ||
+       app->current_view == DictionaryViewPatterns || app->current_view == DictionaryViewStats) {
+        // The signature table is only wanted while Wildcard or Anagram is open
+        if(dictionary_app_is_pattern_search(app)) {
+            dictionary_worker_release_patterns(app->worker);
+            app->search_menu = DictionaryMenuSearch;
+        }
         app->current_view = DictionaryViewMainMenu;
         view_dispatcher_switch_to_view(app->vd, DictionaryViewMainMenu);
         return true;
@@ -336,193 +531,237 @@ static bool dictionary_navigation_event_callback(void* context) {
     return false;
 }
 
-// --- Core Search Logic ---
-static bool dictionary_app_search_word(DictionaryApp* app, const char* word_to_find) {
-    bool found = false;
-    furi_string_reset(app->result_text);
+// --- Lookups ---
 
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* idx_file = storage_file_alloc(storage);
-    File* dat_file = storage_file_alloc(storage);
+// Shows result_text as it is
+static void dictionary_app_show_text(DictionaryApp* app) {
+    DictionaryTextSource source;
+    dictionary_text_source_init_memory(
+        &source, furi_string_get_cstr(app->result_text), furi_string_size(app->result_text));
+    dictionary_result_view_set_source(app->result_view, &source, NULL);
+}
+
+// Queues a lookup of `word` and shows the loading screen until the result is
+// posted; with `suggest` set a miss lists the closest headwords
+static void dictionary_app_lookup(DictionaryApp* app, const char* word, bool suggest) {
+    dictionary_result_view_set_loading(app->result_view);
+    dictionary_worker_search(app->worker, word, suggest);
+    app->current_view = DictionaryViewResult;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewResult);
+}
+
+// Queues a reverse lookup of the description `query`
+static void dictionary_app_reverse_lookup(DictionaryApp* app, const char* query) {
+    dictionary_result_view_set_loading(app->result_view);
+    dictionary_worker_reverse(app->worker, query);
+    app->current_view = DictionaryViewResult;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewResult);
+}
+
+// Queues a pattern or anagram search for `query`; the signature table gets
+// what the heap can spare
+static void dictionary_app_pattern_lookup(DictionaryApp* app, const char* query) {
+    size_t max_free = memmgr_heap_get_max_free_block();
+    size_t budget = max_free > DICTIONARY_INDEX_HEAP_RESERVE ?
+                        MIN((size_t)DICTIONARY_PATTERN_RAM_BUDGET,
+                            max_free - DICTIONARY_INDEX_HEAP_RESERVE) :
+                        0;
+    dictionary_result_view_set_loading(app->result_view);
+    dictionary_worker_pattern(
+        app->worker, query, app->search_menu == DictionaryMenuAnagram, budget);
+    app->current_view = DictionaryViewResult;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewResult);
+}
 
-    if(!storage_file_open(idx_file, DICTIONARY_IDX_PATH, FSAM_READ, FSOM_OPEN_EXISTING) ||
-       !storage_file_open(dat_file, DICTIONARY_DAT_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        furi_string_set(app->result_text, "Error: Dictionary files not found on SD card.");
-        goto cleanup;
+// Shows how far the running glossary got; Back stops it
+static void
+    dictionary_app_show_progress(DictionaryApp* app, const DictionaryBatchProgress* progress) {
+    furi_string_printf(
+        app->result_text,
+        "Writing glossary...\n\n%lu words written\n%lu found\n\nBack to stop",
+        progress->done,
+        progress->found);
+    dictionary_app_show_text(app);
+}
+
+// Sums up a finished glossary
+static void dictionary_app_show_glossary(DictionaryApp* app) {
+    const DictionaryWorkerGlossary* batch = &app->result.batch;
+    DictionaryStatus status = app->result.status;
+    if(!batch->saved) {
+        furi_string_set(app->result_text, "Error: Failed to write glossary.txt.");
+    } else if(status == DictionaryStatusEmpty) {
+        furi_string_set(
+            app->result_text,
+            "No words to look up.\nPut them in\napps_assets/dictionary/\n"
+            "words.txt, one per line.");
+    } else if(status == DictionaryStatusCancelled) {
+        furi_string_printf(
+            app->result_text,
+            "Stopped.\nglossary.txt is incomplete:\n%lu words written.",
+            batch->progress.done);
+    } else if(status == DictionaryStatusOk || status == DictionaryStatusNotFound) {
+        furi_string_printf(
+            app->result_text,
+            "Saved to glossary.txt\n\n%lu words\n%lu found\n%lu not in the dictionary",
+            batch->progress.done,
+            batch->progress.found,
+            batch->progress.done - batch->progress.found);
+    } else {
+        furi_string_set(app->result_text, dictionary_status_get_text(status));
     }
+    dictionary_app_show_text(app);
+}
 
-    uint64_t file_size = storage_file_size(idx_file);
-    uint64_t low = 0, high = file_size;
+// Queues the glossary of words.txt; its sort gets what the heap can spare
+static void dictionary_app_glossary(DictionaryApp* app) {
+    size_t max_free = memmgr_heap_get_max_free_block();
+    size_t budget = max_free > DICTIONARY_INDEX_HEAP_RESERVE ?
+                        MIN((size_t)DICTIONARY_GLOSSARY_RAM_BUDGET,
+                            max_free - DICTIONARY_INDEX_HEAP_RESERVE) :
+                        0;
+    furi_string_set(app->result_text, "Writing glossary...");
+    dictionary_app_show_text(app);
+    dictionary_worker_glossary(
+        app->worker,
+        DICTIONARY_WORDS_PATH,
+        DICTIONARY_GLOSSARY_PATH,
+        DICTIONARY_RUNS_PATH,
+        budget);
+    app->current_view = DictionaryViewResult;
+    view_dispatcher_switch_to_view(app->vd, DictionaryViewResult);
+}
 
-    while(low < high) {
-        uint64_t mid = low + (high - low) / 2;
-        storage_file_seek(idx_file, low, true);
-        uint64_t pivot_pos = low;
+// Shows the result the worker posted, unless it is stale
+static void dictionary_app_show_result(DictionaryApp* app) {
+    const DictionaryWorkerResult* result = &app->result;
+    DictionaryTextSource source;
+    if(!dictionary_worker_get_result(app->worker, &app->result, &source)) return;
 
-        while(storage_file_tell(idx_file) < mid) {
-            pivot_pos = storage_file_tell(idx_file);
-            uint16_t temp_len;
-            if(storage_file_read(idx_file, &temp_len, sizeof(temp_len)) != sizeof(temp_len)) {
-                goto search_failed;
-            }
-            if(!storage_file_seek(idx_file, temp_len + 6, false)) {
-                goto search_failed;
-            }
+    DictionaryStatus status = result->status;
+    if(result->glossary) {
+        dictionary_app_show_glossary(app);
+        return;
+    }
+    if(result->reverse) {
+        if(status == DictionaryStatusOk) {
+            dictionary_app_show_matches(app);
+            return;
         }
-        storage_file_seek(idx_file, pivot_pos, true);
-
-        uint16_t key_len;
-        if(storage_file_read(idx_file, &key_len, sizeof(key_len)) != sizeof(key_len)) break;
-
-        char key_buffer[MAX_WORD_LENGTH];
-        if(key_len >= sizeof(key_buffer)) key_len = sizeof(key_buffer) - 1;
-        if(storage_file_read(idx_file, key_buffer, key_len) != key_len) break;
-        key_buffer[key_len] = '\0';
-
-        int cmp = strcasecmp(word_to_find, key_buffer);
-        if(cmp == 0) {
-            uint32_t offset;
-            uint16_t length;
-            if(storage_file_read(idx_file, &offset, sizeof(offset)) != sizeof(offset) ||
-               storage_file_read(idx_file, &length, sizeof(length)) != sizeof(length))
-                break;
-
-            storage_file_seek(dat_file, offset, true);
-            char* def_buffer = malloc(length + 1);
-            if(!def_buffer) {
-                furi_string_set(
-                    app->result_text, "Error: Out of memory while reading definition.");
-                goto cleanup;
-            }
-            if(storage_file_read(dat_file, def_buffer, length) != length) {
-                free(def_buffer);
-                furi_string_set(app->result_text, "Error: Failed to read definition data.");
-                goto cleanup;
-            }
-            def_buffer[length] = '\0';
-
-            format_result_with_phonetic(app->result_text, key_buffer, def_buffer);
-            free(def_buffer);
-            found = true;
-            goto cleanup;
-        } else if(cmp < 0) {
-            high = pivot_pos;
+        if(status == DictionaryStatusNotFound) {
+            furi_string_printf(app->result_text, "No definition uses:\n\"%s\"", result->word);
         } else {
-            low = storage_file_tell(idx_file) + sizeof(uint32_t) + sizeof(uint16_t);
+            furi_string_set(app->result_text, dictionary_status_get_text(status));
         }
+        dictionary_app_show_text(app);
+        return;
     }
-
-search_failed:
-    if(!found) {
-        // leave result text empty, will be set by caller
+    if(result->pattern) {
+        if(status == DictionaryStatusOk) {
+            dictionary_app_show_patterns(app);
+            return;
+        }
+        if(status == DictionaryStatusNotFound) {
+            furi_string_printf(
+                app->result_text,
+                app->search_menu == DictionaryMenuAnagram ? "No anagram of:\n\"%s\"" :
+                                                            "No word matches:\n\"%s\"",
+                result->word);
+        } else {
+            furi_string_set(app->result_text, dictionary_status_get_text(status));
+        }
+        dictionary_app_show_text(app);
+        return;
+    }
+    if(status == DictionaryStatusOk) {
+        // An inflected form shows its lemma's entry, headed "form -> lemma"
+        char headline[DICTIONARY_HEADLINE_LENGTH];
+        const char* word = result->word;
+        if(result->form[0]) {
+            snprintf(headline, sizeof(headline), "%s -> %s", result->form, result->word);
+            word = headline;
+        }
+        if(dictionary_result_view_set_source(app->result_view, &source, word)) {
+            // Successful lookups go to the history
+            dictionary_app_add_to_history(app, result->word);
+            return;
+        }
+        status = DictionaryStatusReadError;
     }
 
-cleanup:
-    storage_file_close(idx_file);
-    storage_file_free(idx_file);
-    storage_file_close(dat_file);
-    storage_file_free(dat_file);
-    furi_record_close(RECORD_STORAGE);
-    return found;
+    if(result->random) {
+        furi_string_set(app->result_text, "Error: Failed to pick a random word.");
+    } else if(status == DictionaryStatusNotFound) {
+        if(result->suggestions.count > 0) {
+            dictionary_app_show_suggestions(app);
+            return;
+        }
+        furi_string_printf(app->result_text, "Word not found:\n\"%s\"", result->word);
+    } else {
+        furi_string_set(app->result_text, dictionary_status_get_text(status));
+    }
+    dictionary_app_show_text(app);
 }
 
-// --- Random Word Picker ---
-static bool dictionary_app_random_word(DictionaryApp* app) {
-    bool ok = false;
-    furi_string_reset(app->result_text);
+// Runs on the worker thread: hands the event to the GUI thread
+static void dictionary_worker_cb(void* context, DictionaryWorkerEvent event) {
+    DictionaryApp* app = context;
+    view_dispatcher_send_custom_event(app->vd, event);
+}
 
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* idx_file = storage_file_alloc(storage);
-    File* dat_file = storage_file_alloc(storage);
-
-    if(!storage_file_open(idx_file, DICTIONARY_IDX_PATH, FSAM_READ, FSOM_OPEN_EXISTING) ||
-       !storage_file_open(dat_file, DICTIONARY_DAT_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        furi_string_set(app->result_text, "Error: Dictionary files not found on SD card.");
-        goto cleanup;
-    }
-
-    // First pass: count records
-    uint32_t count = 0;
-    storage_file_seek(idx_file, 0, true);
-    while(true) {
-        uint16_t key_len;
-        if(storage_file_read(idx_file, &key_len, sizeof(key_len)) != sizeof(key_len)) break;
-        if(!storage_file_seek(idx_file, (uint32_t)key_len + 6, false)) break; // skip key + 4 + 2
-        count++;
-    }
-
-    if(count == 0) {
-        furi_string_set(app->result_text, "Error: Dictionary index is empty.");
-        goto cleanup;
-    }
-
-    // Generate pseudo-random number (seeded by tick)
-    uint32_t seed = furi_get_tick();
-    srand((unsigned int)(seed ^ (seed << 13) ^ (seed >> 7)));
-    uint32_t r = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
-    uint32_t target = r % count;
-
-    // Second pass: seek to target
-    storage_file_seek(idx_file, 0, true);
-    for(uint32_t i = 0; i < target; i++) {
-        uint16_t key_len_skip;
-        if(storage_file_read(idx_file, &key_len_skip, sizeof(key_len_skip)) !=
-               sizeof(key_len_skip) ||
-           !storage_file_seek(idx_file, (uint32_t)key_len_skip + 6, false)) {
-            furi_string_set(app->result_text, "Error: Random seek failed.");
-            goto cleanup;
+static bool dictionary_custom_event_callback(void* context, uint32_t event) {
+    DictionaryApp* app = context;
+    if(event == DictionaryWorkerEventResult) {
+        dictionary_app_show_result(app);
+    } else if(event == DictionaryWorkerEventCompletions) {
+        DictionaryCompletions completions;
+        if(dictionary_worker_get_completions(app->worker, &completions)) {
+            dictionary_search_view_set_completions(app->search_view, &completions);
+        }
+    } else if(event == DictionaryWorkerEventProgress) {
+        DictionaryBatchProgress progress;
+        if(dictionary_worker_get_progress(app->worker, &progress)) {
+            dictionary_app_show_progress(app, &progress);
         }
     }
+    return true;
+}
 
-    // Read the target record
-    uint16_t key_len;
-    if(storage_file_read(idx_file, &key_len, sizeof(key_len)) != sizeof(key_len)) {
-        furi_string_set(app->result_text, "Error: Read key length failed.");
-        goto cleanup;
-    }
+// --- Result Cache ---
 
-    char key_buffer[MAX_WORD_LENGTH];
-    if(key_len >= sizeof(key_buffer)) key_len = sizeof(key_buffer) - 1;
-    if(storage_file_read(idx_file, key_buffer, key_len) != key_len) {
-        furi_string_set(app->result_text, "Error: Read key failed.");
-        goto cleanup;
+static void dictionary_app_load_cache(DictionaryApp* app) {
+    DictionaryFile* file = dictionary_storage_open(app->storage, DICTIONARY_CACHE_PATH);
+    if(file && !dictionary_cache_load(
+                   app->cache, app->storage, file, dictionary_get_tag(app->dict))) {
+        FURI_LOG_W(APP_NAME, "Cache warm set ignored");
     }
-    key_buffer[key_len] = '\0';
+    dictionary_storage_close(app->storage, file);
+}
 
-    uint32_t offset;
-    uint16_t length;
-    if(storage_file_read(idx_file, &offset, sizeof(offset)) != sizeof(offset) ||
-       storage_file_read(idx_file, &length, sizeof(length)) != sizeof(length)) {
-        furi_string_set(app->result_text, "Error: Read pointer failed.");
-        goto cleanup;
-    }
+static void dictionary_app_save_cache(DictionaryApp* app) {
+    const DictionaryCacheStats* stats = dictionary_cache_get_stats(app->cache);
+    FURI_LOG_I(
+        APP_NAME,
+        "Cache: %lu hits, %lu misses, %lu evictions, %lu entries / %zu bytes of %zu",
+        stats->hits,
+        stats->misses,
+        stats->evictions,
+        stats->entries,
+        stats->bytes,
+        stats->budget);
 
-    // Fetch definition from .dat
-    storage_file_seek(dat_file, offset, true);
-    char* def_buffer = malloc((size_t)length + 1);
-    if(!def_buffer) {
-        furi_string_set(app->result_text, "Error: Out of memory.");
-        goto cleanup;
-    }
-    if(storage_file_read(dat_file, def_buffer, length) != length) {
-        free(def_buffer);
-        furi_string_set(app->result_text, "Error: Read definition failed.");
-        goto cleanup;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* file_stream = buffered_file_stream_alloc(storage);
+    if(buffered_file_stream_open(
+           file_stream, DICTIONARY_CACHE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        DictionaryAppWriter writer = {file_stream, false};
+        DictionaryOutput out = {dictionary_app_writer_write, &writer};
+        dictionary_cache_save(
+            app->cache, &out, dictionary_get_tag(app->dict), DICTIONARY_CACHE_WARM_BYTES);
     }
-    def_buffer[length] = '\0';
-
-    // Format nicely
-    format_result_with_phonetic(app->result_text, key_buffer, def_buffer);
-    free(def_buffer);
-    ok = true;
-
-cleanup:
-    storage_file_close(idx_file);
-    storage_file_free(idx_file);
-    storage_file_close(dat_file);
-    storage_file_free(dat_file);
+    buffered_file_stream_close(file_stream);
+    stream_free(file_stream);
     furi_record_close(RECORD_STORAGE);
-    return ok;
 }
 
 // --- App Allocation and Freeing ---
@@ -533,28 +772,76 @@ static DictionaryApp* dictionary_app_alloc(void) {
     app->vd = view_dispatcher_alloc();
     view_dispatcher_set_navigation_event_callback(app->vd, dictionary_navigation_event_callback);
     view_dispatcher_set_event_callback_context(app->vd, app);
+    view_dispatcher_set_custom_event_callback(app->vd, dictionary_custom_event_callback);
+    view_dispatcher_set_tick_event_callback(
+        app->vd, dictionary_tick_event_callback, DICTIONARY_HISTORY_SYNC_MS);
+
+    app->history_count = 0;
+    // Before the key index, whose budget is what is left of the heap
+    app->history =
+        dictionary_history_alloc(DICTIONARY_HISTORY_CAPACITY, DICTIONARY_HISTORY_WORD_BYTES);
+
+    // Keep the key index in RAM for the app's lifetime, within the budget and
+    // the heap: running out of memory on the device is fatal rather than NULL
+    size_t max_free = memmgr_heap_get_max_free_block();
+    size_t budget = max_free > DICTIONARY_INDEX_HEAP_RESERVE ?
+                        MIN((size_t)DICTIONARY_INDEX_RAM_BUDGET,
+                            max_free - DICTIONARY_INDEX_HEAP_RESERVE) :
+                        0;
+    app->storage = dictionary_storage_furi_alloc();
+    app->dict =
+        dictionary_alloc(app->storage, DICTIONARY_IDX_PATH, DICTIONARY_DAT_PATH, budget);
+    const DictionaryKeyIndex* key_index = dictionary_get_key_index(app->dict);
+    if(key_index) {
+        FURI_LOG_I(
+            APP_NAME,
+            "Key index: %lu blocks, %lu resident",
+            dictionary_key_index_get_block_count(key_index),
+            dictionary_key_index_get_resident_blocks(key_index));
+    } else {
+        FURI_LOG_W(APP_NAME, "Key index unavailable, searching on SD");
+    }
 
     // Main Menu
     app->submenu = submenu_alloc();
     submenu_set_header(app->submenu, "EngDict " VERSION);
     submenu_add_item(app->submenu, "Search", DictionaryMenuSearch, dictionary_menu_cb, app);
+    if(dictionary_reverse_is_available(app->dict)) {
+        submenu_add_item(
+            app->submenu, "Reverse lookup", DictionaryMenuReverse, dictionary_menu_cb, app);
+    }
+    if(dictionary_patterns_is_available(app->dict)) {
+        submenu_add_item(app->submenu, "Wildcard", DictionaryMenuPattern, dictionary_menu_cb, app);
+        submenu_add_item(app->submenu, "Anagram", DictionaryMenuAnagram, dictionary_menu_cb, app);
+    }
     submenu_add_item(app->submenu, "History", DictionaryMenuHistory, dictionary_menu_cb, app);
     // Random item
     submenu_add_item(app->submenu, "Random", DictionaryMenuRandom, dictionary_menu_cb, app);
+    if(dictionary_has_weighted_random(app->dict)) {
+        submenu_add_item(
+            app->submenu, "Random (common)", DictionaryMenuRandomCommon, dictionary_menu_cb, app);
+    }
+    submenu_add_item(app->submenu, "Glossary", DictionaryMenuGlossary, dictionary_menu_cb, app);
+#ifdef DICTIONARY_STATS
+    submenu_add_item(app->submenu, "Stats", DictionaryMenuSettings, dictionary_menu_cb, app);
+#endif
     // About item
     submenu_add_item(app->submenu, "About", DictionaryMenuAbout, dictionary_menu_cb, app);
     view_dispatcher_add_view(app->vd, DictionaryViewMainMenu, submenu_get_view(app->submenu));
 
     // Search Input View
-    app->text_input = text_input_alloc();
+    app->search_view = dictionary_search_view_alloc();
+    dictionary_search_view_set_callbacks(
+        app->search_view, dictionary_search_changed_cb, dictionary_search_done_cb, app);
     view_dispatcher_add_view(
-        app->vd, DictionaryViewSearchInput, text_input_get_view(app->text_input));
+        app->vd, DictionaryViewSearchInput, dictionary_search_view_get_view(app->search_view));
     app->search_buffer_size = MAX_WORD_LENGTH;
     app->search_buffer = malloc(app->search_buffer_size);
 
     // Result View
-    app->text_box = text_box_alloc();
-    view_dispatcher_add_view(app->vd, DictionaryViewResult, text_box_get_view(app->text_box));
+    app->result_view = dictionary_result_view_alloc();
+    view_dispatcher_add_view(
+        app->vd, DictionaryViewResult, dictionary_result_view_get_view(app->result_view));
 
     // History View
     app->history_submenu = submenu_alloc();
@@ -565,11 +852,46 @@ static DictionaryApp* dictionary_app_alloc(void) {
     app->about_box = text_box_alloc();
     view_dispatcher_add_view(app->vd, DictionaryViewAbout, text_box_get_view(app->about_box));
 
+    // Suggestions View
+    app->suggest_submenu = submenu_alloc();
+    view_dispatcher_add_view(
+        app->vd, DictionaryViewSuggestions, submenu_get_view(app->suggest_submenu));
+    app->suggestions.count = 0;
+
+    // Reverse Lookup View
+    app->reverse_submenu = submenu_alloc();
+    view_dispatcher_add_view(
+        app->vd, DictionaryViewReverse, submenu_get_view(app->reverse_submenu));
+    app->matches.count = 0;
+
+    // Pattern Matches View
+    app->pattern_submenu = submenu_alloc();
+    view_dispatcher_add_view(
+        app->vd, DictionaryViewPatterns, submenu_get_view(app->pattern_submenu));
+    app->patterns.count = 0;
+    app->search_menu = DictionaryMenuSearch;
+
+#ifdef DICTIONARY_STATS
+    // Stats View
+    app->stats_box = text_box_alloc();
+    view_dispatcher_add_view(app->vd, DictionaryViewStats, text_box_get_view(app->stats_box));
+    app->stats_text = furi_string_alloc();
+#endif
+
     app->result_text = furi_string_alloc();
     app->current_view = DictionaryViewMainMenu;
 
-    // Load history from file
+    // Load history from the journal
     dictionary_app_load_history(app);
+    app->cache = dictionary_cache_alloc(DICTIONARY_CACHE_BUDGET);
+    dictionary_app_load_cache(app);
+
+    // Lookups run on the worker from here on; seed its word picker from the
+    // hardware RNG
+    uint64_t seed;
+    furi_hal_random_fill_buf((uint8_t*)&seed, sizeof(seed));
+    app->worker =
+        dictionary_worker_alloc(app->dict, app->cache, seed, dictionary_worker_cb, app);
 
     view_dispatcher_attach_to_gui(app->vd, app->gui, ViewDispatcherTypeFullscreen);
     return app;
@@ -577,15 +899,33 @@ static DictionaryApp* dictionary_app_alloc(void) {
 
 static void dictionary_app_free(DictionaryApp* app) {
     if(!app) return;
+    dictionary_worker_free(app->worker);
+    dictionary_app_save_cache(app);
+    dictionary_cache_free(app->cache);
+    dictionary_app_sync_history(app, true);
+    dictionary_history_free(app->history);
+    dictionary_free(app->dict);
+    dictionary_storage_furi_free(app->storage);
+#ifdef DICTIONARY_STATS
+    view_dispatcher_remove_view(app->vd, DictionaryViewStats);
+    text_box_free(app->stats_box);
+    furi_string_free(app->stats_text);
+#endif
+    view_dispatcher_remove_view(app->vd, DictionaryViewPatterns);
+    submenu_free(app->pattern_submenu);
+    view_dispatcher_remove_view(app->vd, DictionaryViewReverse);
+    submenu_free(app->reverse_submenu);
+    view_dispatcher_remove_view(app->vd, DictionaryViewSuggestions);
+    submenu_free(app->suggest_submenu);
     view_dispatcher_remove_view(app->vd, DictionaryViewAbout);
     text_box_free(app->about_box);
     view_dispatcher_remove_view(app->vd, DictionaryViewHistory);
     submenu_free(app->history_submenu);
     view_dispatcher_remove_view(app->vd, DictionaryViewResult);
-    text_box_free(app->text_box);
+    dictionary_result_view_free(app->result_view);
     furi_string_free(app->result_text);
     view_dispatcher_remove_view(app->vd, DictionaryViewSearchInput);
-    text_input_free(app->text_input);
+    dictionary_search_view_free(app->search_view);
     free(app->search_buffer);
     view_dispatcher_remove_view(app->vd, DictionaryViewMainMenu);
     submenu_free(app->submenu);
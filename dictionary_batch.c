@@ -0,0 +1,496 @@
+#include "dictionary_batch.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define DICTIONARY_BATCH_MISSING "(not in the dictionary)\n"
+
+// A sorted run of distinct words in the runs file, each ended by a '\0'
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} DictionaryBatchRun;
+
+// Where the merge is in one run
+typedef struct {
+    uint32_t pos; // first byte of the run not yet in `chunk`
+    uint32_t end;
+    uint16_t chunk_pos;
+    uint16_t chunk_length;
+    char word[MAX_WORD_LENGTH]; // the smallest not yet merged
+    char chunk[DICTIONARY_BATCH_CHUNK];
+} DictionaryBatchReader;
+
+typedef struct {
+    Dictionary* dict;
+    DictionaryStorage* storage;
+    DictionaryOutput* out;
+    DictionaryBatchCallback callback;
+    void* context;
+    DictionaryBatchProgress* progress;
+    size_t ram_budget;
+
+    // Words of the list being sorted into a run: packed from the front of
+    // `arena`, their pointers from the back
+    char* arena;
+    size_t arena_size;
+    size_t arena_used;
+    uint32_t count;
+
+    // Line being read, and the list around it
+    char line[MAX_WORD_LENGTH];
+    uint8_t line_length;
+    bool overlong;
+    char chunk[DICTIONARY_BATCH_CHUNK];
+
+    // The runs file, created with the first run
+    const char* runs_path;
+    DictionaryFile* runs_file;
+    uint32_t runs_end; // bytes written to it
+    uint32_t runs_pos; // of the handle
+    char pending[DICTIONARY_BATCH_CHUNK]; // bytes of the run not yet written
+    uint16_t pending_length;
+    DictionaryBatchRun* runs;
+    uint32_t run_count;
+    uint32_t run_capacity;
+
+    // Merge of the runs: a reader per run, and a heap of them ordered by word
+    DictionaryBatchReader* readers;
+    uint16_t* heap;
+    char last[MAX_WORD_LENGTH]; // merged last, to drop repeats across runs
+
+    // Merged words waiting to be joined; `queued` points into `queue`
+    char (*queue)[MAX_WORD_LENGTH];
+    const char* queued[DICTIONARY_BATCH_JOIN_WORDS];
+    uint32_t queued_count;
+
+    const char* const* joining; // words of the running dictionary_join()
+    uint32_t reported; // progress->done when the callback last ran
+    DictionaryStatus status; // the first error
+    bool cancelled;
+} DictionaryBatch;
+
+static bool dictionary_batch_going(const DictionaryBatch* batch) {
+    return batch->status == DictionaryStatusOk && !batch->cancelled;
+}
+
+static bool dictionary_batch_report(DictionaryBatch* batch) {
+    batch->reported = batch->progress->done;
+    if(batch->callback && !batch->callback(batch->context, batch->progress)) {
+        batch->cancelled = true;
+        return false;
+    }
+    return true;
+}
+
+static bool dictionary_batch_fail(DictionaryBatch* batch) {
+    batch->status = DictionaryStatusReadError;
+    return false;
+}
+
+// Moves the handle to `offset` unless it is there already, as it is while a
+// run is written
+static bool dictionary_batch_runs_seek(DictionaryBatch* batch, uint32_t offset) {
+    if(batch->runs_pos == offset) return true;
+    if(!dictionary_storage_seek(batch->storage, batch->runs_file, offset)) {
+        return dictionary_batch_fail(batch);
+    }
+    batch->runs_pos = offset;
+    return true;
+}
+
+static bool dictionary_batch_flush(DictionaryBatch* batch) {
+    if(batch->pending_length == 0) return true;
+    if(!dictionary_batch_runs_seek(batch, batch->runs_end)) return false;
+    if(!dictionary_storage_write(
+           batch->storage, batch->runs_file, batch->pending, batch->pending_length)) {
+        return dictionary_batch_fail(batch);
+    }
+    batch->runs_end += batch->pending_length;
+    batch->runs_pos = batch->runs_end;
+    batch->pending_length = 0;
+    return true;
+}
+
+// Appends `word` to the run being written
+static bool dictionary_batch_put(DictionaryBatch* batch, const char* word) {
+    size_t length = strlen(word) + 1;
+    while(length > 0) {
+        if(batch->pending_length == sizeof(batch->pending) && !dictionary_batch_flush(batch)) {
+            return false;
+        }
+        size_t room = sizeof(batch->pending) - batch->pending_length;
+        size_t size = length < room ? length : room;
+        memcpy(batch->pending + batch->pending_length, word, size);
+        batch->pending_length += size;
+        word += size;
+        length -= size;
+    }
+    return true;
+}
+
+// Ends the run written since `offset`, recording it as run `index`
+static bool dictionary_batch_end_run(DictionaryBatch* batch, uint32_t index, uint32_t offset) {
+    if(!dictionary_batch_flush(batch)) return false;
+    if(index == batch->run_capacity) {
+        uint32_t capacity = batch->run_capacity > 0 ? 2 * batch->run_capacity : 8;
+        DictionaryBatchRun* runs = realloc(batch->runs, capacity * sizeof(DictionaryBatchRun));
+        if(!runs) {
+            batch->status = DictionaryStatusOutOfMemory;
+            return false;
+        }
+        batch->runs = runs;
+        batch->run_capacity = capacity;
+    }
+    batch->runs[index].offset = offset;
+    batch->runs[index].length = batch->runs_end - offset;
+    return true;
+}
+
+static int dictionary_batch_compare(const void* a, const void* b) {
+    return strcasecmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+// The words in the arena, in the order they were added until sorted
+static char** dictionary_batch_words(DictionaryBatch* batch) {
+    return (char**)(batch->arena + batch->arena_size) - batch->count;
+}
+
+// Sorts the words in the arena and drops repeats; returns how many are left
+// at the front of dictionary_batch_words()
+static uint32_t dictionary_batch_sort(DictionaryBatch* batch) {
+    char** words = dictionary_batch_words(batch);
+    qsort(words, batch->count, sizeof(char*), dictionary_batch_compare);
+    uint32_t distinct = 0;
+    for(uint32_t i = 0; i < batch->count; i++) {
+        if(distinct == 0 || strcasecmp(words[distinct - 1], words[i]) != 0) {
+            words[distinct++] = words[i];
+        }
+    }
+    return distinct;
+}
+
+// Writes the words in the arena to the runs file as a sorted run and
+// empties the arena
+static bool dictionary_batch_write_run(DictionaryBatch* batch) {
+    if(!batch->runs_file) {
+        batch->runs_file = dictionary_storage_create(batch->storage, batch->runs_path);
+        if(!batch->runs_file) return dictionary_batch_fail(batch);
+    }
+    char** words = dictionary_batch_words(batch);
+    uint32_t count = dictionary_batch_sort(batch);
+    uint32_t offset = batch->runs_end;
+    for(uint32_t i = 0; i < count; i++) {
+        if(!dictionary_batch_put(batch, words[i])) return false;
+    }
+    if(!dictionary_batch_end_run(batch, batch->run_count, offset)) return false;
+    batch->run_count++;
+    batch->count = 0;
+    batch->arena_used = 0;
+    batch->progress->runs++;
+    return dictionary_batch_report(batch);
+}
+
+// Adds a word of the list to the arena, writing the arena out first when
+// it is full
+static void dictionary_batch_add(DictionaryBatch* batch, const char* word, size_t length) {
+    size_t pointers = (batch->count + 1) * sizeof(char*);
+    if(batch->arena_used + length + 1 + pointers > batch->arena_size &&
+       !dictionary_batch_write_run(batch)) {
+        return;
+    }
+    char* slot = batch->arena + batch->arena_used;
+    memcpy(slot, word, length + 1);
+    batch->arena_used += length + 1;
+    batch->count++;
+    dictionary_batch_words(batch)[0] = slot;
+}
+
+// Takes the next character of the list, adding the word when a line ends
+static void dictionary_batch_take(DictionaryBatch* batch, char c) {
+    if(c != '\n') {
+        if(batch->line_length == 0 && isspace((unsigned char)c)) return;
+        if(batch->line_length + 1 < MAX_WORD_LENGTH) {
+            batch->line[batch->line_length++] = c;
+        } else {
+            batch->overlong = true;
+        }
+        return;
+    }
+
+    while(batch->line_length > 0 && isspace((unsigned char)batch->line[batch->line_length - 1])) {
+        batch->line_length--;
+    }
+    batch->line[batch->line_length] = '\0';
+    if(batch->line_length > 0 && !batch->overlong && batch->line[0] != '#') {
+        batch->progress->words++;
+        dictionary_batch_add(batch, batch->line, batch->line_length);
+    }
+    batch->line_length = 0;
+    batch->overlong = false;
+}
+
+// Reads the list once, writing a run whenever the arena fills; false if it
+// could not be opened
+static bool dictionary_batch_read_list(DictionaryBatch* batch, const char* path) {
+    DictionaryFile* file = dictionary_storage_open(batch->storage, path);
+    if(!file) return false;
+
+    size_t read;
+    do {
+        read = dictionary_storage_read(batch->storage, file, batch->chunk, sizeof(batch->chunk));
+        for(size_t i = 0; i < read && dictionary_batch_going(batch); i++) {
+            dictionary_batch_take(batch, batch->chunk[i]);
+        }
+    } while(read == sizeof(batch->chunk) && dictionary_batch_going(batch));
+    // A last line without one
+    if(dictionary_batch_going(batch)) dictionary_batch_take(batch, '\n');
+
+    if(dictionary_storage_failed(batch->storage, file)) dictionary_batch_fail(batch);
+    dictionary_storage_close(batch->storage, file);
+    return true;
+}
+
+static void dictionary_batch_print(DictionaryBatch* batch, const char* text) {
+    batch->out->write(batch->out->context, text, strlen(text));
+}
+
+static bool
+    dictionary_batch_visit(void* context, uint32_t word_index, const DictionaryRecord* record) {
+    DictionaryBatch* batch = context;
+    DictionaryBatchProgress* progress = batch->progress;
+    if(record) {
+        DictionaryEntry entry = {.dict = batch->dict, .record = *record};
+        if(dictionary_entry_write(&entry, batch->out) != DictionaryStatusOk) {
+            return dictionary_batch_fail(batch);
+        }
+        progress->found++;
+    } else {
+        dictionary_batch_print(batch, batch->joining[word_index]);
+        dictionary_batch_print(batch, "\n" DICTIONARY_BATCH_MISSING);
+    }
+    dictionary_batch_print(batch, "\n");
+    progress->done++;
+
+    if(progress->done - batch->reported < DICTIONARY_BATCH_PROGRESS_STEP) return true;
+    return dictionary_batch_report(batch);
+}
+
+// Looks up `count` sorted distinct words and writes their entries
+static bool dictionary_batch_join_words(
+    DictionaryBatch* batch,
+    const char* const* words,
+    uint32_t count) {
+    batch->joining = words;
+    DictionaryStatus status =
+        dictionary_join(batch->dict, words, count, dictionary_batch_visit, batch);
+    if(status != DictionaryStatusOk) batch->status = status;
+    return dictionary_batch_going(batch);
+}
+
+// Joins the queued words. Unless they are the last, those sharing the key
+// block of the last one stay queued, to be walked with the words after them.
+static bool dictionary_batch_join_queue(DictionaryBatch* batch, bool final) {
+    uint32_t count = batch->queued_count;
+    uint32_t joined = final ? count : dictionary_join_prefix(batch->dict, batch->queued, count);
+    if(!dictionary_batch_join_words(batch, batch->queued, joined)) return false;
+    memmove(batch->queue, batch->queue + joined, (count - joined) * sizeof(*batch->queue));
+    batch->queued_count = count - joined;
+    return true;
+}
+
+static bool dictionary_batch_queue_word(DictionaryBatch* batch, const char* word) {
+    if(batch->queued_count == DICTIONARY_BATCH_JOIN_WORDS &&
+       !dictionary_batch_join_queue(batch, false)) {
+        return false;
+    }
+    strcpy(batch->queue[batch->queued_count++], word);
+    return true;
+}
+
+// Moves `reader` to the next word of its run; false at the end of it or on
+// an error
+static bool dictionary_batch_next(DictionaryBatch* batch, DictionaryBatchReader* reader) {
+    for(uint8_t length = 0; length < MAX_WORD_LENGTH;) {
+        if(reader->chunk_pos == reader->chunk_length) {
+            if(reader->pos == reader->end) {
+                return length > 0 && dictionary_batch_fail(batch); // cut short
+            }
+            uint32_t size = reader->end - reader->pos;
+            if(size > sizeof(reader->chunk)) size = sizeof(reader->chunk);
+            if(!dictionary_batch_runs_seek(batch, reader->pos)) return false;
+            if(dictionary_storage_read(batch->storage, batch->runs_file, reader->chunk, size) !=
+               size) {
+                return dictionary_batch_fail(batch);
+            }
+            reader->pos += size;
+            batch->runs_pos = reader->pos;
+            reader->chunk_pos = 0;
+            reader->chunk_length = size;
+        }
+        char c = reader->chunk[reader->chunk_pos++];
+        reader->word[length++] = c;
+        if(c == '\0') return true;
+    }
+    return dictionary_batch_fail(batch); // not a run this code wrote
+}
+
+static bool dictionary_batch_less(const DictionaryBatch* batch, uint16_t a, uint16_t b) {
+    return strcasecmp(batch->readers[a].word, batch->readers[b].word) < 0;
+}
+
+// Restores the heap order of the `count` readers below position `i`
+static void dictionary_batch_sift(DictionaryBatch* batch, uint32_t count, uint32_t i) {
+    uint16_t* heap = batch->heap;
+    for(;;) {
+        uint32_t least = i;
+        uint32_t left = 2 * i + 1;
+        if(left < count && dictionary_batch_less(batch, heap[left], heap[least])) least = left;
+        if(left + 1 < count && dictionary_batch_less(batch, heap[left + 1], heap[least])) {
+            least = left + 1;
+        }
+        if(least == i) return;
+        uint16_t reader = heap[i];
+        heap[i] = heap[least];
+        heap[least] = reader;
+        i = least;
+    }
+}
+
+// Merges the `count` runs from run `first` on, dropping repeats, into the
+// join queue or, with `to_file`, into a new run at the end of the runs file
+static bool
+    dictionary_batch_merge(DictionaryBatch* batch, uint32_t first, uint32_t count, bool to_file) {
+    uint32_t live = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        DictionaryBatchReader* reader = &batch->readers[i];
+        reader->pos = batch->runs[first + i].offset;
+        reader->end = reader->pos + batch->runs[first + i].length;
+        reader->chunk_pos = 0;
+        reader->chunk_length = 0;
+        if(dictionary_batch_next(batch, reader)) {
+            batch->heap[live++] = i;
+        } else if(!dictionary_batch_going(batch)) {
+            return false;
+        }
+    }
+    for(uint32_t i = live / 2; i-- > 0;) {
+        dictionary_batch_sift(batch, live, i);
+    }
+
+    bool merged_any = false;
+    while(live > 0) {
+        DictionaryBatchReader* reader = &batch->readers[batch->heap[0]];
+        if(!merged_any || strcasecmp(reader->word, batch->last) != 0) {
+            bool kept = to_file ? dictionary_batch_put(batch, reader->word) :
+                                  dictionary_batch_queue_word(batch, reader->word);
+            if(!kept) return false;
+            strcpy(batch->last, reader->word);
+            merged_any = true;
+        }
+        if(!dictionary_batch_next(batch, reader)) {
+            if(!dictionary_batch_going(batch)) return false;
+            batch->heap[0] = batch->heap[--live];
+        }
+        dictionary_batch_sift(batch, live, 0);
+    }
+    return true;
+}
+
+// Merges the runs into the join, first in groups into longer runs while
+// there are more than the budget holds readers for
+static void dictionary_batch_merge_runs(DictionaryBatch* batch) {
+    size_t queue_size = DICTIONARY_BATCH_JOIN_WORDS * MAX_WORD_LENGTH;
+    size_t reader_size = sizeof(DictionaryBatchReader) + sizeof(uint16_t);
+    uint32_t fan_in =
+        batch->ram_budget > queue_size ? (batch->ram_budget - queue_size) / reader_size : 0;
+    if(fan_in < 2) fan_in = 2;
+    if(fan_in > batch->run_count) fan_in = batch->run_count;
+    batch->readers = malloc(fan_in * sizeof(DictionaryBatchReader));
+    batch->heap = malloc(fan_in * sizeof(uint16_t));
+    batch->queue = malloc(queue_size);
+    for(uint32_t i = 0; i < DICTIONARY_BATCH_JOIN_WORDS; i++) {
+        batch->queued[i] = batch->queue[i];
+    }
+
+    while(batch->run_count > fan_in) {
+        uint32_t merged = 0;
+        for(uint32_t first = 0; first < batch->run_count; first += fan_in) {
+            uint32_t count = batch->run_count - first;
+            if(count > fan_in) count = fan_in;
+            uint32_t offset = batch->runs_end;
+            if(!dictionary_batch_merge(batch, first, count, true) ||
+               !dictionary_batch_end_run(batch, merged++, offset) ||
+               !dictionary_batch_report(batch)) {
+                return;
+            }
+        }
+        batch->run_count = merged;
+    }
+    if(dictionary_batch_merge(batch, 0, batch->run_count, false)) {
+        dictionary_batch_join_queue(batch, true);
+    }
+}
+
+DictionaryStatus dictionary_batch_write(
+    Dictionary* dict,
+    const char* list_path,
+    const char* runs_path,
+    size_t ram_budget,
+    DictionaryOutput* out,
+    DictionaryBatchCallback callback,
+    void* context,
+    DictionaryBatchProgress* progress) {
+    memset(progress, 0, sizeof(DictionaryBatchProgress));
+    DictionaryBatch* batch = malloc(sizeof(DictionaryBatch));
+    memset(batch, 0, sizeof(DictionaryBatch));
+    batch->dict = dict;
+    batch->storage = dictionary_get_storage(dict);
+    batch->out = out;
+    batch->callback = callback;
+    batch->context = context;
+    batch->progress = progress;
+    batch->ram_budget = ram_budget;
+    batch->runs_path = runs_path;
+    batch->arena_size = ram_budget;
+    if(batch->arena_size < DICTIONARY_BATCH_MIN_WORDS * DICTIONARY_BATCH_WORD_SIZE) {
+        batch->arena_size = DICTIONARY_BATCH_MIN_WORDS * DICTIONARY_BATCH_WORD_SIZE;
+    }
+    batch->arena_size -= batch->arena_size % sizeof(char*); // pointers at the back
+    batch->arena = malloc(batch->arena_size);
+
+    if(!dictionary_batch_read_list(batch, list_path)) {
+        batch->status = DictionaryStatusEmpty;
+    } else if(dictionary_batch_going(batch) && batch->run_count == 0) {
+        // The whole list fit: no runs to merge
+        uint32_t count = dictionary_batch_sort(batch);
+        if(count > 0) {
+            dictionary_batch_join_words(
+                batch, (const char* const*)dictionary_batch_words(batch), count);
+        }
+    } else if(dictionary_batch_going(batch)) {
+        if(batch->count == 0 || dictionary_batch_write_run(batch)) {
+            free(batch->arena);
+            batch->arena = NULL;
+            dictionary_batch_merge_runs(batch);
+        }
+    }
+
+    if(batch->runs_file) {
+        dictionary_storage_close(batch->storage, batch->runs_file);
+        dictionary_storage_remove(batch->storage, runs_path);
+    }
+    DictionaryStatus status = batch->cancelled ? DictionaryStatusCancelled : batch->status;
+    free(batch->queue);
+    free(batch->heap);
+    free(batch->readers);
+    free(batch->runs);
+    free(batch->arena);
+    free(batch);
+
+    if(status != DictionaryStatusOk) return status;
+    if(progress->done == 0) return DictionaryStatusEmpty;
+    return progress->found > 0 ? DictionaryStatusOk : DictionaryStatusNotFound;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Glossary of a word list: every word of a text file (one per line) looked
+// up and written out with its definition, in key order. The list is never
+// held whole. It is read once, a RAM budget of words at a time; each part is
+// sorted and written to a scratch file on SD as a run of distinct words. The
+// runs are then merged, a chunk of each in RAM, into one sorted stream that is
+// joined against the index a window at a time (dictionary_join()), so the key
+// blocks and the definitions in engdict.dat are read once each, front to back.
+// A list that fits the budget is joined straight from RAM and writes nothing.
+// With more runs than chunks fit the budget, groups of them are first merged
+// into longer runs appended to the same file.
+//
+// Lines are trimmed; empty ones, those starting with '#' and words too long
+// to be a key are skipped. Repeats are written once, compared as the keys
+// are, ignoring case.
+
+// RAM a word may take while the list is sorted into runs
+#define DICTIONARY_BATCH_WORD_SIZE (MAX_WORD_LENGTH + sizeof(char*))
+// Words per run however small the budget
+#define DICTIONARY_BATCH_MIN_WORDS 16
+// Bytes of the list, and of each run being merged, read at a time
+#define DICTIONARY_BATCH_CHUNK 256
+// Merged words joined against the index at a time
+#define DICTIONARY_BATCH_JOIN_WORDS 64
+// The callback runs after this many entries, and after each run is written
+#define DICTIONARY_BATCH_PROGRESS_STEP 32
+
+typedef struct {
+    uint32_t words; // lines holding a word, repeats included
+    uint32_t done; // distinct words written so far
+    uint32_t found; // of them, in the dictionary
+    uint16_t runs; // sorted runs the list was split into
+} DictionaryBatchProgress;
+
+// Returns false to cancel the run
+typedef bool (*DictionaryBatchCallback)(void* context, const DictionaryBatchProgress* progress);
+
+// Writes the glossary of the list at `list_path` into `out`: each found entry
+// as the formatter lays it out, a missing word followed by a note, and a
+// blank line after each. Both files go through the dictionary's storage:
+// `runs_path` is created for the runs when the list does not fit `ram_budget`
+// bytes, and removed before it returns. `progress` holds the counts when it
+// returns. DictionaryStatusEmpty when the list is missing or holds no word,
+// NotFound when none of its words is in the dictionary, Cancelled when the
+// callback stopped it (`out` then holds the entries written so far), and
+// ReadError when a definition or the runs could not be read or written.
+DictionaryStatus dictionary_batch_write(
+    Dictionary* dict,
+    const char* list_path,
+    const char* runs_path,
+    size_t ram_budget,
+    DictionaryOutput* out,
+    DictionaryBatchCallback callback,
+    void* context,
+    DictionaryBatchProgress* progress);
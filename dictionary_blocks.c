@@ -0,0 +1,226 @@
+#include "dictionary_blocks.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DICTIONARY_BLOCKS_NONE UINT32_MAX
+
+struct DictionaryBlocks {
+    uint8_t window_bits;
+    uint8_t lookahead_bits;
+    uint16_t preset_size;
+    uint32_t data_offset; // file offset of block 0
+    uint32_t* directory; // block_count + 1 offsets relative to data_offset
+    uint8_t* window; // the preset followed by the current block
+
+    // Decoder state of the current block, which is decoded up to `decoded`
+    // bytes and resumed where it stopped when a later read needs more
+    uint32_t block;
+    uint32_t block_length;
+    uint32_t decoded;
+    uint32_t in_offset; // next compressed byte to fetch
+    uint32_t in_end;
+    uint32_t file_position; // DICTIONARY_BLOCKS_NONE when unknown
+    uint8_t chunk[DICTIONARY_BLOCKS_CHUNK];
+    uint8_t chunk_pos;
+    uint8_t chunk_length;
+    uint32_t bits;
+    uint8_t bit_count;
+
+    DictionaryBlocksStats stats;
+};
+
+bool dictionary_blocks_load(
+    DictionaryStorage* storage,
+    DictionaryFile* dat_file,
+    DictionaryBlocks** blocks) {
+    *blocks = NULL;
+    uint8_t head[DICTIONARY_BLOCKS_HEAD_SIZE];
+    if(!dictionary_storage_read_at(storage, dat_file, 0, head, sizeof(head)) ||
+       memcmp(head, DICTIONARY_BLOCKS_MAGIC, 4) != 0) {
+        return true; // plain text
+    }
+
+    DictionaryBlocks* b = malloc(sizeof(DictionaryBlocks));
+    memset(b, 0, sizeof(DictionaryBlocks));
+    uint16_t version;
+    memcpy(&version, head + 4, sizeof(version));
+    b->window_bits = head[6];
+    b->lookahead_bits = head[7];
+    memcpy(&b->stats.block_size, head + 8, sizeof(b->stats.block_size));
+    memcpy(&b->stats.block_count, head + 12, sizeof(b->stats.block_count));
+    memcpy(&b->stats.data_size, head + 16, sizeof(b->stats.data_size));
+    memcpy(&b->preset_size, head + 20, sizeof(b->preset_size));
+    uint32_t block_count = b->stats.block_count;
+    if(version != DICTIONARY_BLOCKS_VERSION || b->window_bits == 0 || b->window_bits > 15 ||
+       b->lookahead_bits == 0 || b->lookahead_bits > 8 || b->stats.block_size == 0 ||
+       block_count != (b->stats.data_size + b->stats.block_size - 1) / b->stats.block_size) {
+        free(b);
+        return false;
+    }
+
+    size_t directory_size = (block_count + 1) * sizeof(uint32_t);
+    b->window = malloc(b->preset_size + b->stats.block_size);
+    b->directory = malloc(directory_size);
+    b->data_offset = DICTIONARY_BLOCKS_HEAD_SIZE + b->preset_size + directory_size;
+    b->block = DICTIONARY_BLOCKS_NONE;
+    b->file_position = DICTIONARY_BLOCKS_NONE;
+    b->stats.ram = sizeof(DictionaryBlocks) + b->preset_size + b->stats.block_size +
+                   directory_size;
+
+    // The preset and the directory follow the header
+    uint32_t file_size = dictionary_storage_size(storage, dat_file);
+    bool ok = dictionary_storage_read(storage, dat_file, b->window, b->preset_size) ==
+                  b->preset_size &&
+              dictionary_storage_read(storage, dat_file, b->directory, directory_size) ==
+                  directory_size &&
+              file_size >= b->data_offset &&
+              b->directory[block_count] <= file_size - b->data_offset;
+    for(uint32_t i = 0; ok && i < block_count; i++) {
+        ok = b->directory[i] <= b->directory[i + 1];
+    }
+    if(!ok) {
+        dictionary_blocks_free(b);
+        return false;
+    }
+    *blocks = b;
+    return true;
+}
+
+void dictionary_blocks_free(DictionaryBlocks* blocks) {
+    if(!blocks) return;
+    free(blocks->directory);
+    free(blocks->window);
+    free(blocks);
+}
+
+const DictionaryBlocksStats* dictionary_blocks_get_stats(const DictionaryBlocks* blocks) {
+    return &blocks->stats;
+}
+
+static void dictionary_blocks_start(DictionaryBlocks* blocks, uint32_t block) {
+    blocks->block = block;
+    blocks->block_length = blocks->stats.data_size - block * blocks->stats.block_size;
+    if(blocks->block_length > blocks->stats.block_size) {
+        blocks->block_length = blocks->stats.block_size;
+    }
+    blocks->decoded = 0;
+    blocks->in_offset = blocks->data_offset + blocks->directory[block];
+    blocks->in_end = blocks->data_offset + blocks->directory[block + 1];
+    blocks->chunk_pos = blocks->chunk_length = 0;
+    blocks->bits = blocks->bit_count = 0;
+    blocks->stats.blocks_decoded++;
+}
+
+// Takes the next `count` (<= 16) bits of the compressed block, most
+// significant first, fetching a chunk from the card when the last one is used
+static bool dictionary_blocks_get_bits(
+    DictionaryBlocks* blocks,
+    DictionaryStorage* storage,
+    DictionaryFile* dat_file,
+    uint8_t count,
+    uint32_t* value) {
+    while(blocks->bit_count < count) {
+        if(blocks->chunk_pos == blocks->chunk_length) {
+            uint32_t left = blocks->in_end - blocks->in_offset;
+            uint8_t size = left < sizeof(blocks->chunk) ? left : sizeof(blocks->chunk);
+            if(size == 0) return false;
+            // Blocks are stored back to back, so a definition running into the
+            // next block usually continues without a seek
+            if(blocks->file_position != blocks->in_offset &&
+               !dictionary_storage_seek(storage, dat_file, blocks->in_offset)) {
+                return false;
+            }
+            blocks->file_position = DICTIONARY_BLOCKS_NONE;
+            if(dictionary_storage_read(storage, dat_file, blocks->chunk, size) != size) {
+                return false;
+            }
+            blocks->in_offset += size;
+            blocks->file_position = blocks->in_offset;
+            blocks->chunk_pos = 0;
+            blocks->chunk_length = size;
+        }
+        blocks->bits = (blocks->bits << 8) | blocks->chunk[blocks->chunk_pos++];
+        blocks->bit_count += 8;
+    }
+    blocks->bit_count -= count;
+    *value = (blocks->bits >> blocks->bit_count) & ((1UL << count) - 1);
+    return true;
+}
+
+// Decodes the current block until at least `end` bytes of it are available.
+// A literal is a 1 bit and 8 bits; a back-reference is a 0 bit, the distance
+// minus one in window_bits and the length minus one in lookahead_bits.
+static bool dictionary_blocks_decode(
+    DictionaryBlocks* blocks,
+    DictionaryStorage* storage,
+    DictionaryFile* dat_file,
+    uint32_t end) {
+    uint8_t* out = blocks->window + blocks->preset_size;
+    while(blocks->decoded < end) {
+        uint32_t tag, value;
+        if(!dictionary_blocks_get_bits(blocks, storage, dat_file, 1, &tag)) return false;
+        if(tag) {
+            if(!dictionary_blocks_get_bits(blocks, storage, dat_file, 8, &value)) return false;
+            out[blocks->decoded++] = value;
+            continue;
+        }
+
+        uint32_t distance, length;
+        if(!dictionary_blocks_get_bits(
+               blocks, storage, dat_file, blocks->window_bits, &distance) ||
+           !dictionary_blocks_get_bits(
+               blocks, storage, dat_file, blocks->lookahead_bits, &length)) {
+            return false;
+        }
+        distance++;
+        length++;
+        if(distance > blocks->preset_size + blocks->decoded ||
+           length > blocks->block_length - blocks->decoded) {
+            return false;
+        }
+        // Byte by byte: the source may overlap the bytes being produced
+        uint8_t* dst = out + blocks->decoded;
+        for(uint32_t i = 0; i < length; i++) {
+            dst[i] = *(dst + i - distance);
+        }
+        blocks->decoded += length;
+    }
+    return true;
+}
+
+bool dictionary_blocks_read(
+    DictionaryBlocks* blocks,
+    DictionaryStorage* storage,
+    DictionaryFile* dat_file,
+    uint32_t offset,
+    char* buffer,
+    size_t length) {
+    if(offset > blocks->stats.data_size || length > blocks->stats.data_size - offset) {
+        return false;
+    }
+
+    while(length > 0) {
+        uint32_t block = offset / blocks->stats.block_size;
+        uint32_t start = offset % blocks->stats.block_size;
+        if(block == blocks->block) {
+            blocks->stats.blocks_reused++;
+        } else {
+            dictionary_blocks_start(blocks, block);
+        }
+        size_t count = blocks->block_length - start;
+        if(count > length) count = length;
+
+        uint32_t decoded = blocks->decoded;
+        if(!dictionary_blocks_decode(blocks, storage, dat_file, start + count)) {
+            blocks->block = DICTIONARY_BLOCKS_NONE;
+            return false;
+        }
+        blocks->stats.bytes_decoded += blocks->decoded - decoded;
+        memcpy(buffer, blocks->window + blocks->preset_size + start, count);
+        buffer += count;
+        offset += count;
+        length -= count;
+    }
+    return true;
+}
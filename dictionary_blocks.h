@@ -0,0 +1,53 @@
+#pragma once
+
+#include "dictionary_storage.h"
+
+// Block-compressed engdict.dat (tools/dictc.py compress). The text is cut into
+// fixed-size blocks, each compressed on its own with a heatshrink-style LZSS
+// whose window starts with a preset dictionary shared by all blocks. Record
+// offsets in the index still refer to the uncompressed text, so a lookup
+// decodes only the block(s) under a definition, and only up to its end,
+// streaming the compressed bytes from the card in small chunks.
+
+// engdict.dat compressed layout, see tools/README.md
+#define DICTIONARY_BLOCKS_MAGIC     "EDDZ"
+#define DICTIONARY_BLOCKS_VERSION   1
+#define DICTIONARY_BLOCKS_HEAD_SIZE 24
+// Compressed bytes read from the card at a time
+#define DICTIONARY_BLOCKS_CHUNK 128
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t block_count;
+    uint32_t data_size; // uncompressed
+    size_t ram; // preset, block buffer and block directory
+    uint32_t blocks_decoded; // blocks decoding was started for
+    uint32_t blocks_reused; // reads served by the block already decoded
+    uint32_t bytes_decoded;
+} DictionaryBlocksStats;
+
+typedef struct DictionaryBlocks DictionaryBlocks;
+
+// Reads the header, preset and block directory of an opened engdict.dat.
+// Sets `*blocks` to NULL for plain text. Returns false for a compressed file
+// that is damaged or of an unknown version.
+bool dictionary_blocks_load(
+    DictionaryStorage* storage,
+    DictionaryFile* dat_file,
+    DictionaryBlocks** blocks);
+
+void dictionary_blocks_free(DictionaryBlocks* blocks);
+
+// Copies `length` bytes of uncompressed text at `offset` into `buffer`. The
+// last block decoded stays in RAM, so neighbouring definitions cost no reads.
+// The file position is assumed to be where the last call left it, so nothing
+// else may read `dat_file` once it is loaded.
+bool dictionary_blocks_read(
+    DictionaryBlocks* blocks,
+    DictionaryStorage* storage,
+    DictionaryFile* dat_file,
+    uint32_t offset,
+    char* buffer,
+    size_t length);
+
+const DictionaryBlocksStats* dictionary_blocks_get_stats(const DictionaryBlocks* blocks);
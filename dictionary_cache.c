@@ -0,0 +1,269 @@
+#include "dictionary_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Warm set file: "EDWC", u16 version, u16 entry count, u32 dictionary tag,
+// then [u8 key length][key][u16 text length][text] from least to most
+// recently used, so loading in file order restores the recency order.
+#define DICTIONARY_CACHE_MAGIC     "EDWC"
+#define DICTIONARY_CACHE_VERSION   2
+#define DICTIONARY_CACHE_HEAD_SIZE 12
+
+// The list is short (a budget of a few KB holds tens of results), so entries
+// are found by a linear scan comparing hashes first.
+typedef struct DictionaryCacheEntry {
+    struct DictionaryCacheEntry* newer;
+    struct DictionaryCacheEntry* older;
+    uint32_t hash;
+    uint16_t text_length;
+    uint8_t key_length;
+    char data[]; // key, NUL, text, NUL
+} DictionaryCacheEntry;
+
+struct DictionaryCache {
+    DictionaryCacheEntry* newest;
+    DictionaryCacheEntry* oldest;
+    DictionaryCacheStats stats;
+};
+
+static size_t dictionary_cache_entry_size(size_t key_length, size_t text_length) {
+    return sizeof(DictionaryCacheEntry) + key_length + 1 + text_length + 1;
+}
+
+static char* dictionary_cache_entry_text(DictionaryCacheEntry* entry) {
+    return entry->data + entry->key_length + 1;
+}
+
+static uint32_t dictionary_cache_hash(const char* key, size_t length) {
+    return dictionary_fnv1a(key, length, DICTIONARY_FNV1A_BASIS);
+}
+
+static void dictionary_cache_unlink(DictionaryCache* cache, DictionaryCacheEntry* entry) {
+    if(entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+    if(entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+}
+
+static void dictionary_cache_push_newest(DictionaryCache* cache, DictionaryCacheEntry* entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if(cache->newest) {
+        cache->newest->newer = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+static void dictionary_cache_remove_entry(DictionaryCache* cache, DictionaryCacheEntry* entry) {
+    dictionary_cache_unlink(cache, entry);
+    cache->stats.bytes -= dictionary_cache_entry_size(entry->key_length, entry->text_length);
+    cache->stats.entries--;
+    free(entry);
+}
+
+static DictionaryCacheEntry*
+    dictionary_cache_find(DictionaryCache* cache, const char* key, size_t length, uint32_t hash) {
+    for(DictionaryCacheEntry* entry = cache->newest; entry; entry = entry->older) {
+        if(entry->hash == hash && entry->key_length == length &&
+           memcmp(entry->data, key, length) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Makes room for and links a new entry for `key`; the caller fills the text.
+// Returns NULL if the text is too large to cache.
+static DictionaryCacheEntry* dictionary_cache_insert(
+    DictionaryCache* cache,
+    const char* key,
+    size_t key_length,
+    size_t text_length) {
+    uint32_t hash = dictionary_cache_hash(key, key_length);
+    DictionaryCacheEntry* old = dictionary_cache_find(cache, key, key_length, hash);
+    if(old) dictionary_cache_remove_entry(cache, old);
+
+    size_t size = dictionary_cache_entry_size(key_length, text_length);
+    if(text_length > UINT16_MAX || size > cache->stats.budget / 2) return NULL;
+    while(cache->oldest && cache->stats.bytes + size > cache->stats.budget) {
+        dictionary_cache_remove_entry(cache, cache->oldest);
+        cache->stats.evictions++;
+    }
+
+    DictionaryCacheEntry* entry = malloc(size);
+    if(!entry) return NULL;
+    entry->hash = hash;
+    entry->key_length = key_length;
+    entry->text_length = text_length;
+    memcpy(entry->data, key, key_length);
+    entry->data[key_length] = '\0';
+    dictionary_cache_entry_text(entry)[text_length] = '\0';
+    dictionary_cache_push_newest(cache, entry);
+    cache->stats.bytes += size;
+    cache->stats.entries++;
+    return entry;
+}
+
+DictionaryCache* dictionary_cache_alloc(size_t budget) {
+    DictionaryCache* cache = malloc(sizeof(DictionaryCache));
+    memset(cache, 0, sizeof(DictionaryCache));
+    cache->stats.budget = budget;
+    return cache;
+}
+
+void dictionary_cache_free(DictionaryCache* cache) {
+    if(!cache) return;
+    while(cache->oldest)
+        dictionary_cache_remove_entry(cache, cache->oldest);
+    free(cache);
+}
+
+const char* dictionary_cache_get(DictionaryCache* cache, const char* word, size_t* length) {
+    char key[MAX_WORD_LENGTH];
+    size_t key_length = dictionary_key_normalize(word, key);
+    DictionaryCacheEntry* entry =
+        key_length ?
+            dictionary_cache_find(cache, key, key_length, dictionary_cache_hash(key, key_length)) :
+            NULL;
+    if(!entry) {
+        cache->stats.misses++;
+        return NULL;
+    }
+
+    cache->stats.hits++;
+    dictionary_cache_unlink(cache, entry);
+    dictionary_cache_push_newest(cache, entry);
+    if(length) *length = entry->text_length;
+    return dictionary_cache_entry_text(entry);
+}
+
+const char* dictionary_cache_peek(DictionaryCache* cache, const char* word, size_t* length) {
+    char key[MAX_WORD_LENGTH];
+    size_t key_length = dictionary_key_normalize(word, key);
+    DictionaryCacheEntry* entry =
+        key_length ?
+            dictionary_cache_find(cache, key, key_length, dictionary_cache_hash(key, key_length)) :
+            NULL;
+    if(!entry) return NULL;
+    if(length) *length = entry->text_length;
+    return dictionary_cache_entry_text(entry);
+}
+
+char* dictionary_cache_reserve(DictionaryCache* cache, const char* word, size_t length) {
+    char key[MAX_WORD_LENGTH];
+    size_t key_length = dictionary_key_normalize(word, key);
+    if(!key_length) return NULL;
+    DictionaryCacheEntry* entry = dictionary_cache_insert(cache, key, key_length, length);
+    return entry ? dictionary_cache_entry_text(entry) : NULL;
+}
+
+void dictionary_cache_put(
+    DictionaryCache* cache,
+    const char* word,
+    const char* text,
+    size_t length) {
+    char* cached = dictionary_cache_reserve(cache, word, length);
+    if(cached) memcpy(cached, text, length);
+}
+
+void dictionary_cache_remove(DictionaryCache* cache, const char* word) {
+    char key[MAX_WORD_LENGTH];
+    size_t key_length = dictionary_key_normalize(word, key);
+    DictionaryCacheEntry* entry =
+        key_length ?
+            dictionary_cache_find(cache, key, key_length, dictionary_cache_hash(key, key_length)) :
+            NULL;
+    if(entry) dictionary_cache_remove_entry(cache, entry);
+}
+
+const DictionaryCacheStats* dictionary_cache_get_stats(const DictionaryCache* cache) {
+    return &cache->stats;
+}
+
+// --- Warm set ---
+
+void dictionary_cache_save(
+    const DictionaryCache* cache,
+    DictionaryOutput* out,
+    uint32_t tag,
+    size_t max_bytes) {
+    // Walk back from the newest entry as far as the byte limit allows
+    uint16_t count = 0;
+    size_t bytes = 0;
+    const DictionaryCacheEntry* first = NULL;
+    for(const DictionaryCacheEntry* entry = cache->newest; entry; entry = entry->older) {
+        if(bytes + entry->text_length > max_bytes) break;
+        bytes += entry->text_length;
+        count++;
+        first = entry;
+    }
+
+    uint8_t head[DICTIONARY_CACHE_HEAD_SIZE];
+    uint16_t version = DICTIONARY_CACHE_VERSION;
+    memcpy(head, DICTIONARY_CACHE_MAGIC, 4);
+    memcpy(head + 4, &version, sizeof(version));
+    memcpy(head + 6, &count, sizeof(count));
+    memcpy(head + 8, &tag, sizeof(tag));
+    out->write(out->context, (const char*)head, sizeof(head));
+
+    for(const DictionaryCacheEntry* entry = first; entry && count > 0;
+        entry = entry->newer, count--) {
+        uint8_t key_length = entry->key_length;
+        uint16_t text_length = entry->text_length;
+        out->write(out->context, (const char*)&key_length, sizeof(key_length));
+        out->write(out->context, entry->data, key_length);
+        out->write(out->context, (const char*)&text_length, sizeof(text_length));
+        out->write(out->context, entry->data + key_length + 1, text_length);
+    }
+}
+
+bool dictionary_cache_load(
+    DictionaryCache* cache,
+    DictionaryStorage* storage,
+    DictionaryFile* file,
+    uint32_t tag) {
+    uint8_t head[DICTIONARY_CACHE_HEAD_SIZE];
+    uint16_t version, count;
+    uint32_t saved_tag;
+    if(!dictionary_storage_read_at(storage, file, 0, head, sizeof(head)) ||
+       memcmp(head, DICTIONARY_CACHE_MAGIC, 4) != 0) {
+        return false;
+    }
+    memcpy(&version, head + 4, sizeof(version));
+    memcpy(&count, head + 6, sizeof(count));
+    memcpy(&saved_tag, head + 8, sizeof(saved_tag));
+    if(version != DICTIONARY_CACHE_VERSION || saved_tag != tag) return false;
+
+    // Entries are read sequentially after the header
+    for(uint16_t i = 0; i < count; i++) {
+        uint8_t key_length;
+        uint16_t text_length;
+        char key[MAX_WORD_LENGTH];
+        if(dictionary_storage_read(storage, file, &key_length, 1) != 1 ||
+           key_length == 0 || key_length >= MAX_WORD_LENGTH ||
+           dictionary_storage_read(storage, file, key, key_length) != key_length ||
+           dictionary_storage_read(storage, file, &text_length, 2) != 2) {
+            return false;
+        }
+        key[key_length] = '\0';
+
+        DictionaryCacheEntry* entry =
+            dictionary_cache_insert(cache, key, key_length, text_length);
+        if(!entry) return false;
+        if(dictionary_storage_read(
+               storage, file, dictionary_cache_entry_text(entry), text_length) != text_length) {
+            dictionary_cache_remove_entry(cache, entry);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Byte-budgeted LRU cache of raw definitions, keyed by the lowercased,
+// trimmed headword; the result view formats them as it scrolls. Repeat
+// lookups and history taps are served from RAM without touching the SD card.
+// The most recently used entries can be saved as a warm set and loaded on
+// the next launch.
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t entries;
+    size_t bytes; // charged to the budget, including entry overhead
+    size_t budget;
+} DictionaryCacheStats;
+
+typedef struct DictionaryCache DictionaryCache;
+
+DictionaryCache* dictionary_cache_alloc(size_t budget);
+
+void dictionary_cache_free(DictionaryCache* cache);
+
+// Returns the cached text for `word` and makes it the most recently used, or
+// NULL on a miss. The text stays valid until the next put, reserve or load.
+const char* dictionary_cache_get(DictionaryCache* cache, const char* word, size_t* length);
+
+// Like get, but leaves the recency order and the hit counts alone; for
+// rereading an entry already shown and for checking before a prefetch
+const char* dictionary_cache_peek(DictionaryCache* cache, const char* word, size_t* length);
+
+// Replaces any entry for `word`; evicts least recently used entries to make
+// room. Texts larger than half the budget are not cached.
+void dictionary_cache_put(
+    DictionaryCache* cache,
+    const char* word,
+    const char* text,
+    size_t length);
+
+// Like put, but returns room for `length` bytes of text (NUL-terminated) for
+// the caller to fill, or NULL if the text would not be cached
+char* dictionary_cache_reserve(DictionaryCache* cache, const char* word, size_t length);
+
+// Drops the entry for `word`, e.g. when filling a reserved one failed
+void dictionary_cache_remove(DictionaryCache* cache, const char* word);
+
+const DictionaryCacheStats* dictionary_cache_get_stats(const DictionaryCache* cache);
+
+// Writes the most recently used entries, up to `max_bytes` of text, to `out`.
+// `tag` identifies the dictionary they came from (dictionary_get_tag()).
+void dictionary_cache_save(
+    const DictionaryCache* cache,
+    DictionaryOutput* out,
+    uint32_t tag,
+    size_t max_bytes);
+
+// Loads a saved warm set; false if the file is damaged or was saved for a
+// different dictionary.
+bool dictionary_cache_load(
+    DictionaryCache* cache,
+    DictionaryStorage* storage,
+    DictionaryFile* file,
+    uint32_t tag);
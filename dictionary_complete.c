@@ -0,0 +1,92 @@
+#include "dictionary_complete.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ranges[k] holds the records starting with the first k characters of
+// prefix, so typing narrows ranges[k - 1] and deleting just pops the stack.
+typedef struct {
+    uint32_t low, high;
+} DictionaryRange;
+
+struct DictionaryCompleter {
+    Dictionary* dict;
+    char prefix[MAX_WORD_LENGTH];
+    size_t depth; // valid entries in ranges beyond ranges[0]
+    DictionaryRange ranges[MAX_WORD_LENGTH];
+};
+
+DictionaryCompleter* dictionary_completer_alloc(Dictionary* dict) {
+    DictionaryCompleter* completer = malloc(sizeof(DictionaryCompleter));
+    completer->dict = dict;
+    completer->prefix[0] = '\0';
+    completer->depth = 0;
+    return completer;
+}
+
+void dictionary_completer_free(DictionaryCompleter* completer) {
+    free(completer);
+}
+
+void dictionary_completer_update(
+    DictionaryCompleter* completer,
+    const char* prefix,
+    DictionaryCompletions* completions) {
+    memset(completions, 0, sizeof(DictionaryCompletions));
+    Dictionary* dict = completer->dict;
+    DictionaryFile* idx_file = dictionary_get_index_file(dict);
+    size_t len = strlen(prefix);
+    if(!idx_file || len == 0 || len >= MAX_WORD_LENGTH) return;
+    // The index may have been reopened (and changed) since the last update
+    completer->ranges[0].low = 0;
+    completer->ranges[0].high = dictionary_get_record_count(dict);
+
+    // Keep the ranges of the part of the prefix that did not change
+    size_t depth = 0;
+    while(depth < completer->depth && depth < len &&
+          tolower((unsigned char)prefix[depth]) ==
+              tolower((unsigned char)completer->prefix[depth])) {
+        depth++;
+    }
+
+    DictionaryStorage* storage = dictionary_get_storage(dict);
+    uint32_t reads_start = storage->stats.reads;
+
+    char partial[MAX_WORD_LENGTH];
+    memcpy(partial, prefix, len + 1);
+    for(; depth < len; depth++) {
+        DictionaryRange* parent = &completer->ranges[depth];
+        DictionaryRange* range = &completer->ranges[depth + 1];
+        partial[depth + 1] = '\0';
+        range->low =
+            dictionary_lower_bound(dict, idx_file, partial, false, parent->low, parent->high);
+        range->high =
+            dictionary_lower_bound(dict, idx_file, partial, true, range->low, parent->high);
+        partial[depth + 1] = prefix[depth + 1];
+    }
+    memcpy(completer->prefix, prefix, len + 1);
+    completer->depth = len;
+
+    DictionaryRange* range = &completer->ranges[len];
+    completions->matches = range->high - range->low;
+    for(uint32_t id = range->low;
+        id < range->high && completions->count < DICTIONARY_COMPLETE_MAX;
+        id++) {
+        // The first candidate is always listed, even past the budget
+        if(completions->count > 0 &&
+           storage->stats.reads - reads_start >= DICTIONARY_COMPLETE_READ_BUDGET) {
+            completions->truncated = true;
+            break;
+        }
+        DictionaryRecord record;
+        if(!dictionary_read_key(dict, idx_file, id, &record)) break;
+        memcpy(completions->words[completions->count++], record.key, MAX_WORD_LENGTH);
+    }
+
+    // Ranges computed from failed reads are meaningless: start over next time
+    if(!dictionary_check_files(dict)) {
+        memset(completions, 0, sizeof(DictionaryCompletions));
+        completer->depth = 0;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Incremental prefix completion over the sorted index. The keys starting with
+// the prefix form a range found by two lower-bound searches; each typed
+// character narrows the previous range, and deleting reuses the stored one.
+
+#define DICTIONARY_COMPLETE_MAX 4
+
+// Storage reads one update may issue (~one frame on the SD card). The range
+// search needs at most two with the RAM key index; listing stops after the
+// first candidate when the budget runs out.
+#define DICTIONARY_COMPLETE_READ_BUDGET 4
+
+typedef struct {
+    char words[DICTIONARY_COMPLETE_MAX][MAX_WORD_LENGTH];
+    uint8_t count;
+    uint32_t matches; // keys starting with the prefix
+    bool truncated; // the read budget ran out before the list was full
+} DictionaryCompletions;
+
+typedef struct DictionaryCompleter DictionaryCompleter;
+
+// Reads through the dictionary's session idx handle
+DictionaryCompleter* dictionary_completer_alloc(Dictionary* dict);
+
+void dictionary_completer_free(DictionaryCompleter* completer);
+
+void dictionary_completer_update(
+    DictionaryCompleter* completer,
+    const char* prefix,
+    DictionaryCompletions* completions);
@@ -0,0 +1,637 @@
+#include "dictionary_core.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Dictionary {
+    DictionaryStorage* storage;
+    const char* idx_path;
+    const char* dat_path;
+    size_t ram_budget;
+    DictionaryIndexInfo info; // is_v2 is false for legacy or missing indexes
+    DictionaryKeyIndex* key_index;
+    DictionaryHashIndex* hash_index; // loaded even with a zero budget
+    DictionaryInflections* inflections; // NULL without an INFL section
+    DictionaryGlossList glosses; // of the last definition read, with a GLOS section
+    bool layout; // the LINE section is laid out for the pager
+    bool hot; // the hot word table matches the index (or there is none yet)
+
+    // Session: both files stay open between lookups and are reopened after
+    // an operation on them fails (e.g. the SD card was remounted)
+    DictionaryFile* idx_file;
+    DictionaryFile* dat_file;
+    DictionaryBlocks* blocks; // NULL while engdict.dat is closed or plain text
+    uint32_t dat_position; // of plain text engdict.dat, UINT32_MAX if unknown
+    uint32_t closes; // times the files were closed, so a join sees its handle go
+};
+
+// Reads the header of a freshly opened index. The key and hash indexes are
+// (re)loaded only when the header differs from the one in use, so reopening
+// an unchanged file after a remount keeps them. The hash displacements come
+// out of the RAM budget first, being small; the key index gets the rest.
+static void dictionary_load_header(Dictionary* dict) {
+    DictionaryIndexInfo info;
+    dictionary_index_read_header(dict->storage, dict->idx_file, &info);
+    dict->hot = dictionary_hot_matches(
+        info.is_v2 ? info.record_count : 0,
+        dictionary_storage_size(dict->storage, dict->idx_file));
+    if((dict->key_index || dict->hash_index || dict->inflections) &&
+       memcmp(&info, &dict->info, sizeof(info)) == 0) {
+        return;
+    }
+
+    dictionary_key_index_free(dict->key_index);
+    dictionary_hash_index_free(dict->hash_index);
+    dictionary_inflections_free(dict->inflections);
+    dict->key_index = NULL;
+    dict->hash_index = NULL;
+    dict->inflections = NULL;
+    memcpy(&dict->info, &info, sizeof(info)); // padding too, see dictionary_get_tag()
+    dictionary_gloss_list_reset(&dict->glosses);
+    dict->layout = false;
+    if(!info.is_v2) return;
+
+    dict->inflections = dictionary_inflections_load(dict->storage, dict->idx_file, &dict->info);
+    dict->layout = dictionary_layout_check(dict->storage, dict->idx_file, &dict->info);
+
+    size_t budget = dict->ram_budget;
+    dict->hash_index =
+        dictionary_hash_index_load(dict->storage, dict->idx_file, &dict->info, budget);
+    if(dict->hash_index) {
+        size_t size = dictionary_hash_index_get_size(dict->hash_index);
+        budget = size < budget ? budget - size : 0;
+    }
+    if(budget > 0) {
+        dict->key_index =
+            dictionary_key_index_load(dict->storage, dict->idx_file, &dict->info, budget);
+    }
+}
+
+Dictionary* dictionary_alloc(
+    DictionaryStorage* storage,
+    const char* idx_path,
+    const char* dat_path,
+    size_t ram_budget) {
+    Dictionary* dict = malloc(sizeof(Dictionary));
+    memset(dict, 0, sizeof(Dictionary));
+    dict->storage = storage;
+    dict->idx_path = idx_path;
+    dict->dat_path = dat_path;
+    dict->ram_budget = ram_budget;
+    dict->dat_position = UINT32_MAX;
+    dictionary_gloss_list_reset(&dict->glosses);
+    dict->hot = dictionary_hot_get_count() > 0;
+    dictionary_get_index_file(dict);
+    return dict;
+}
+
+static void dictionary_close_files(Dictionary* dict) {
+    dictionary_storage_close(dict->storage, dict->idx_file);
+    dictionary_storage_close(dict->storage, dict->dat_file);
+    dict->idx_file = NULL;
+    dict->dat_file = NULL;
+    dictionary_blocks_free(dict->blocks);
+    dict->blocks = NULL;
+    dict->dat_position = UINT32_MAX;
+    dict->closes++;
+}
+
+void dictionary_free(Dictionary* dict) {
+    if(!dict) return;
+    dictionary_close_files(dict);
+    dictionary_key_index_free(dict->key_index);
+    dictionary_hash_index_free(dict->hash_index);
+    dictionary_inflections_free(dict->inflections);
+    free(dict);
+}
+
+const DictionaryKeyIndex* dictionary_get_key_index(const Dictionary* dict) {
+    return dict->key_index;
+}
+
+const DictionaryHashIndex* dictionary_get_hash_index(const Dictionary* dict) {
+    return dict->hash_index;
+}
+
+const DictionaryInflections* dictionary_get_inflections(const Dictionary* dict) {
+    return dict->inflections;
+}
+
+const DictionaryBlocks* dictionary_get_blocks(const Dictionary* dict) {
+    return dict->blocks;
+}
+
+bool dictionary_uses_hot_table(const Dictionary* dict) {
+    return dict->hot;
+}
+
+uint32_t dictionary_fnv1a(const void* data, size_t length, uint32_t basis) {
+    const uint8_t* bytes = data;
+    uint32_t hash = basis;
+    for(size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+size_t dictionary_key_normalize(const char* word, char* key) {
+    while(isspace((unsigned char)*word))
+        word++;
+    size_t length = strlen(word);
+    while(length > 0 && isspace((unsigned char)word[length - 1]))
+        length--;
+    if(length == 0 || length >= MAX_WORD_LENGTH) return 0;
+    for(size_t i = 0; i < length; i++)
+        key[i] = tolower((unsigned char)word[i]);
+    key[length] = '\0';
+    return length;
+}
+
+DictionaryStorage* dictionary_get_storage(Dictionary* dict) {
+    return dict->storage;
+}
+
+// --- Sorted key access ---
+
+DictionaryFile* dictionary_get_index_file(Dictionary* dict) {
+    if(!dict->idx_file) {
+        dict->idx_file = dictionary_storage_open(dict->storage, dict->idx_path);
+        if(dict->idx_file) dictionary_load_header(dict);
+    }
+    return dict->idx_file;
+}
+
+bool dictionary_check_files(Dictionary* dict) {
+    if(dictionary_storage_failed(dict->storage, dict->idx_file) ||
+       dictionary_storage_failed(dict->storage, dict->dat_file)) {
+        dictionary_close_files(dict);
+        return false;
+    }
+    return true;
+}
+
+uint32_t dictionary_get_record_count(const Dictionary* dict) {
+    return dict->info.is_v2 ? dict->info.record_count : 0;
+}
+
+const DictionaryIndexInfo* dictionary_get_index_info(const Dictionary* dict) {
+    return &dict->info;
+}
+
+uint32_t dictionary_get_tag(const Dictionary* dict) {
+    // The info is zero-initialised before it is filled, padding included
+    return dictionary_fnv1a(&dict->info, sizeof(dict->info), DICTIONARY_FNV1A_BASIS);
+}
+
+bool dictionary_read_key(
+    Dictionary* dict,
+    DictionaryFile* idx_file,
+    uint32_t id,
+    DictionaryRecord* record) {
+    if(dict->key_index) {
+        return dictionary_key_index_read_record(
+            dict->key_index, dict->storage, idx_file, id, record);
+    }
+    return dict->info.is_v2 &&
+           dictionary_index_read_record(dict->storage, idx_file, &dict->info, id, record);
+}
+
+uint32_t dictionary_lower_bound(
+    Dictionary* dict,
+    DictionaryFile* idx_file,
+    const char* prefix,
+    bool past_prefix,
+    uint32_t low,
+    uint32_t high) {
+    if(dict->key_index) {
+        return dictionary_key_index_lower_bound(
+            dict->key_index, dict->storage, idx_file, prefix, past_prefix, low, high);
+    }
+    return dictionary_index_lower_bound(
+        dict->storage, idx_file, &dict->info, prefix, past_prefix, low, high);
+}
+
+// --- Lookups ---
+
+static bool dictionary_open_files(Dictionary* dict, DictionaryFile** idx, DictionaryFile** dat) {
+    *idx = dictionary_get_index_file(dict);
+    if(!dict->dat_file) {
+        dict->dat_file = dictionary_storage_open(dict->storage, dict->dat_path);
+        // A damaged compressed file is as good as a missing one
+        if(dict->dat_file &&
+           !dictionary_blocks_load(dict->storage, dict->dat_file, &dict->blocks)) {
+            dictionary_storage_close(dict->storage, dict->dat_file);
+            dict->dat_file = NULL;
+        }
+    }
+    *dat = dict->dat_file;
+    return *idx && *dat;
+}
+
+// The key index reads nothing when the word's block is resident, else the
+// block. The hash index reads one small slot, plus the displacement when it
+// is not in RAM; that beats a block once blocks reach a few hundred bytes.
+static bool dictionary_prefers_hash(Dictionary* dict, const char* word) {
+    if(!dict->hash_index) return false;
+    return !dict->key_index || !dictionary_key_index_is_resident(dict->key_index, word);
+}
+
+static DictionaryStatus
+    dictionary_find_once(Dictionary* dict, const char* word, DictionaryRecord* record) {
+    DictionaryFile *idx_file, *dat_file;
+    if(!dictionary_open_files(dict, &idx_file, &dat_file)) return DictionaryStatusNoFiles;
+
+    bool hit;
+    if(dictionary_prefers_hash(dict, word)) {
+        hit = dictionary_hash_index_find(
+            dict->hash_index, dict->storage, idx_file, &dict->info, word, record);
+    } else if(dict->key_index) {
+        hit = dictionary_key_index_find(dict->key_index, dict->storage, idx_file, word, record);
+    } else if(dict->info.is_v2) {
+        hit = dictionary_index_find(dict->storage, idx_file, &dict->info, word, record);
+    } else {
+        hit = dictionary_index_find_legacy(dict->storage, idx_file, word, record);
+    }
+    return hit ? DictionaryStatusOk : DictionaryStatusNotFound;
+}
+
+DictionaryStatus dictionary_find(Dictionary* dict, const char* word, DictionaryRecord* record) {
+    // Hot words are in the .fap: neither file is touched, or even opened
+    if(dict->hot && dictionary_hot_find(word, record)) return DictionaryStatusOk;
+    DictionaryStatus status = dictionary_find_once(dict, word, record);
+    // A failed read usually means the card was remounted: retry once on
+    // fresh handles (a miss may also have been a failed read)
+    if(!dictionary_check_files(dict)) {
+        status = dictionary_find_once(dict, word, record);
+        if(!dictionary_check_files(dict)) status = DictionaryStatusReadError;
+    }
+    return status;
+}
+
+static DictionaryStatus
+    dictionary_find_lemma_once(Dictionary* dict, const char* form, DictionaryRecord* record) {
+    DictionaryFile *idx_file, *dat_file;
+    if(!dictionary_open_files(dict, &idx_file, &dat_file)) return DictionaryStatusNoFiles;
+    if(!dict->inflections) return DictionaryStatusNotFound;
+
+    uint32_t id;
+    if(!dictionary_inflections_find(
+           dict->inflections, dict->storage, idx_file, &dict->info, form, &id)) {
+        return DictionaryStatusNotFound;
+    }
+    return dictionary_read_key(dict, idx_file, id, record) ? DictionaryStatusOk :
+                                                             DictionaryStatusReadError;
+}
+
+DictionaryStatus
+    dictionary_find_lemma(Dictionary* dict, const char* form, DictionaryRecord* record) {
+    DictionaryStatus status = dictionary_find_lemma_once(dict, form, record);
+    if(!dictionary_check_files(dict)) {
+        status = dictionary_find_lemma_once(dict, form, record);
+        if(!dictionary_check_files(dict)) status = DictionaryStatusReadError;
+    }
+    return status;
+}
+
+static DictionaryStatus dictionary_pick_once(
+    Dictionary* dict,
+    DictionaryRng* rng,
+    bool weighted,
+    DictionaryRecord* record) {
+    DictionaryFile *idx_file, *dat_file;
+    if(!dictionary_open_files(dict, &idx_file, &dat_file)) return DictionaryStatusNoFiles;
+
+    bool is_v2 = dict->info.is_v2;
+    uint32_t count = is_v2 ? dict->info.record_count :
+                             dictionary_index_count_legacy(dict->storage, idx_file);
+    if(count == 0) return DictionaryStatusEmpty;
+
+    // v2 addresses the record directly, legacy walks up to it
+    uint32_t target = dictionary_rng_below(rng, count);
+    bool read_ok = true;
+    if(weighted && dictionary_has_weighted_random(dict)) {
+        read_ok = dictionary_index_read_alias(
+            dict->storage, idx_file, &dict->info, target, dictionary_rng_next(rng), &target);
+    }
+    read_ok = read_ok && (is_v2 ? dictionary_read_key(dict, idx_file, target, record) :
+                                  dictionary_index_read_nth_legacy(
+                                      dict->storage, idx_file, target, record));
+    return read_ok ? DictionaryStatusOk : DictionaryStatusReadError;
+}
+
+DictionaryStatus dictionary_pick(
+    Dictionary* dict,
+    DictionaryRng* rng,
+    bool weighted,
+    DictionaryRecord* record) {
+    DictionaryStatus status = dictionary_pick_once(dict, rng, weighted, record);
+    if(!dictionary_check_files(dict)) {
+        status = dictionary_pick_once(dict, rng, weighted, record);
+        if(!dictionary_check_files(dict)) status = DictionaryStatusReadError;
+    }
+    return status;
+}
+
+static bool dictionary_read_definition_once(
+    Dictionary* dict,
+    uint32_t offset,
+    char* buffer,
+    size_t size) {
+    DictionaryFile *idx_file, *dat_file;
+    if(!dictionary_open_files(dict, &idx_file, &dat_file)) return false;
+    if(dict->blocks) {
+        return dictionary_blocks_read(dict->blocks, dict->storage, dat_file, offset, buffer, size);
+    }
+
+    // Windows of one definition follow each other, so only the first seeks
+    if(dict->dat_position != offset) {
+        dict->dat_position = UINT32_MAX;
+        if(!dictionary_storage_seek(dict->storage, dat_file, offset)) return false;
+    }
+    if(dictionary_storage_read(dict->storage, dat_file, buffer, size) != size) {
+        dict->dat_position = UINT32_MAX;
+        return false;
+    }
+    dict->dat_position = offset + size;
+    return true;
+}
+
+static bool dictionary_read_range(void* context, uint32_t offset, char* buffer, size_t size) {
+    return dictionary_read_definition_once(context, offset, buffer, size);
+}
+
+// With a GLOS section the text is put together from the record's gloss
+// list, which stays loaded while the windows of one definition are read
+static bool dictionary_read_text(
+    Dictionary* dict,
+    const DictionaryRecord* record,
+    uint32_t pos,
+    char* buffer,
+    size_t size) {
+    DictionaryFile* idx_file = dictionary_get_index_file(dict);
+    if(!idx_file || !dict->info.glosses_offset) {
+        return dictionary_read_definition_once(dict, record->offset + pos, buffer, size);
+    }
+    return dictionary_gloss_list_load(
+               &dict->glosses, dict->storage, idx_file, &dict->info, record->id) &&
+           dict->glosses.length == record->length &&
+           dictionary_gloss_list_read(
+               &dict->glosses, pos, buffer, size, dictionary_read_range, dict);
+}
+
+size_t dictionary_read_definition(
+    Dictionary* dict,
+    const DictionaryRecord* record,
+    uint32_t pos,
+    char* buffer,
+    size_t size) {
+    if(record->hot) return dictionary_hot_read(record, pos, buffer, size);
+    if(pos >= record->length) return 0;
+    if(size > (size_t)record->length - pos) size = record->length - pos;
+
+    bool read_ok = dictionary_read_text(dict, record, pos, buffer, size);
+    if(!dictionary_check_files(dict)) {
+        read_ok = dictionary_read_text(dict, record, pos, buffer, size) &&
+                  dictionary_check_files(dict);
+    }
+    return read_ok ? size : 0;
+}
+
+static bool dictionary_get_layout_once(
+    Dictionary* dict,
+    const DictionaryRecord* record,
+    DictionaryLayout* layout) {
+    DictionaryFile* idx_file = dictionary_get_index_file(dict);
+    return idx_file && dict->layout &&
+           dictionary_layout_load(layout, dict->storage, idx_file, &dict->info, record->id);
+}
+
+bool dictionary_get_layout(
+    Dictionary* dict,
+    const DictionaryRecord* record,
+    DictionaryLayout* layout) {
+    memset(layout, 0, sizeof(DictionaryLayout));
+    if(record->hot || record->id == UINT32_MAX) return false;
+    bool read_ok = dictionary_get_layout_once(dict, record, layout);
+    if(!dictionary_check_files(dict)) {
+        read_ok = dictionary_get_layout_once(dict, record, layout) &&
+                  dictionary_check_files(dict);
+        if(!read_ok) memset(layout, 0, sizeof(DictionaryLayout));
+    }
+    return read_ok;
+}
+
+static bool dictionary_read_layout_line_once(
+    Dictionary* dict,
+    const DictionaryLayout* layout,
+    uint32_t line,
+    DictionaryFormatState* state) {
+    DictionaryFile* idx_file = dictionary_get_index_file(dict);
+    return idx_file && dict->layout &&
+           dictionary_layout_read_line(layout, dict->storage, idx_file, &dict->info, line, state);
+}
+
+bool dictionary_read_layout_line(
+    Dictionary* dict,
+    const DictionaryLayout* layout,
+    uint32_t line,
+    DictionaryFormatState* state) {
+    bool read_ok = dictionary_read_layout_line_once(dict, layout, line, state);
+    if(!dictionary_check_files(dict)) {
+        read_ok = dictionary_read_layout_line_once(dict, layout, line, state) &&
+                  dictionary_check_files(dict);
+    }
+    return read_ok;
+}
+
+static bool dictionary_read_layout_lines_once(
+    Dictionary* dict,
+    const DictionaryLayout* layout,
+    void* entries) {
+    DictionaryFile* idx_file = dictionary_get_index_file(dict);
+    return idx_file && dict->layout &&
+           dictionary_layout_read_lines(layout, dict->storage, idx_file, &dict->info, entries);
+}
+
+bool dictionary_read_layout_lines(
+    Dictionary* dict,
+    const DictionaryLayout* layout,
+    void* entries) {
+    bool read_ok = dictionary_read_layout_lines_once(dict, layout, entries);
+    if(!dictionary_check_files(dict)) {
+        read_ok = dictionary_read_layout_lines_once(dict, layout, entries) &&
+                  dictionary_check_files(dict);
+    }
+    return read_ok;
+}
+
+static size_t dictionary_entry_read(void* context, uint32_t pos, char* buffer, size_t size) {
+    DictionaryEntry* entry = context;
+    return dictionary_read_definition(entry->dict, &entry->record, pos, buffer, size);
+}
+
+static bool
+    dictionary_entry_read_line(void* context, uint32_t line, DictionaryFormatState* state) {
+    DictionaryEntry* entry = context;
+    return dictionary_read_layout_line(entry->dict, &entry->layout, line, state);
+}
+
+void dictionary_entry_get_source(DictionaryEntry* entry, DictionaryTextSource* source) {
+    source->read = dictionary_entry_read;
+    source->read_line = entry->layout.count > 0 ? dictionary_entry_read_line : NULL;
+    source->context = entry;
+    source->length = entry->record.length;
+    source->lines = entry->layout.count;
+}
+
+bool dictionary_entry_load_layout(DictionaryEntry* entry) {
+    return dictionary_get_layout(entry->dict, &entry->record, &entry->layout);
+}
+
+// Streams the formatted entry into `out`
+DictionaryStatus dictionary_entry_write(DictionaryEntry* entry, DictionaryOutput* out) {
+    DictionaryTextSource source;
+    DictionaryFormatter formatter;
+    dictionary_entry_get_source(entry, &source);
+    dictionary_formatter_init(&formatter, &source, entry->record.key);
+    return dictionary_formatter_write_all(&formatter, out) ? DictionaryStatusOk :
+                                                              DictionaryStatusReadError;
+}
+
+DictionaryStatus dictionary_search(Dictionary* dict, const char* word, DictionaryOutput* out) {
+    DictionaryEntry entry = {.dict = dict};
+    DictionaryStatus status = dictionary_find(dict, word, &entry.record);
+    return status == DictionaryStatusOk ? dictionary_entry_write(&entry, out) : status;
+}
+
+typedef struct {
+    Dictionary* dict;
+    DictionaryJoinCallback visit;
+    void* context;
+    uint32_t first; // of the words being walked
+    uint32_t closes; // dict->closes when the walk started
+    bool stopped; // by `visit`
+} DictionaryJoin;
+
+static bool
+    dictionary_join_visit(void* context, uint32_t word_index, const DictionaryRecord* record) {
+    DictionaryJoin* join = context;
+    if(!join->visit(join->context, join->first + word_index, record)) {
+        join->stopped = true;
+        return false;
+    }
+    // Reading a definition may have reopened the files after a failure,
+    // closing the handle (and maybe the key index) the walk reads through
+    return join->dict->closes == join->closes;
+}
+
+// Finds the word at join->first on its own and visits it
+static DictionaryStatus dictionary_join_one(DictionaryJoin* join, const char* word) {
+    DictionaryRecord record;
+    DictionaryStatus status = dictionary_find(join->dict, word, &record);
+    if(status != DictionaryStatusOk && status != DictionaryStatusNotFound) return status;
+    join->stopped =
+        !join->visit(join->context, join->first, status == DictionaryStatusOk ? &record : NULL);
+    return DictionaryStatusOk;
+}
+
+DictionaryStatus dictionary_join(
+    Dictionary* dict,
+    const char* const* words,
+    uint32_t count,
+    DictionaryJoinCallback visit,
+    void* context) {
+    if(!dictionary_get_index_file(dict)) return DictionaryStatusNoFiles;
+
+    DictionaryJoin join = {.dict = dict, .visit = visit, .context = context};
+    uint32_t block =
+        count > 0 && dict->key_index ? dictionary_key_index_locate(dict->key_index, words[0]) : 0;
+    for(uint32_t first = 0; first < count && !join.stopped;) {
+        join.first = first;
+        if(!dict->key_index) {
+            DictionaryStatus status = dictionary_join_one(&join, words[first++]);
+            if(status != DictionaryStatusOk) return status;
+            continue;
+        }
+
+        // The words sharing a key block are walked together. A lone one in a
+        // block on SD is cheaper to find through the hash slot.
+        uint32_t end = first + 1;
+        uint32_t next_block = 0;
+        while(end < count) {
+            next_block = dictionary_key_index_locate(dict->key_index, words[end]);
+            if(next_block != block) break;
+            end++;
+        }
+        if(end - first == 1 && dictionary_prefers_hash(dict, words[first])) {
+            DictionaryStatus status = dictionary_join_one(&join, words[first]);
+            if(status != DictionaryStatusOk) return status;
+        } else {
+            DictionaryFile* idx_file = dictionary_get_index_file(dict);
+            if(!idx_file) return DictionaryStatusNoFiles;
+            join.closes = dict->closes;
+            bool read_ok = dictionary_key_index_join(
+                dict->key_index,
+                dict->storage,
+                idx_file,
+                words + first,
+                end - first,
+                dictionary_join_visit,
+                &join);
+            if(dict->closes != join.closes || !read_ok || !dictionary_check_files(dict)) {
+                return DictionaryStatusReadError;
+            }
+        }
+        first = end;
+        block = next_block;
+    }
+    return DictionaryStatusOk;
+}
+
+uint32_t dictionary_join_prefix(Dictionary* dict, const char* const* words, uint32_t count) {
+    if(count == 0 || !dict->key_index) return count;
+    uint32_t block = dictionary_key_index_locate(dict->key_index, words[count - 1]);
+    uint32_t end = count - 1;
+    while(end > 0 && dictionary_key_index_locate(dict->key_index, words[end - 1]) == block) {
+        end--;
+    }
+    return end > 0 ? end : count;
+}
+
+DictionaryStatus dictionary_random(
+    Dictionary* dict,
+    DictionaryRng* rng,
+    bool weighted,
+    char* word,
+    DictionaryOutput* out) {
+    DictionaryEntry entry = {.dict = dict};
+    DictionaryStatus status = dictionary_pick(dict, rng, weighted, &entry.record);
+    if(status != DictionaryStatusOk) return status;
+    strcpy(word, entry.record.key);
+    return dictionary_entry_write(&entry, out);
+}
+
+bool dictionary_has_weighted_random(const Dictionary* dict) {
+    return dict->info.is_v2 && dict->info.random_offset != 0;
+}
+
+const char* dictionary_status_get_text(DictionaryStatus status) {
+    switch(status) {
+    case DictionaryStatusOk:
+        return "";
+    case DictionaryStatusNotFound:
+        return "Word not found.";
+    case DictionaryStatusNoFiles:
+        return "Error: Dictionary files not found on SD card.";
+    case DictionaryStatusEmpty:
+        return "Error: Dictionary index is empty.";
+    case DictionaryStatusReadError:
+        return "Error: Failed to read definition data.";
+    case DictionaryStatusOutOfMemory:
+        return "Error: Out of memory while reading definition.";
+    case DictionaryStatusCancelled:
+        return "Stopped before the end.";
+    }
+    return "Error";
+}
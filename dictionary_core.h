@@ -0,0 +1,221 @@
+#pragma once
+
+#include "dictionary_blocks.h"
+#include "dictionary_format.h"
+#include "dictionary_gloss.h"
+#include "dictionary_hash.h"
+#include "dictionary_hot.h"
+#include "dictionary_inflect.h"
+#include "dictionary_layout.h"
+#include "dictionary_index.h"
+#include "dictionary_rng.h"
+
+// Portable lookup core: index and data access plus result formatting. It only
+// talks to the outside through DictionaryStorage and DictionaryOutput, so the
+// same code runs in the app and in the host benchmark (tools/host).
+//
+// A Dictionary is a session: it keeps engdict.idx and engdict.dat open between
+// lookups. engdict.dat may be plain text or block-compressed
+// (dictionary_blocks.h); the index is the same for both. Definitions are never
+// read as a whole: they are streamed through the formatter (dictionary_format.h)
+// a window at a time. When an operation on either file fails both are closed
+// and reopened on the next access; lookups retry once on the fresh handles.
+
+typedef enum {
+    DictionaryStatusOk,
+    DictionaryStatusNotFound,
+    DictionaryStatusNoFiles,
+    DictionaryStatusEmpty,
+    DictionaryStatusReadError,
+    DictionaryStatusOutOfMemory,
+    DictionaryStatusCancelled, // stopped by its caller before the end
+} DictionaryStatus;
+
+typedef struct Dictionary Dictionary;
+
+// `ram_budget` bounds the RAM key and hash indexes; 0 disables the key index
+// and leaves the hash displacements on SD. Exact lookups use whichever index
+// reads less for the word. Missing files are not an error: they are opened
+// (and the indexes loaded) on first use.
+Dictionary* dictionary_alloc(
+    DictionaryStorage* storage,
+    const char* idx_path,
+    const char* dat_path,
+    size_t ram_budget);
+
+void dictionary_free(Dictionary* dict);
+
+// NULL when the RAM key index is not loaded
+const DictionaryKeyIndex* dictionary_get_key_index(const Dictionary* dict);
+
+// NULL when the index has no HASH section
+const DictionaryHashIndex* dictionary_get_hash_index(const Dictionary* dict);
+
+// NULL when the index has no INFL section
+const DictionaryInflections* dictionary_get_inflections(const Dictionary* dict);
+
+// NULL unless engdict.dat is open and block-compressed
+const DictionaryBlocks* dictionary_get_blocks(const Dictionary* dict);
+
+// True while exact lookups try the hot word table (dictionary_hot.h) first:
+// it has entries and was built from the index on the card, or there is none
+bool dictionary_uses_hot_table(const Dictionary* dict);
+
+DictionaryStorage* dictionary_get_storage(Dictionary* dict);
+
+// --- Keys and hashes ---
+
+#define DICTIONARY_FNV1A_BASIS 0x811C9DC5
+
+// FNV-1a of `length` bytes, continuing from `basis`, as fnv1a() in
+// tools/dictc.py. The hashed sections of engdict.idx are built with it, so
+// the two must not drift apart.
+uint32_t dictionary_fnv1a(const void* data, size_t length, uint32_t basis);
+
+// Lowercases and trims `word` into `key` (MAX_WORD_LENGTH bytes); returns its
+// length, 0 if it is empty or too long to be a key
+size_t dictionary_key_normalize(const char* word, char* key);
+
+// --- Sorted key access ---
+// Records are numbered in key order. These need a v2 index and the idx handle
+// from dictionary_get_index_file(); with a legacy index the count is 0.
+
+// The session's idx handle, opened if needed; NULL if the file is missing.
+// It belongs to the dictionary and must not be closed.
+DictionaryFile* dictionary_get_index_file(Dictionary* dict);
+
+// Closes both files if an operation on them failed, so the next access
+// reopens them. Returns false in that case. Callers that read through
+// dictionary_get_index_file() call this when they are done.
+bool dictionary_check_files(Dictionary* dict);
+
+uint32_t dictionary_get_record_count(const Dictionary* dict);
+
+// Header of the index as read at alloc; is_v2 is false for legacy indexes
+const DictionaryIndexInfo* dictionary_get_index_info(const Dictionary* dict);
+
+// Identifies the index in use (a hash of its header), so data derived from it
+// and saved, such as the cache warm set, can be discarded after a rebuild.
+uint32_t dictionary_get_tag(const Dictionary* dict);
+
+bool dictionary_read_key(
+    Dictionary* dict,
+    DictionaryFile* idx_file,
+    uint32_t id,
+    DictionaryRecord* record);
+
+// See dictionary_index_lower_bound()
+uint32_t dictionary_lower_bound(
+    Dictionary* dict,
+    DictionaryFile* idx_file,
+    const char* prefix,
+    bool past_prefix,
+    uint32_t low,
+    uint32_t high);
+
+// --- Lookups ---
+
+// A found record; its definition is read on demand
+typedef struct {
+    Dictionary* dict;
+    DictionaryRecord record;
+    DictionaryLayout layout; // empty until dictionary_entry_load_layout()
+} DictionaryEntry;
+
+// Looks up the record of `word` without reading its definition, in the hot
+// word table first
+DictionaryStatus dictionary_find(Dictionary* dict, const char* word, DictionaryRecord* record);
+
+// Looks up the lemma of an inflected form that is not a headword ("mice",
+// "stopped"), for after dictionary_find() missed: one read of the INFL
+// section, then the lemma's record. DictionaryStatusNotFound when the form is
+// unknown or the index has no INFL section.
+DictionaryStatus
+    dictionary_find_lemma(Dictionary* dict, const char* form, DictionaryRecord* record);
+
+// Picks a record as dictionary_random() does, without reading its definition
+DictionaryStatus dictionary_pick(
+    Dictionary* dict,
+    DictionaryRng* rng,
+    bool weighted,
+    DictionaryRecord* record);
+
+// Copies up to `size` raw bytes of the definition of `record` from `pos`.
+// Returns the count, 0 past the end or if the read failed.
+size_t dictionary_read_definition(
+    Dictionary* dict,
+    const DictionaryRecord* record,
+    uint32_t pos,
+    char* buffer,
+    size_t size);
+
+// Where the body lines of `record` start on the result screen, from the LINE
+// section (dictionary_layout.h): one read of the index. False, leaving
+// `layout` empty, when there is no layout for the pager, for a hot record
+// (those read nothing from the card) or if the read failed.
+bool dictionary_get_layout(
+    Dictionary* dict,
+    const DictionaryRecord* record,
+    DictionaryLayout* layout);
+
+// Reads the formatter state body line `line` of `layout` starts at
+bool dictionary_read_layout_line(
+    Dictionary* dict,
+    const DictionaryLayout* layout,
+    uint32_t line,
+    DictionaryFormatState* state);
+
+// Reads the entries of all body lines of `layout` with one read, for
+// dictionary_layout_decode()
+bool dictionary_read_layout_lines(
+    Dictionary* dict,
+    const DictionaryLayout* layout,
+    void* entries);
+
+// A text source over the raw definition, with its body lines when the entry
+// has a layout; `entry` must outlive it
+void dictionary_entry_get_source(DictionaryEntry* entry, DictionaryTextSource* source);
+
+// Loads the layout of the entry's record (dictionary_get_layout()), so its
+// text source gives the pager its lines
+bool dictionary_entry_load_layout(DictionaryEntry* entry);
+
+// Streams the formatted entry into `out`: the headword, then the senses
+DictionaryStatus dictionary_entry_write(DictionaryEntry* entry, DictionaryOutput* out);
+
+DictionaryStatus dictionary_search(Dictionary* dict, const char* word, DictionaryOutput* out);
+
+// Picks a record uniformly, or with `weighted` set, in proportion to the
+// weights of the RAND section; the headword is copied to `word`. A v2 index
+// costs one idx read (none with the key block resident, one more when
+// weighted) and one engdict.dat read.
+DictionaryStatus dictionary_random(
+    Dictionary* dict,
+    DictionaryRng* rng,
+    bool weighted,
+    char* word,
+    DictionaryOutput* out);
+
+// Looks up `count` words sorted by strcasecmp(), calling `visit` with each
+// one's record (NULL on a miss) in order. With the RAM key index it is a
+// single merge pass over the key blocks: the words sharing a block are found
+// in one walk of it, and a block on SD is read at most once. A word alone in
+// its block, and every word without the key index, is a dictionary_find().
+// `visit` may read definitions. Stopping through `visit` is not an error.
+DictionaryStatus dictionary_join(
+    Dictionary* dict,
+    const char* const* words,
+    uint32_t count,
+    DictionaryJoinCallback visit,
+    void* context);
+
+// How many of `count` sorted words to pass to dictionary_join() when more
+// words follow them: all but the trailing ones sharing the last word's key
+// block, which belong with the words after them. All of them when they share
+// one block, or without the key index.
+uint32_t dictionary_join_prefix(Dictionary* dict, const char* const* words, uint32_t count);
+
+// True when the index carries the RAND section for weighted picks
+bool dictionary_has_weighted_random(const Dictionary* dict);
+
+const char* dictionary_status_get_text(DictionaryStatus status);
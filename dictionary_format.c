@@ -0,0 +1,181 @@
+#include "dictionary_format.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    DictionaryFormatPhasePlain, // messages: raw bytes as they are
+    DictionaryFormatPhaseWord,
+    DictionaryFormatPhasePhoneticSpace,
+    DictionaryFormatPhasePhonetic,
+    DictionaryFormatPhaseHeadlineEnd,
+    DictionaryFormatPhaseBody, // between senses
+    DictionaryFormatPhaseNumber, // "n. " before a sense
+    DictionaryFormatPhaseSense,
+    DictionaryFormatPhaseEnd,
+} DictionaryFormatPhase;
+
+static size_t dictionary_text_source_read_memory(
+    void* context,
+    uint32_t pos,
+    char* buffer,
+    size_t size) {
+    memcpy(buffer, (const char*)context + pos, size);
+    return size;
+}
+
+void dictionary_text_source_init_memory(
+    DictionaryTextSource* source,
+    const char* text,
+    size_t length) {
+    source->read = dictionary_text_source_read_memory;
+    source->read_line = NULL;
+    source->context = (void*)text;
+    source->length = length;
+    source->lines = 0;
+}
+
+// Raw byte at `pos` (< length) through the window, -1 if the read failed
+static int dictionary_formatter_raw(DictionaryFormatter* formatter, uint32_t pos) {
+    if(pos < formatter->window_pos || pos >= formatter->window_pos + formatter->window_length) {
+        uint32_t left = formatter->source.length - pos;
+        size_t size = left < sizeof(formatter->window) ? left : sizeof(formatter->window);
+        formatter->window_pos = pos;
+        formatter->window_length =
+            formatter->source.read(formatter->source.context, pos, formatter->window, size);
+        if(formatter->window_length == 0) {
+            formatter->failed = true;
+            return -1;
+        }
+    }
+    return (unsigned char)formatter->window[pos - formatter->window_pos];
+}
+
+void dictionary_formatter_init(
+    DictionaryFormatter* formatter,
+    const DictionaryTextSource* source,
+    const char* word) {
+    memset(formatter, 0, sizeof(DictionaryFormatter));
+    formatter->source = *source;
+    if(!word) {
+        formatter->state.phase = DictionaryFormatPhasePlain;
+        return;
+    }
+    strncpy(formatter->word, word, DICTIONARY_HEADLINE_LENGTH - 1);
+    formatter->state.phase = DictionaryFormatPhaseWord;
+
+    // A leading "[...]" is the phonetic if it closes within the first window
+    if(source->length > 0 && dictionary_formatter_raw(formatter, 0) == '[') {
+        const char* closing = memchr(formatter->window, ']', formatter->window_length);
+        if(closing) formatter->phonetic_end = closing - formatter->window;
+    }
+}
+
+int dictionary_formatter_next(DictionaryFormatter* formatter) {
+    DictionaryFormatState* state = &formatter->state;
+    uint32_t length = formatter->source.length;
+    for(;;) {
+        switch(state->phase) {
+        case DictionaryFormatPhasePlain:
+            if(state->pos >= length) return -1;
+            return dictionary_formatter_raw(formatter, state->pos++);
+
+        case DictionaryFormatPhaseWord:
+            if(formatter->word[state->index]) return formatter->word[state->index++];
+            state->phase = formatter->phonetic_end ? DictionaryFormatPhasePhoneticSpace :
+                                                     DictionaryFormatPhaseHeadlineEnd;
+            break;
+
+        case DictionaryFormatPhasePhoneticSpace:
+            state->phase = DictionaryFormatPhasePhonetic;
+            return ' ';
+
+        case DictionaryFormatPhasePhonetic:
+            if(state->pos > formatter->phonetic_end) {
+                state->phase = DictionaryFormatPhaseHeadlineEnd;
+                break;
+            }
+            return dictionary_formatter_raw(formatter, state->pos++);
+
+        case DictionaryFormatPhaseHeadlineEnd:
+            state->phase = DictionaryFormatPhaseBody;
+            return '\n';
+
+        case DictionaryFormatPhaseNumber: {
+            char number[8];
+            int size = snprintf(number, sizeof(number), "%u. ", state->senses);
+            if(state->index < size) return number[state->index++];
+            state->phase = DictionaryFormatPhaseSense;
+        } break;
+
+        case DictionaryFormatPhaseBody:
+        case DictionaryFormatPhaseSense: {
+            bool in_sense = state->phase == DictionaryFormatPhaseSense;
+            int c = state->pos < length ? dictionary_formatter_raw(formatter, state->pos) : ';';
+            if(c < 0) return -1;
+            if(c == ';') {
+                // Senses are split on ";" with surrounding whitespace dropped
+                if(state->pos >= length) state->phase = DictionaryFormatPhaseEnd;
+                state->pos++;
+                state->pending_spaces = 0;
+                if(in_sense) {
+                    if(state->phase != DictionaryFormatPhaseEnd) {
+                        state->phase = DictionaryFormatPhaseBody;
+                    }
+                    return '\n';
+                }
+            } else if(isspace(c)) {
+                state->pos++;
+                if(in_sense && state->pending_spaces < UINT8_MAX) state->pending_spaces++;
+            } else if(!in_sense) {
+                state->senses++;
+                state->index = 0;
+                state->phase = DictionaryFormatPhaseNumber;
+            } else if(state->pending_spaces > 0) {
+                state->pending_spaces--;
+                return ' ';
+            } else {
+                state->pos++;
+                return c;
+            }
+        } break;
+
+        case DictionaryFormatPhaseEnd:
+        default:
+            return -1;
+        }
+    }
+}
+
+void dictionary_format_state_init_body(
+    DictionaryFormatState* state,
+    uint32_t pos,
+    uint16_t senses,
+    bool in_sense,
+    uint8_t pending_spaces) {
+    memset(state, 0, sizeof(DictionaryFormatState));
+    state->pos = pos;
+    state->senses = senses;
+    state->phase = in_sense ? DictionaryFormatPhaseSense : DictionaryFormatPhaseBody;
+    state->pending_spaces = pending_spaces;
+}
+
+bool dictionary_format_state_in_body(const DictionaryFormatState* state) {
+    return state->phase >= DictionaryFormatPhaseBody;
+}
+
+bool dictionary_formatter_write_all(DictionaryFormatter* formatter, DictionaryOutput* out) {
+    char buffer[32];
+    size_t size = 0;
+    int c;
+    while((c = dictionary_formatter_next(formatter)) >= 0) {
+        buffer[size++] = c;
+        if(size == sizeof(buffer)) {
+            out->write(out->context, buffer, size);
+            size = 0;
+        }
+    }
+    if(size > 0) out->write(out->context, buffer, size);
+    return !formatter->failed;
+}
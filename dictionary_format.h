@@ -0,0 +1,88 @@
+#pragma once
+
+#include "dictionary_index.h"
+
+// Streaming result formatter. An entry "[phonetic] def; def; ..." becomes
+//
+//   word [phonetic]
+//   1. def
+//   2. def
+//
+// one output byte at a time, reading the raw text through a small window, so
+// a definition is never held in RAM as a whole. The state between bytes is a
+// few bytes and can be saved and restored, which lets the pager step back.
+
+// Raw bytes read from the source at a time; also how far a leading
+// "[phonetic]" is looked for
+#define DICTIONARY_FORMAT_WINDOW 128
+
+// Longest heading: an inflected form shows as "form -> lemma"
+#define DICTIONARY_HEADLINE_LENGTH (2 * MAX_WORD_LENGTH + 4)
+
+// Receives formatted result text in pieces
+typedef struct {
+    void (*write)(void* context, const char* text, size_t length);
+    void* context;
+} DictionaryOutput;
+
+typedef struct {
+    uint32_t pos; // next raw byte
+    uint16_t senses; // numbered so far
+    uint8_t phase;
+    uint8_t index; // within the headword or the sense number
+    uint8_t pending_spaces; // held back until the sense goes on
+} DictionaryFormatState;
+
+// Random-access raw text
+typedef struct {
+    // Copies up to `size` bytes at `pos` (< length); returns the count, 0 on failure
+    size_t (*read)(void* context, uint32_t pos, char* buffer, size_t size);
+    // Optional: the state where line `line` (< lines) of the body starts, as
+    // laid out ahead for the pager (dictionary_layout.h); false on failure
+    bool (*read_line)(void* context, uint32_t line, DictionaryFormatState* state);
+    void* context;
+    uint32_t length;
+    uint32_t lines; // of the body, when read_line is set
+} DictionaryTextSource;
+
+// A source over text in RAM; `text` must outlive it
+void dictionary_text_source_init_memory(
+    DictionaryTextSource* source,
+    const char* text,
+    size_t length);
+
+typedef struct {
+    DictionaryTextSource source;
+    char word[DICTIONARY_HEADLINE_LENGTH];
+    uint32_t phonetic_end; // position of the "]" closing the phonetic, 0 if none
+    DictionaryFormatState state;
+    char window[DICTIONARY_FORMAT_WINDOW];
+    uint32_t window_pos;
+    uint16_t window_length;
+    bool failed;
+} DictionaryFormatter;
+
+// Formats `source` as the entry for `word`, or passes it through unchanged
+// when `word` is NULL (messages).
+void dictionary_formatter_init(
+    DictionaryFormatter* formatter,
+    const DictionaryTextSource* source,
+    const char* word);
+
+// Next output byte, or -1 at the end or when the source failed
+int dictionary_formatter_next(DictionaryFormatter* formatter);
+
+// The state of an entry's body at raw position `pos`, `senses` numbered:
+// between senses, or within the last with `pending_spaces` held back
+void dictionary_format_state_init_body(
+    DictionaryFormatState* state,
+    uint32_t pos,
+    uint16_t senses,
+    bool in_sense,
+    uint8_t pending_spaces);
+
+// Whether `state` is past the headline of an entry
+bool dictionary_format_state_in_body(const DictionaryFormatState* state);
+
+// Writes the rest of the output in pieces; false if the source failed
+bool dictionary_formatter_write_all(DictionaryFormatter* formatter, DictionaryOutput* out);
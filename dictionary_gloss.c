@@ -0,0 +1,125 @@
+#include "dictionary_gloss.h"
+
+#include <string.h>
+
+#define DICTIONARY_GLOSS_HEAD_SIZE 16
+
+static const char dictionary_gloss_separator[] = "; ";
+#define DICTIONARY_GLOSS_SEPARATOR_LENGTH (sizeof(dictionary_gloss_separator) - 1)
+
+void dictionary_gloss_list_reset(DictionaryGlossList* list) {
+    list->id = UINT32_MAX;
+    list->length = 0;
+    list->count = 0;
+    list->prefix = false;
+}
+
+// Whether "; " comes before range `i`
+static bool dictionary_gloss_is_separated(const DictionaryGlossList* list, uint8_t i) {
+    return i > 1 || (i == 1 && !list->prefix);
+}
+
+// Decodes the varint at `*pos`; false if it runs past `size`
+static bool
+    dictionary_gloss_read_varint(const uint8_t* data, size_t size, size_t* pos, uint32_t* value) {
+    *value = 0;
+    for(uint8_t shift = 0; *pos < size && shift < 32; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if(byte < 0x80) return true;
+    }
+    return false;
+}
+
+bool dictionary_gloss_list_load(
+    DictionaryGlossList* list,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t id) {
+    if(list->id == id) return true;
+    dictionary_gloss_list_reset(list);
+    if(info->glosses_offset == 0 || id >= info->record_count) return false;
+
+    uint8_t data[DICTIONARY_GLOSS_LIST_SIZE];
+    uint32_t slots = info->glosses_offset + DICTIONARY_GLOSS_HEAD_SIZE;
+    if(!dictionary_storage_read_at(
+           storage,
+           idx_file,
+           slots + id * DICTIONARY_GLOSS_SLOT_SIZE,
+           data,
+           DICTIONARY_GLOSS_SLOT_SIZE)) {
+        return false;
+    }
+    size_t size = DICTIONARY_GLOSS_SLOT_SIZE;
+    if(data[0] == 0) {
+        // Only a list with no ranges would start with a zero byte
+        uint16_t overflow_size;
+        uint32_t overflow_offset;
+        memcpy(&overflow_size, data + 2, sizeof(overflow_size));
+        memcpy(&overflow_offset, data + 4, sizeof(overflow_offset));
+        overflow_offset += slots + info->record_count * DICTIONARY_GLOSS_SLOT_SIZE;
+        size = overflow_size;
+        if(size > sizeof(data) ||
+           !dictionary_storage_read_at(storage, idx_file, overflow_offset, data, size)) {
+            return false;
+        }
+    }
+
+    size_t pos = 0;
+    uint32_t head;
+    if(!dictionary_gloss_read_varint(data, size, &pos, &head) || (head >> 1) == 0 ||
+       (head >> 1) > DICTIONARY_GLOSS_MAX_RANGES) {
+        return false;
+    }
+    list->count = head >> 1;
+    list->prefix = head & 1;
+    uint32_t length = 0;
+    for(uint8_t i = 0; i < list->count; i++) {
+        DictionaryGlossRange* range = &list->ranges[i];
+        if(!dictionary_gloss_read_varint(data, size, &pos, &range->offset) ||
+           !dictionary_gloss_read_varint(data, size, &pos, &range->length)) {
+            dictionary_gloss_list_reset(list);
+            return false;
+        }
+        if(dictionary_gloss_is_separated(list, i)) length += DICTIONARY_GLOSS_SEPARATOR_LENGTH;
+        length += range->length;
+    }
+    list->length = length;
+    list->id = id;
+    return true;
+}
+
+bool dictionary_gloss_list_read(
+    const DictionaryGlossList* list,
+    uint32_t pos,
+    char* buffer,
+    size_t size,
+    DictionaryGlossReadCallback read,
+    void* context) {
+    // `start` walks the text a piece at a time; `pos` never falls behind it
+    uint32_t start = 0;
+    for(uint8_t i = 0; i < list->count && size > 0; i++) {
+        if(dictionary_gloss_is_separated(list, i)) {
+            for(size_t j = 0; j < DICTIONARY_GLOSS_SEPARATOR_LENGTH && size > 0; j++, start++) {
+                if(start < pos) continue;
+                *buffer++ = dictionary_gloss_separator[j];
+                size--;
+                pos++;
+            }
+        }
+
+        const DictionaryGlossRange* range = &list->ranges[i];
+        if(size > 0 && pos < start + range->length) {
+            uint32_t skip = pos - start;
+            size_t chunk = range->length - skip;
+            if(chunk > size) chunk = size;
+            if(!read(context, range->offset + skip, buffer, chunk)) return false;
+            buffer += chunk;
+            size -= chunk;
+            pos += chunk;
+        }
+        start += range->length;
+    }
+    return size == 0;
+}
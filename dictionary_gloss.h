@@ -0,0 +1,69 @@
+#pragma once
+
+#include "dictionary_index.h"
+
+// Definitions that store each gloss once, through the GLOS section of
+// engdict.idx. A definition is "[phones] gloss; gloss; ..." and a WordNet
+// synset's gloss recurs in the entry of every word in it, so tools/dictc.py
+// writes a gloss to engdict.dat only where it first appears. A record's gloss
+// list names the ranges of engdict.dat its definition is made of, joined by
+// "; " except after the pronunciation; glosses written together are one
+// range. Records keep the offsets and lengths of the plain text, so a
+// position in a definition means the same with or without the section.
+//
+// A list is varint(range count << 1 | prefix), then a varint offset and
+// length per range. The section holds u32 record count, distinct glosses,
+// overflow bytes and most ranges per list, then an 8-byte slot per record id,
+// then the overflow area. A list that fits is kept in its slot, so most
+// definitions cost one read of the index; the slot of a longer one is two
+// zero bytes, the u16 size of the list and its u32 offset in the overflow.
+
+// Most ranges in a list; the builder stores the rest of a longer definition
+// again as one
+#define DICTIONARY_GLOSS_MAX_RANGES 16
+#define DICTIONARY_GLOSS_SLOT_SIZE  8
+// Longest list: the head plus two 5-byte varints per range
+#define DICTIONARY_GLOSS_LIST_SIZE (1 + DICTIONARY_GLOSS_MAX_RANGES * 10)
+
+typedef struct {
+    uint32_t offset; // in engdict.dat
+    uint32_t length;
+} DictionaryGlossRange;
+
+// The ranges of one definition, kept while its windows are read
+typedef struct {
+    uint32_t id; // record the list is of, UINT32_MAX if none
+    uint32_t length; // of the text, separators included
+    uint8_t count;
+    bool prefix; // no separator after the first range (the pronunciation)
+    DictionaryGlossRange ranges[DICTIONARY_GLOSS_MAX_RANGES];
+} DictionaryGlossList;
+
+// Reads `size` bytes of engdict.dat from `offset`
+typedef bool (*DictionaryGlossReadCallback)(
+    void* context,
+    uint32_t offset,
+    char* buffer,
+    size_t size);
+
+void dictionary_gloss_list_reset(DictionaryGlossList* list);
+
+// Reads the list of record `id` unless `list` holds it already. False on a
+// read error or a damaged list, which leaves `list` empty.
+bool dictionary_gloss_list_load(
+    DictionaryGlossList* list,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t id);
+
+// Fills `buffer` with `size` bytes of the definition from `pos`, reading each
+// range it spans through `read` and writing the separators between them.
+// The caller keeps `pos + size` within the list's length.
+bool dictionary_gloss_list_read(
+    const DictionaryGlossList* list,
+    uint32_t pos,
+    char* buffer,
+    size_t size,
+    DictionaryGlossReadCallback read,
+    void* context);
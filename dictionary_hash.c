@@ -0,0 +1,131 @@
+#include "dictionary_hash.h"
+
+#include "dictionary_core.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DICTIONARY_HASH_HEAD_SIZE 16
+#define DICTIONARY_HASH_EMPTY     UINT32_MAX
+
+struct DictionaryHashIndex {
+    uint32_t bucket_count;
+    uint32_t slot_count;
+    uint32_t seed;
+    uint32_t slot_stride;
+    uint32_t displacements_offset;
+    uint32_t slots_offset;
+    uint16_t* displacements; // NULL when read from SD per lookup
+};
+
+DictionaryHashIndex* dictionary_hash_index_load(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    size_t budget) {
+    uint8_t head[DICTIONARY_HASH_HEAD_SIZE];
+    if(info->hash_offset == 0 ||
+       !dictionary_storage_read_at(storage, idx_file, info->hash_offset, head, sizeof(head))) {
+        return NULL;
+    }
+
+    DictionaryHashIndex* index = malloc(sizeof(DictionaryHashIndex));
+    memset(index, 0, sizeof(DictionaryHashIndex));
+    memcpy(&index->bucket_count, head, sizeof(uint32_t));
+    memcpy(&index->slot_count, head + 4, sizeof(uint32_t));
+    memcpy(&index->seed, head + 8, sizeof(uint32_t));
+    memcpy(&index->slot_stride, head + 12, sizeof(uint32_t));
+    if(index->bucket_count == 0 || index->slot_count < info->record_count ||
+       index->slot_stride < sizeof(uint32_t) + info->record_head + info->key_width) {
+        free(index);
+        return NULL;
+    }
+
+    // Displacements are u16, padded to 4 bytes
+    size_t size = index->bucket_count * sizeof(uint16_t);
+    index->displacements_offset = info->hash_offset + sizeof(head);
+    index->slots_offset = index->displacements_offset + ((size + 3) & ~(size_t)3);
+
+    if(sizeof(DictionaryHashIndex) + size <= budget) {
+        index->displacements = malloc(size);
+        if(index->displacements &&
+           dictionary_storage_read(storage, idx_file, index->displacements, size) != size) {
+            free(index->displacements);
+            index->displacements = NULL;
+        }
+    }
+    return index;
+}
+
+void dictionary_hash_index_free(DictionaryHashIndex* index) {
+    if(!index) return;
+    free(index->displacements);
+    free(index);
+}
+
+size_t dictionary_hash_index_get_size(const DictionaryHashIndex* index) {
+    return sizeof(DictionaryHashIndex) +
+           (index->displacements ? index->bucket_count * sizeof(uint16_t) : 0);
+}
+
+bool dictionary_hash_index_is_resident(const DictionaryHashIndex* index) {
+    return index->displacements != NULL;
+}
+
+// MurmurHash3's finalizer
+static uint32_t dictionary_hash_mix(uint32_t hash) {
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35;
+    return hash ^ (hash >> 16);
+}
+
+bool dictionary_hash_index_find(
+    DictionaryHashIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* word,
+    DictionaryRecord* record) {
+    // FNV-1a of the lowercase key from two bases, as hash_slot() in
+    // tools/dictc.py
+    uint32_t bucket_hash = DICTIONARY_FNV1A_BASIS, slot_hash = index->seed;
+    for(const char* c = word; *c; c++) {
+        uint8_t byte = (uint8_t)tolower((unsigned char)*c);
+        bucket_hash = dictionary_fnv1a(&byte, 1, bucket_hash);
+        slot_hash = dictionary_fnv1a(&byte, 1, slot_hash);
+    }
+
+    uint32_t bucket = bucket_hash % index->bucket_count;
+    uint16_t displacement;
+    if(index->displacements) {
+        displacement = index->displacements[bucket];
+    } else if(!dictionary_storage_read_at(
+                  storage,
+                  idx_file,
+                  index->displacements_offset + bucket * sizeof(uint16_t),
+                  &displacement,
+                  sizeof(displacement))) {
+        return false;
+    }
+    uint32_t slot = dictionary_hash_mix(slot_hash ^ (displacement * 0x9E3779B9)) %
+                    index->slot_count;
+
+    // A word that is not a key lands on some other key's slot, or an empty one
+    uint8_t raw[sizeof(uint32_t) + DICTIONARY_IDX_RECORD_HEAD_WIDE + MAX_WORD_LENGTH];
+    uint32_t id;
+    if(!dictionary_storage_read_at(
+           storage,
+           idx_file,
+           index->slots_offset + slot * index->slot_stride,
+           raw,
+           sizeof(uint32_t) + info->record_head + info->key_width)) {
+        return false;
+    }
+    memcpy(&id, raw, sizeof(id));
+    return id != DICTIONARY_HASH_EMPTY && id < info->record_count &&
+           dictionary_index_decode_record(info, raw + sizeof(uint32_t), id, record) &&
+           strcasecmp(word, record->key) == 0;
+}
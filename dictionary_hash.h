@@ -0,0 +1,38 @@
+#pragma once
+
+#include "dictionary_index.h"
+
+// Exact lookups through the HASH section of engdict.idx: a perfect hash of
+// the keys built offline, CHD style. A key's hash picks a bucket of about
+// five keys; the bucket's u16 displacement then moves the key to its own
+// slot. A slot is the record id followed by a copy of the record, so a lookup
+// reads one slot and compares the key, without a bisection. With the
+// displacements in RAM that is the only idx read; otherwise reading the
+// displacement costs one more. The sorted index stays for prefix and range
+// queries.
+
+typedef struct DictionaryHashIndex DictionaryHashIndex;
+
+// Loads the section header, and the displacements if they fit in `budget`
+// bytes. Returns NULL if the section is missing or damaged.
+DictionaryHashIndex* dictionary_hash_index_load(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    size_t budget);
+
+void dictionary_hash_index_free(DictionaryHashIndex* index);
+
+// Bytes of RAM the index holds
+size_t dictionary_hash_index_get_size(const DictionaryHashIndex* index);
+
+// True when the displacements are in RAM
+bool dictionary_hash_index_is_resident(const DictionaryHashIndex* index);
+
+bool dictionary_hash_index_find(
+    DictionaryHashIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* word,
+    DictionaryRecord* record);
@@ -0,0 +1,410 @@
+#include "dictionary_history.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Journal: "EDHJ", u16 version, u16 reserved, then records
+// [u8 word length][word][u32 time][u16 hits] adding `hits` to the word and
+// setting its time. Appended records carry one hit; a compacted journal has
+// one record per word with its total, from least to most recently used.
+#define DICTIONARY_HISTORY_HEAD_SIZE 8
+#define DICTIONARY_HISTORY_CHUNK     128
+// Superseded records tolerated before compacting, on top of one per word
+#define DICTIONARY_HISTORY_SLACK 32
+
+#define DICTIONARY_HISTORY_NONE UINT16_MAX
+
+// Words are stored in an arena as [u16 entry][u8 length][chars] in the order
+// they were added. Removing a word leaves a hole; when the arena is full it
+// is compacted in place, which the entry number in front of each word makes
+// possible without any other bookkeeping.
+#define DICTIONARY_HISTORY_WORD_HEAD 3
+
+typedef struct {
+    uint32_t time;
+    uint16_t hits; // 0 for a free slot
+    uint16_t hash; // low bits of the word hash, checked before the word
+    uint16_t next; // in the hash bucket, or in the free list
+    uint16_t newer;
+    uint16_t older;
+    uint16_t word; // arena offset
+} DictionaryHistoryEntry;
+
+struct DictionaryHistory {
+    DictionaryHistoryEntry* entries;
+    uint16_t capacity;
+    uint16_t free; // first free slot
+    uint16_t newest;
+    uint16_t oldest;
+    uint16_t* buckets;
+    uint16_t bucket_mask;
+
+    uint8_t* arena;
+    uint16_t arena_size;
+    uint16_t arena_used; // up to the end of the last word
+    uint16_t arena_live; // bytes of words still in use
+
+    uint8_t pending[DICTIONARY_HISTORY_PENDING_SIZE];
+    uint16_t pending_length;
+    uint16_t pending_records;
+    bool stale; // the journal does not match RAM plus the queue
+    bool journaled; // the card holds a journal with a valid header to append to
+
+    DictionaryHistoryStats stats;
+};
+
+static uint32_t dictionary_history_hash(const char* key, size_t length) {
+    return dictionary_fnv1a(key, length, DICTIONARY_FNV1A_BASIS);
+}
+
+static uint8_t* dictionary_history_word(const DictionaryHistory* history, uint16_t index) {
+    return history->arena + history->entries[index].word;
+}
+
+DictionaryHistory* dictionary_history_alloc(uint16_t capacity, size_t word_bytes) {
+    DictionaryHistory* history = malloc(sizeof(DictionaryHistory));
+    memset(history, 0, sizeof(DictionaryHistory));
+    if(capacity == 0 || capacity == DICTIONARY_HISTORY_NONE) capacity = 1;
+    if(word_bytes > UINT16_MAX) word_bytes = UINT16_MAX;
+
+    uint32_t bucket_count = 1;
+    while(bucket_count < capacity)
+        bucket_count *= 2;
+    history->capacity = capacity;
+    history->bucket_mask = bucket_count - 1;
+    history->arena_size = word_bytes;
+    history->entries = malloc(capacity * sizeof(DictionaryHistoryEntry));
+    history->buckets = malloc(bucket_count * sizeof(uint16_t));
+    history->arena = malloc(word_bytes);
+    memset(history->entries, 0, capacity * sizeof(DictionaryHistoryEntry));
+    memset(history->buckets, 0xFF, bucket_count * sizeof(uint16_t));
+    for(uint16_t i = 0; i < capacity; i++) {
+        history->entries[i].next = i + 1 < capacity ? i + 1 : DICTIONARY_HISTORY_NONE;
+    }
+    history->newest = history->oldest = DICTIONARY_HISTORY_NONE;
+    // An empty history matches a missing journal; the first lookup without
+    // a journal to append to marks it stale
+    history->stale = false;
+    history->journaled = false;
+    history->stats.ram = sizeof(DictionaryHistory) +
+                         capacity * sizeof(DictionaryHistoryEntry) +
+                         bucket_count * sizeof(uint16_t) + word_bytes;
+    return history;
+}
+
+void dictionary_history_free(DictionaryHistory* history) {
+    if(!history) return;
+    free(history->arena);
+    free(history->buckets);
+    free(history->entries);
+    free(history);
+}
+
+const DictionaryHistoryStats* dictionary_history_get_stats(const DictionaryHistory* history) {
+    return &history->stats;
+}
+
+static uint16_t dictionary_history_find(
+    const DictionaryHistory* history,
+    const char* key,
+    size_t length,
+    uint32_t hash) {
+    uint16_t index = history->buckets[hash & history->bucket_mask];
+    while(index != DICTIONARY_HISTORY_NONE) {
+        const DictionaryHistoryEntry* entry = &history->entries[index];
+        const uint8_t* word = dictionary_history_word(history, index);
+        if(entry->hash == (uint16_t)hash && word[2] == length &&
+           memcmp(word + DICTIONARY_HISTORY_WORD_HEAD, key, length) == 0) {
+            return index;
+        }
+        index = entry->next;
+    }
+    return DICTIONARY_HISTORY_NONE;
+}
+
+static void dictionary_history_unlink(DictionaryHistory* history, uint16_t index) {
+    DictionaryHistoryEntry* entry = &history->entries[index];
+    if(entry->newer != DICTIONARY_HISTORY_NONE) {
+        history->entries[entry->newer].older = entry->older;
+    } else {
+        history->newest = entry->older;
+    }
+    if(entry->older != DICTIONARY_HISTORY_NONE) {
+        history->entries[entry->older].newer = entry->newer;
+    } else {
+        history->oldest = entry->newer;
+    }
+}
+
+static void dictionary_history_push_newest(DictionaryHistory* history, uint16_t index) {
+    DictionaryHistoryEntry* entry = &history->entries[index];
+    entry->newer = DICTIONARY_HISTORY_NONE;
+    entry->older = history->newest;
+    if(history->newest != DICTIONARY_HISTORY_NONE) {
+        history->entries[history->newest].newer = index;
+    } else {
+        history->oldest = index;
+    }
+    history->newest = index;
+}
+
+// Drops the least recently used word
+static void dictionary_history_evict(DictionaryHistory* history) {
+    uint16_t index = history->oldest;
+    DictionaryHistoryEntry* entry = &history->entries[index];
+    const uint8_t* word = dictionary_history_word(history, index);
+    uint32_t hash =
+        dictionary_history_hash((const char*)word + DICTIONARY_HISTORY_WORD_HEAD, word[2]);
+
+    uint16_t* link = &history->buckets[hash & history->bucket_mask];
+    while(*link != index)
+        link = &history->entries[*link].next;
+    *link = entry->next;
+    dictionary_history_unlink(history, index);
+
+    history->arena_live -= DICTIONARY_HISTORY_WORD_HEAD + word[2];
+    entry->hits = 0;
+    entry->next = history->free;
+    history->free = index;
+    history->stats.entries--;
+    history->stats.evictions++;
+}
+
+// Slides the words still in use to the front of the arena
+static void dictionary_history_compact_arena(DictionaryHistory* history) {
+    uint16_t from = 0, to = 0;
+    while(from < history->arena_used) {
+        uint8_t* chunk = history->arena + from;
+        uint16_t index;
+        memcpy(&index, chunk, sizeof(index));
+        uint16_t size = DICTIONARY_HISTORY_WORD_HEAD + chunk[2];
+        DictionaryHistoryEntry* entry = &history->entries[index];
+        if(entry->hits > 0 && entry->word == from) {
+            memmove(history->arena + to, chunk, size);
+            entry->word = to;
+            to += size;
+        }
+        from += size;
+    }
+    history->arena_used = to;
+}
+
+// Adds `hits` lookups of `key` at `time`; false if the word cannot be stored
+static bool dictionary_history_apply(
+    DictionaryHistory* history,
+    const char* key,
+    size_t length,
+    uint32_t time,
+    uint16_t hits) {
+    uint32_t hash = dictionary_history_hash(key, length);
+    uint16_t index = dictionary_history_find(history, key, length, hash);
+    if(index != DICTIONARY_HISTORY_NONE) {
+        DictionaryHistoryEntry* entry = &history->entries[index];
+        entry->hits = entry->hits > UINT16_MAX - hits ? UINT16_MAX : entry->hits + hits;
+        entry->time = time;
+        dictionary_history_unlink(history, index);
+        dictionary_history_push_newest(history, index);
+        return true;
+    }
+
+    uint16_t size = DICTIONARY_HISTORY_WORD_HEAD + length;
+    if(size > history->arena_size) return false;
+    if(history->free == DICTIONARY_HISTORY_NONE) dictionary_history_evict(history);
+    while(history->arena_live + size > history->arena_size)
+        dictionary_history_evict(history);
+    if(history->arena_used + size > history->arena_size) {
+        dictionary_history_compact_arena(history);
+    }
+
+    index = history->free;
+    DictionaryHistoryEntry* entry = &history->entries[index];
+    history->free = entry->next;
+    entry->time = time;
+    entry->hits = hits > 0 ? hits : 1;
+    entry->hash = hash;
+    entry->word = history->arena_used;
+    uint8_t* word = history->arena + history->arena_used;
+    memcpy(word, &index, sizeof(index));
+    word[2] = length;
+    memcpy(word + DICTIONARY_HISTORY_WORD_HEAD, key, length);
+    history->arena_used += size;
+    history->arena_live += size;
+
+    uint16_t* bucket = &history->buckets[hash & history->bucket_mask];
+    entry->next = *bucket;
+    *bucket = index;
+    dictionary_history_push_newest(history, index);
+    history->stats.entries++;
+    return true;
+}
+
+static size_t dictionary_history_encode(
+    uint8_t* record,
+    const char* key,
+    size_t length,
+    uint32_t time,
+    uint16_t hits) {
+    record[0] = length;
+    memcpy(record + 1, key, length);
+    memcpy(record + 1 + length, &time, sizeof(time));
+    memcpy(record + 1 + length + sizeof(time), &hits, sizeof(hits));
+    return 1 + length + sizeof(time) + sizeof(hits);
+}
+
+void dictionary_history_add(DictionaryHistory* history, const char* word, uint32_t time) {
+    char key[MAX_WORD_LENGTH];
+    size_t length = dictionary_key_normalize(word, key);
+    if(!length || !dictionary_history_apply(history, key, length, time, 1)) return;
+    if(!history->journaled) history->stale = true;
+
+    uint8_t record[1 + MAX_WORD_LENGTH + sizeof(uint32_t) + sizeof(uint16_t)];
+    size_t size = dictionary_history_encode(record, key, length, time, 1);
+    if(history->pending_length + size > sizeof(history->pending)) {
+        // The next write rewrites the journal from RAM, which has this lookup
+        history->stale = true;
+        history->pending_length = history->pending_records = 0;
+        return;
+    }
+    memcpy(history->pending + history->pending_length, record, size);
+    history->pending_length += size;
+    history->pending_records++;
+}
+
+uint16_t dictionary_history_get_recent(
+    const DictionaryHistory* history,
+    DictionaryHistoryItem* items,
+    uint16_t max) {
+    uint16_t count = 0;
+    for(uint16_t index = history->newest; index != DICTIONARY_HISTORY_NONE && count < max;
+        index = history->entries[index].older, count++) {
+        const DictionaryHistoryEntry* entry = &history->entries[index];
+        const uint8_t* word = dictionary_history_word(history, index);
+        memcpy(items[count].word, word + DICTIONARY_HISTORY_WORD_HEAD, word[2]);
+        items[count].word[word[2]] = '\0';
+        items[count].time = entry->time;
+        items[count].hits = entry->hits;
+    }
+    return count;
+}
+
+// --- Journal ---
+
+typedef struct {
+    DictionaryStorage* storage;
+    DictionaryFile* file;
+    uint8_t chunk[DICTIONARY_HISTORY_CHUNK];
+    uint8_t pos;
+    uint8_t length;
+} DictionaryHistoryReader;
+
+// Copies the next `size` bytes of the journal, read a chunk at a time
+static bool dictionary_history_read(DictionaryHistoryReader* reader, void* buffer, size_t size) {
+    uint8_t* out = buffer;
+    while(size > 0) {
+        if(reader->pos == reader->length) {
+            reader->length = dictionary_storage_read(
+                reader->storage, reader->file, reader->chunk, sizeof(reader->chunk));
+            reader->pos = 0;
+            if(reader->length == 0) return false;
+        }
+        size_t count = reader->length - reader->pos;
+        if(count > size) count = size;
+        memcpy(out, reader->chunk + reader->pos, count);
+        reader->pos += count;
+        out += count;
+        size -= count;
+    }
+    return true;
+}
+
+bool dictionary_history_load(
+    DictionaryHistory* history,
+    DictionaryStorage* storage,
+    DictionaryFile* file) {
+    uint8_t head[DICTIONARY_HISTORY_HEAD_SIZE];
+    uint16_t version;
+    if(!dictionary_storage_read_at(storage, file, 0, head, sizeof(head)) ||
+       memcmp(head, DICTIONARY_HISTORY_MAGIC, 4) != 0) {
+        history->stale = true;
+        return false;
+    }
+    memcpy(&version, head + 4, sizeof(version));
+    if(version != DICTIONARY_HISTORY_VERSION) {
+        history->stale = true;
+        return false;
+    }
+    history->journaled = true;
+
+    // Records are read sequentially after the header; a record cut short by
+    // a failed append ends the journal
+    DictionaryHistoryReader reader = {.storage = storage, .file = file};
+    uint32_t records = 0;
+    bool damaged = false;
+    uint8_t length;
+    while(dictionary_history_read(&reader, &length, 1)) {
+        char key[MAX_WORD_LENGTH];
+        uint32_t time;
+        uint16_t hits;
+        if(length == 0 || length >= MAX_WORD_LENGTH ||
+           !dictionary_history_read(&reader, key, length) ||
+           !dictionary_history_read(&reader, &time, sizeof(time)) ||
+           !dictionary_history_read(&reader, &hits, sizeof(hits))) {
+            damaged = true;
+            break;
+        }
+        dictionary_history_apply(history, key, length, time, hits);
+        records++;
+    }
+    damaged = damaged || dictionary_storage_failed(storage, file);
+
+    history->stats.journal_records = records;
+    if(damaged) history->stale = true;
+    return !damaged;
+}
+
+bool dictionary_history_has_pending(const DictionaryHistory* history) {
+    return history->pending_length > 0;
+}
+
+bool dictionary_history_needs_compaction(const DictionaryHistory* history, bool exiting) {
+    uint32_t records = history->stats.journal_records + history->pending_records;
+    uint32_t limit = exiting ? history->stats.entries :
+                               history->stats.entries * 2 + DICTIONARY_HISTORY_SLACK;
+    return history->stale || records > limit;
+}
+
+void dictionary_history_write_pending(DictionaryHistory* history, DictionaryOutput* out) {
+    out->write(out->context, (const char*)history->pending, history->pending_length);
+    history->stats.journal_records += history->pending_records;
+    history->pending_length = history->pending_records = 0;
+}
+
+void dictionary_history_save(DictionaryHistory* history, DictionaryOutput* out) {
+    uint8_t head[DICTIONARY_HISTORY_HEAD_SIZE] = {0};
+    uint16_t version = DICTIONARY_HISTORY_VERSION;
+    memcpy(head, DICTIONARY_HISTORY_MAGIC, 4);
+    memcpy(head + 4, &version, sizeof(version));
+    out->write(out->context, (const char*)head, sizeof(head));
+
+    uint8_t record[1 + MAX_WORD_LENGTH + sizeof(uint32_t) + sizeof(uint16_t)];
+    for(uint16_t index = history->oldest; index != DICTIONARY_HISTORY_NONE;
+        index = history->entries[index].newer) {
+        const DictionaryHistoryEntry* entry = &history->entries[index];
+        const uint8_t* word = dictionary_history_word(history, index);
+        size_t size = dictionary_history_encode(
+            record,
+            (const char*)word + DICTIONARY_HISTORY_WORD_HEAD,
+            word[2],
+            entry->time,
+            entry->hits);
+        out->write(out->context, (const char*)record, size);
+    }
+    history->stats.journal_records = history->stats.entries;
+    history->pending_length = history->pending_records = 0;
+    history->stale = false;
+    history->journaled = true;
+}
+
+void dictionary_history_set_journal_failed(DictionaryHistory* history) {
+    history->stale = true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Lookup history: the headwords looked up, each with the time of its last
+// lookup and a hit count, most recent first. It lives in RAM, where a repeat
+// lookup is found through a hash table and moved to the front in O(1); when
+// full the least recently looked up word is dropped.
+//
+// On the card it is an append-only journal. Adding a word does no I/O: the
+// record is queued, and the app appends the queue when it is idle. Records of
+// words looked up again pile up in the journal, so it is compacted (rewritten
+// from RAM) once it holds about twice as many records as there are words.
+
+// Journal layout, see tools/README.md
+#define DICTIONARY_HISTORY_MAGIC   "EDHJ"
+#define DICTIONARY_HISTORY_VERSION 1
+// Queued records; when more are added before the app writes them out, the
+// journal is compacted instead
+#define DICTIONARY_HISTORY_PENDING_SIZE 256
+
+typedef struct {
+    char word[MAX_WORD_LENGTH];
+    uint32_t time; // of the last lookup, seconds since the epoch
+    uint16_t hits;
+} DictionaryHistoryItem;
+
+typedef struct {
+    uint32_t entries;
+    uint32_t evictions;
+    uint32_t journal_records; // written, including superseded ones
+    size_t ram;
+} DictionaryHistoryStats;
+
+typedef struct DictionaryHistory DictionaryHistory;
+
+// Room for `capacity` (< 65535) words taking up to `word_bytes` (< 65536) in
+// total; a word costs its length plus 3 bytes.
+DictionaryHistory* dictionary_history_alloc(uint16_t capacity, size_t word_bytes);
+
+void dictionary_history_free(DictionaryHistory* history);
+
+// Records a lookup of `word` (lowercased and trimmed) at `time` and queues
+// its journal record
+void dictionary_history_add(DictionaryHistory* history, const char* word, uint32_t time);
+
+// Copies up to `max` items, most recent first; returns the count
+uint16_t dictionary_history_get_recent(
+    const DictionaryHistory* history,
+    DictionaryHistoryItem* items,
+    uint16_t max);
+
+const DictionaryHistoryStats* dictionary_history_get_stats(const DictionaryHistory* history);
+
+// Replays a journal. Returns false if it is damaged; the records before the
+// damage are kept and the journal is due for compaction.
+bool dictionary_history_load(
+    DictionaryHistory* history,
+    DictionaryStorage* storage,
+    DictionaryFile* file);
+
+bool dictionary_history_has_pending(const DictionaryHistory* history);
+
+// True when the journal should be rewritten rather than appended to: it is
+// missing or damaged, a write failed, the queue overflowed, or it holds too
+// many superseded records. With `exiting` set, any superseded record counts.
+bool dictionary_history_needs_compaction(const DictionaryHistory* history, bool exiting);
+
+// Writes the queued records for appending to the journal and clears the queue
+void dictionary_history_write_pending(DictionaryHistory* history, DictionaryOutput* out);
+
+// Writes a whole compacted journal, oldest word first, and clears the queue
+void dictionary_history_save(DictionaryHistory* history, DictionaryOutput* out);
+
+// Called when writing the journal failed, so it is rewritten next time
+void dictionary_history_set_journal_failed(DictionaryHistory* history);
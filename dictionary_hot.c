@@ -0,0 +1,110 @@
+#include "dictionary_hot.h"
+
+#include <string.h>
+#include <strings.h>
+
+typedef struct {
+    uint16_t key; // offset in dictionary_hot_keys
+    uint16_t length; // of the decoded definition
+    uint32_t id;
+    uint32_t text; // offset in dictionary_hot_text
+} DictionaryHotEntry;
+
+// Generated at build time into the build directory, see application.fam;
+// entries are in key order, with one more marking where the last text ends
+#include "dictionary_hot_table.h"
+
+bool dictionary_hot_matches(uint32_t record_count, uint32_t idx_size) {
+    return DICTIONARY_HOT_COUNT > 0 && record_count == DICTIONARY_HOT_IDX_RECORDS &&
+           idx_size == DICTIONARY_HOT_IDX_SIZE;
+}
+
+bool dictionary_hot_find(const char* word, DictionaryRecord* record) {
+    uint16_t low = 0, high = DICTIONARY_HOT_COUNT;
+    while(low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        const DictionaryHotEntry* entry = &dictionary_hot_entries[mid];
+        const char* key = dictionary_hot_keys + entry->key;
+        int cmp = strcasecmp(word, key);
+        if(cmp == 0) {
+            strcpy(record->key, key);
+            record->id = entry->id;
+            record->offset = mid;
+            record->length = entry->length;
+            record->hot = true;
+            return true;
+        }
+        if(cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return false;
+}
+
+static uint16_t dictionary_hot_code_length(uint8_t code) {
+    return code < DICTIONARY_HOT_FIRST_CODE ?
+               1 :
+               dictionary_hot_code_lengths[code - DICTIONARY_HOT_FIRST_CODE];
+}
+
+// Expands `code` into `buffer`, leaving out its first `skip` bytes and
+// stopping at `size`. Returns the count.
+static size_t dictionary_hot_expand(uint8_t code, uint32_t skip, char* buffer, size_t size) {
+    // Each expansion pops one code and pushes two, one level deeper
+    uint8_t stack[DICTIONARY_HOT_MAX_DEPTH + 1];
+    uint8_t top = 0;
+    size_t count = 0;
+    stack[top++] = code;
+    while(top > 0 && count < size) {
+        code = stack[--top];
+        uint16_t length = dictionary_hot_code_length(code);
+        if(skip >= length) {
+            skip -= length;
+        } else if(code < DICTIONARY_HOT_FIRST_CODE) {
+            buffer[count++] = code;
+        } else {
+            const uint8_t* pair = dictionary_hot_pairs[code - DICTIONARY_HOT_FIRST_CODE];
+            stack[top++] = pair[1];
+            stack[top++] = pair[0];
+        }
+    }
+    return count;
+}
+
+size_t dictionary_hot_read(
+    const DictionaryRecord* record,
+    uint32_t pos,
+    char* buffer,
+    size_t size) {
+    if(!record->hot || record->offset >= DICTIONARY_HOT_COUNT || pos >= record->length) return 0;
+    if(size > (size_t)record->length - pos) size = record->length - pos;
+
+    // Definitions are short: walk the codes from the start, skipping whole
+    // codes before `pos` by their decoded length
+    const DictionaryHotEntry* entry = &dictionary_hot_entries[record->offset];
+    const uint8_t* code = dictionary_hot_text + entry->text;
+    uint32_t at = 0;
+    size_t count = 0;
+    while(count < size) {
+        uint16_t length = dictionary_hot_code_length(*code);
+        if(at + length > pos) {
+            uint32_t skip = at < pos ? pos - at : 0;
+            count += dictionary_hot_expand(*code, skip, buffer + count, size - count);
+        }
+        at += length;
+        code++;
+    }
+    return count;
+}
+
+uint16_t dictionary_hot_get_count(void) {
+    return DICTIONARY_HOT_COUNT;
+}
+
+size_t dictionary_hot_get_size(void) {
+    return sizeof(dictionary_hot_pairs) + sizeof(dictionary_hot_code_lengths) +
+           sizeof(dictionary_hot_entries) + sizeof(dictionary_hot_keys) +
+           sizeof(dictionary_hot_text);
+}
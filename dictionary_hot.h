@@ -0,0 +1,39 @@
+#pragma once
+
+#include "dictionary_index.h"
+
+// Hot words: the definitions of the most common headwords, compiled into the
+// .fap as const tables (tools/dictc.py hot, run by the build through
+// fap_extbuild in application.fam, which also sets how many). Lookups try the
+// table before either file, so these words cost no card access at all.
+//
+// The definitions are byte pair encoded: a byte from
+// DICTIONARY_HOT_FIRST_CODE up stands for a pair of bytes or earlier codes.
+// Reads expand the codes straight into the caller's buffer; nothing is copied
+// to the heap. The table only answers while the card holds the index it was
+// built from.
+
+#define DICTIONARY_HOT_FIRST_CODE 0x80
+// Codes nest at most this deep (HOT_MAX_DEPTH in tools/dictc.py)
+#define DICTIONARY_HOT_MAX_DEPTH 8
+
+// True if the table was built from an index of `record_count` records and
+// `idx_size` bytes, i.e. from the engdict.idx on the card
+bool dictionary_hot_matches(uint32_t record_count, uint32_t idx_size);
+
+// Looks `word` up in the table. A hit is a record with `hot` set, whose
+// offset is its table entry; its id is that of the index built from.
+bool dictionary_hot_find(const char* word, DictionaryRecord* record);
+
+// Copies up to `size` bytes of the definition of a hot record from `pos`.
+// Returns the count, 0 past the end.
+size_t dictionary_hot_read(
+    const DictionaryRecord* record,
+    uint32_t pos,
+    char* buffer,
+    size_t size);
+
+uint16_t dictionary_hot_get_count(void);
+
+// Bytes of the tables in the .fap
+size_t dictionary_hot_get_size(void);
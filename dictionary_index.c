@@ -0,0 +1,714 @@
+#include "dictionary_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// engdict.idx v2: a 16-byte header, a section directory and a fixed-stride
+// record table sorted in strcasecmp order, so each bisection probe is one
+// seek plus one read; v3 only widens the definition length of a record to a
+// u32. Files without the magic use the legacy layout of variable-length
+// [u16 len][key][u32 off][u16 len] records.
+
+bool dictionary_index_read_header(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    DictionaryIndexInfo* info) {
+    memset(info, 0, sizeof(*info));
+
+    uint8_t header[DICTIONARY_IDX_HEADER_SIZE];
+    if(!dictionary_storage_read_at(storage, idx_file, 0, header, sizeof(header)) ||
+       memcmp(header, DICTIONARY_IDX_MAGIC, 4) != 0) {
+        return false; // legacy layout
+    }
+
+    uint16_t version, section_count;
+    memcpy(&version, header + 4, sizeof(version));
+    memcpy(&section_count, header + 6, sizeof(section_count));
+    memcpy(&info->record_count, header + 8, sizeof(info->record_count));
+    memcpy(&info->record_stride, header + 12, sizeof(info->record_stride));
+    info->key_width = header[14];
+    info->record_head = version == DICTIONARY_IDX_VERSION_WIDE ?
+                            DICTIONARY_IDX_RECORD_HEAD_WIDE :
+                            DICTIONARY_IDX_RECORD_HEAD;
+    if((version != DICTIONARY_IDX_VERSION && version != DICTIONARY_IDX_VERSION_WIDE) ||
+       info->key_width >= MAX_WORD_LENGTH ||
+       info->record_stride < info->record_head + info->key_width) {
+        return false;
+    }
+
+    for(uint16_t i = 0; i < section_count; ++i) {
+        uint8_t section[DICTIONARY_IDX_SECTION_SIZE];
+        if(dictionary_storage_read(storage, idx_file, section, sizeof(section)) !=
+           sizeof(section)) {
+            return false;
+        }
+        if(memcmp(section, DICTIONARY_IDX_SECTION_RECORDS, 4) == 0) {
+            memcpy(&info->records_offset, section + 4, sizeof(info->records_offset));
+            info->is_v2 = true;
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_KEYS, 4) == 0) {
+            memcpy(&info->keys_offset, section + 4, sizeof(info->keys_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_DELETES, 4) == 0) {
+            memcpy(&info->deletes_offset, section + 4, sizeof(info->deletes_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_RANDOM, 4) == 0) {
+            memcpy(&info->random_offset, section + 4, sizeof(info->random_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_TERMS, 4) == 0) {
+            memcpy(&info->terms_offset, section + 4, sizeof(info->terms_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_HASH, 4) == 0) {
+            memcpy(&info->hash_offset, section + 4, sizeof(info->hash_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_INFLECTIONS, 4) == 0) {
+            memcpy(&info->inflections_offset, section + 4, sizeof(info->inflections_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_SOUNDS, 4) == 0) {
+            memcpy(&info->sounds_offset, section + 4, sizeof(info->sounds_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_SIGNATURES, 4) == 0) {
+            memcpy(&info->signatures_offset, section + 4, sizeof(info->signatures_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_GLOSSES, 4) == 0) {
+            memcpy(&info->glosses_offset, section + 4, sizeof(info->glosses_offset));
+        } else if(memcmp(section, DICTIONARY_IDX_SECTION_LAYOUT, 4) == 0) {
+            memcpy(&info->layout_offset, section + 4, sizeof(info->layout_offset));
+        }
+    }
+    return info->is_v2;
+}
+
+bool dictionary_index_read_record(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t index,
+    DictionaryRecord* record) {
+    uint8_t raw[DICTIONARY_IDX_RECORD_HEAD_WIDE + MAX_WORD_LENGTH];
+    size_t size = info->record_head + info->key_width;
+
+    if(index >= info->record_count ||
+       !dictionary_storage_read_at(
+           storage,
+           idx_file,
+           info->records_offset + index * (uint32_t)info->record_stride,
+           raw,
+           size)) {
+        return false;
+    }
+    return dictionary_index_decode_record(info, raw, index, record);
+}
+
+bool dictionary_index_decode_record(
+    const DictionaryIndexInfo* info,
+    const uint8_t* raw,
+    uint32_t index,
+    DictionaryRecord* record) {
+    uint8_t key_len = raw[info->record_head - 1];
+    if(key_len > info->key_width) return false;
+    memcpy(&record->offset, raw, sizeof(record->offset));
+    if(info->record_head == DICTIONARY_IDX_RECORD_HEAD_WIDE) {
+        memcpy(&record->length, raw + 4, sizeof(uint32_t));
+    } else {
+        uint16_t length;
+        memcpy(&length, raw + 4, sizeof(length));
+        record->length = length;
+    }
+    memcpy(record->key, raw + info->record_head, key_len);
+    record->key[key_len] = '\0';
+    record->id = index;
+    record->hot = false;
+    return true;
+}
+
+// Range predicate shared by both lower-bound implementations: true for keys
+// at or after `prefix` (or past every key starting with it).
+static bool dictionary_index_key_reached(const char* key, const char* prefix, bool past_prefix) {
+    return past_prefix ? strncasecmp(key, prefix, strlen(prefix)) > 0 :
+                         strcasecmp(key, prefix) >= 0;
+}
+
+bool dictionary_index_read_alias(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t slot,
+    uint32_t coin,
+    uint32_t* id) {
+    uint32_t entry[2];
+    if(!info->random_offset || slot >= info->record_count ||
+       !dictionary_storage_read_at(
+           storage,
+           idx_file,
+           info->random_offset + DICTIONARY_IDX_RANDOM_HEAD_SIZE +
+               slot * DICTIONARY_IDX_RANDOM_ENTRY,
+           entry,
+           sizeof(entry)) ||
+       entry[1] >= info->record_count) {
+        return false;
+    }
+    *id = coin < entry[0] ? slot : entry[1];
+    return true;
+}
+
+bool dictionary_index_find(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* word,
+    DictionaryRecord* record) {
+    uint32_t low = 0, high = info->record_count;
+
+    while(low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if(!dictionary_index_read_record(storage, idx_file, info, mid, record)) break;
+
+        int cmp = strcasecmp(word, record->key);
+        if(cmp == 0) {
+            return true;
+        } else if(cmp < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return false;
+}
+
+uint32_t dictionary_index_lower_bound(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* prefix,
+    bool past_prefix,
+    uint32_t low,
+    uint32_t high) {
+    DictionaryRecord record;
+    while(low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if(!dictionary_index_read_record(storage, idx_file, info, mid, &record)) break;
+        if(dictionary_index_key_reached(record.key, prefix, past_prefix)) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+// --- Legacy layout ---
+
+// Reads the legacy record starting at `*pos` and advances `*pos` past it.
+// Keys longer than the buffer are truncated.
+static bool dictionary_index_read_legacy_record(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t* pos,
+    DictionaryRecord* record) {
+    uint16_t stored_len;
+    if(!dictionary_storage_read_at(storage, idx_file, *pos, &stored_len, sizeof(stored_len))) {
+        return false;
+    }
+
+    uint16_t key_len = stored_len;
+    if(key_len >= MAX_WORD_LENGTH) key_len = MAX_WORD_LENGTH - 1;
+    if(dictionary_storage_read(storage, idx_file, record->key, key_len) != key_len) return false;
+    record->key[key_len] = '\0';
+
+    uint32_t tail = *pos + sizeof(stored_len) + stored_len;
+    if(stored_len != key_len && !dictionary_storage_seek(storage, idx_file, tail)) return false;
+    uint16_t length;
+    if(dictionary_storage_read(storage, idx_file, &record->offset, sizeof(record->offset)) !=
+           sizeof(record->offset) ||
+       dictionary_storage_read(storage, idx_file, &length, sizeof(length)) != sizeof(length)) {
+        return false;
+    }
+    record->length = length;
+    *pos = tail + sizeof(record->offset) + sizeof(length);
+    record->id = UINT32_MAX; // legacy records are not addressable
+    record->hot = false;
+    return true;
+}
+
+// Skips the legacy record at `*pos` by reading only its key length.
+static bool dictionary_index_skip_legacy_record(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t* pos) {
+    uint16_t key_len;
+    if(!dictionary_storage_read_at(storage, idx_file, *pos, &key_len, sizeof(key_len))) {
+        return false;
+    }
+    *pos += sizeof(key_len) + key_len + sizeof(uint32_t) + sizeof(uint16_t);
+    return true;
+}
+
+// Bisects on byte offsets and walks records forward from `low` to find the
+// one straddling `mid`.
+bool dictionary_index_find_legacy(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* word,
+    DictionaryRecord* record) {
+    uint32_t low = 0, high = dictionary_storage_size(storage, idx_file);
+
+    while(low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        uint32_t pos = low;
+        uint32_t pivot_pos = low;
+
+        while(pos < mid) {
+            pivot_pos = pos;
+            if(!dictionary_index_skip_legacy_record(storage, idx_file, &pos)) return false;
+        }
+
+        pos = pivot_pos;
+        if(!dictionary_index_read_legacy_record(storage, idx_file, &pos, record)) break;
+
+        int cmp = strcasecmp(word, record->key);
+        if(cmp == 0) {
+            return true;
+        } else if(cmp < 0) {
+            high = pivot_pos;
+        } else {
+            low = pos;
+        }
+    }
+    return false;
+}
+
+uint32_t dictionary_index_count_legacy(DictionaryStorage* storage, DictionaryFile* idx_file) {
+    uint32_t size = dictionary_storage_size(storage, idx_file);
+    uint32_t count = 0;
+    uint32_t pos = 0;
+    while(pos < size && dictionary_index_skip_legacy_record(storage, idx_file, &pos)) {
+        count++;
+    }
+    return count;
+}
+
+bool dictionary_index_read_nth_legacy(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t target,
+    DictionaryRecord* record) {
+    uint32_t pos = 0;
+    for(uint32_t i = 0; i < target; i++) {
+        if(!dictionary_index_skip_legacy_record(storage, idx_file, &pos)) return false;
+    }
+    return dictionary_index_read_legacy_record(storage, idx_file, &pos, record);
+}
+
+// --- RAM Key Index ---
+// The FCIX section splits the sorted keys into front-coded blocks of up to
+// 255 keys. The block directory and the block-leading keys always live in
+// RAM; as many leading blocks as the budget allows are kept resident too, so
+// a lookup bisects in RAM and then costs at most one block read. Large
+// dictionaries have large blocks, so other blocks are read a chunk at a time
+// and only as far as the walk through them goes.
+
+// Bytes of a block read at a time
+#define DICTIONARY_KEY_INDEX_CHUNK 1024
+// Longest encoded entry: shared and suffix bytes, the suffix, two varints
+#define DICTIONARY_KEY_INDEX_ENTRY_MAX (2 + MAX_WORD_LENGTH + 2 * 5)
+
+struct DictionaryKeyIndex {
+    uint32_t block_count;
+    uint16_t block_keys;
+    uint16_t max_block_size;
+    uint32_t blocks_offset; // file offset of the first block
+    uint32_t* block_offsets; // block_count + 1 entries, relative to blocks_offset
+    uint32_t* leader_offsets; // into leaders
+    char* leaders; // NUL-terminated block-leading keys
+    uint8_t* resident; // blocks [0, resident_blocks)
+    uint32_t resident_blocks;
+    uint8_t* block_buffer; // last non-resident block read
+    uint32_t buffered_block; // block held in block_buffer, UINT32_MAX if none
+    uint32_t buffered_size; // bytes of it read so far
+};
+
+static void* dictionary_key_index_alloc(size_t size, size_t* budget) {
+    if(size > *budget) return NULL;
+    *budget -= size;
+    return malloc(size);
+}
+
+void dictionary_key_index_free(DictionaryKeyIndex* index) {
+    if(!index) return;
+    free(index->block_offsets);
+    free(index->leader_offsets);
+    free(index->leaders);
+    free(index->resident);
+    free(index->block_buffer);
+    free(index);
+}
+
+DictionaryKeyIndex* dictionary_key_index_load(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    size_t budget) {
+    uint8_t head[DICTIONARY_IDX_KEYS_HEAD_SIZE];
+    if(info->keys_offset == 0 ||
+       !dictionary_storage_read_at(storage, idx_file, info->keys_offset, head, sizeof(head))) {
+        return NULL;
+    }
+
+    DictionaryKeyIndex* index = dictionary_key_index_alloc(sizeof(DictionaryKeyIndex), &budget);
+    if(!index) return NULL;
+    memset(index, 0, sizeof(DictionaryKeyIndex));
+    index->buffered_block = UINT32_MAX;
+
+    uint32_t leaders_size, blocks_size;
+    memcpy(&index->block_keys, head, sizeof(uint16_t));
+    memcpy(&index->max_block_size, head + 2, sizeof(uint16_t));
+    memcpy(&index->block_count, head + 4, sizeof(uint32_t));
+    memcpy(&leaders_size, head + 8, sizeof(uint32_t));
+    memcpy(&blocks_size, head + 12, sizeof(uint32_t));
+    if(index->block_count == 0 || index->block_keys == 0 || index->block_keys > UINT8_MAX) {
+        goto failed;
+    }
+
+    size_t dir_size = (index->block_count + 1) * sizeof(uint32_t);
+    index->blocks_offset = info->keys_offset + sizeof(head) + dir_size + leaders_size;
+    index->block_offsets = dictionary_key_index_alloc(dir_size, &budget);
+    index->leader_offsets =
+        dictionary_key_index_alloc(index->block_count * sizeof(uint32_t), &budget);
+    index->leaders = dictionary_key_index_alloc(leaders_size, &budget);
+    index->block_buffer = dictionary_key_index_alloc(index->max_block_size, &budget);
+    if(!index->block_offsets || !index->leader_offsets || !index->leaders ||
+       !index->block_buffer) {
+        goto failed;
+    }
+
+    if(dictionary_storage_read(storage, idx_file, index->block_offsets, dir_size) != dir_size ||
+       dictionary_storage_read(storage, idx_file, index->leaders, leaders_size) !=
+           leaders_size ||
+       index->block_offsets[index->block_count] != blocks_size) {
+        goto failed;
+    }
+
+    // Turn [u8 len][key] leaders into C strings in place
+    uint32_t pos = 0;
+    for(uint32_t i = 0; i < index->block_count; ++i) {
+        uint8_t len = (uint8_t)index->leaders[pos];
+        if(len >= MAX_WORD_LENGTH || pos + 1 + len > leaders_size) goto failed;
+        memmove(index->leaders + pos, index->leaders + pos + 1, len);
+        index->leaders[pos + len] = '\0';
+        index->leader_offsets[i] = pos;
+        pos += len + 1;
+    }
+
+    // Keep as many leading blocks resident as the remaining budget allows
+    uint32_t resident_blocks = index->block_count;
+    while(resident_blocks > 0 && index->block_offsets[resident_blocks] > budget) {
+        resident_blocks--;
+    }
+    if(resident_blocks > 0) {
+        size_t resident_size = index->block_offsets[resident_blocks];
+        index->resident = dictionary_key_index_alloc(resident_size, &budget);
+        if(index->resident &&
+           dictionary_storage_read(storage, idx_file, index->resident, resident_size) ==
+               resident_size) {
+            index->resident_blocks = resident_blocks;
+        }
+    }
+    return index;
+
+failed:
+    dictionary_key_index_free(index);
+    return NULL;
+}
+
+uint32_t dictionary_key_index_get_block_count(const DictionaryKeyIndex* index) {
+    return index->block_count;
+}
+
+uint32_t dictionary_key_index_get_resident_blocks(const DictionaryKeyIndex* index) {
+    return index->resident_blocks;
+}
+
+static uint32_t dictionary_read_varint(const uint8_t* data, uint32_t* pos, uint32_t end) {
+    uint32_t value = 0;
+    for(uint8_t shift = 0; *pos < end && shift < 32; shift += 7) {
+        uint8_t byte = data[(*pos)++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) break;
+    }
+    return value;
+}
+
+// Returns block `block_index` and how much of it is in RAM, reading its first
+// chunk unless it is resident or was the last block read.
+static const uint8_t* dictionary_key_index_get_block(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t block_index,
+    uint32_t* size,
+    uint32_t* loaded) {
+    *size = index->block_offsets[block_index + 1] - index->block_offsets[block_index];
+    if(*size < sizeof(uint32_t) || *size > index->max_block_size) return NULL;
+    if(block_index < index->resident_blocks) {
+        *loaded = *size;
+        return index->resident + index->block_offsets[block_index];
+    }
+    if(index->buffered_block != block_index) {
+        uint32_t chunk = *size < DICTIONARY_KEY_INDEX_CHUNK ? *size : DICTIONARY_KEY_INDEX_CHUNK;
+        index->buffered_block = UINT32_MAX;
+        if(!dictionary_storage_read_at(
+               storage,
+               idx_file,
+               index->blocks_offset + index->block_offsets[block_index],
+               index->block_buffer,
+               chunk)) {
+            return NULL;
+        }
+        index->buffered_block = block_index;
+        index->buffered_size = chunk;
+    }
+    *loaded = index->buffered_size;
+    return index->block_buffer;
+}
+
+// Walks the entries of one block in key order
+typedef struct {
+    DictionaryKeyIndex* index;
+    DictionaryStorage* storage;
+    DictionaryFile* idx_file;
+    uint32_t block_index;
+    const uint8_t* block;
+    uint32_t size;
+    uint32_t loaded; // bytes of the block in RAM
+    bool positioned; // idx_file is at block + loaded
+    uint32_t pos;
+    DictionaryRecord record;
+    size_t key_len;
+    uint32_t next_offset;
+} DictionaryBlockCursor;
+
+static bool dictionary_block_cursor_init(
+    DictionaryBlockCursor* cursor,
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t block_index) {
+    cursor->index = index;
+    cursor->storage = storage;
+    cursor->idx_file = idx_file;
+    cursor->block_index = block_index;
+    // A block read now leaves the file right after its first chunk
+    cursor->positioned = block_index >= index->resident_blocks &&
+                         index->buffered_block != block_index;
+    cursor->block = dictionary_key_index_get_block(
+        index, storage, idx_file, block_index, &cursor->size, &cursor->loaded);
+    if(!cursor->block) return false;
+    memcpy(&cursor->next_offset, cursor->block, sizeof(cursor->next_offset));
+    cursor->pos = sizeof(uint32_t);
+    strcpy(cursor->record.key, index->leaders + index->leader_offsets[block_index]);
+    cursor->key_len = strlen(cursor->record.key);
+    cursor->record.id = block_index * index->block_keys - 1;
+    return true;
+}
+
+// Reads the next chunk of a partly buffered block
+static bool dictionary_block_cursor_fill(DictionaryBlockCursor* cursor) {
+    DictionaryKeyIndex* index = cursor->index;
+    uint32_t chunk = cursor->size - cursor->loaded;
+    if(chunk > DICTIONARY_KEY_INDEX_CHUNK) chunk = DICTIONARY_KEY_INDEX_CHUNK;
+    uint8_t* buffer = index->block_buffer + cursor->loaded;
+    bool read = cursor->positioned ?
+                    dictionary_storage_read(cursor->storage, cursor->idx_file, buffer, chunk) ==
+                        chunk :
+                    dictionary_storage_read_at(
+                        cursor->storage,
+                        cursor->idx_file,
+                        index->blocks_offset + index->block_offsets[cursor->block_index] +
+                            cursor->loaded,
+                        buffer,
+                        chunk);
+    if(!read) {
+        index->buffered_block = UINT32_MAX;
+        return false;
+    }
+    cursor->loaded += chunk;
+    cursor->positioned = true;
+    index->buffered_size = cursor->loaded;
+    return true;
+}
+
+// Decodes the next entry into cursor->record; false at the end of the block
+static bool dictionary_block_cursor_next(DictionaryBlockCursor* cursor) {
+    const uint8_t* block = cursor->block;
+    if(cursor->loaded < cursor->size &&
+       cursor->pos + DICTIONARY_KEY_INDEX_ENTRY_MAX > cursor->loaded &&
+       !dictionary_block_cursor_fill(cursor)) {
+        return false;
+    }
+    if(cursor->pos + 2 > cursor->loaded) return false;
+
+    uint8_t shared = block[cursor->pos];
+    uint8_t suffix_len = block[cursor->pos + 1] & 0x7F;
+    bool has_gap = block[cursor->pos + 1] & 0x80;
+    cursor->pos += 2;
+    if(shared > cursor->key_len || shared + suffix_len >= MAX_WORD_LENGTH ||
+       cursor->pos + suffix_len > cursor->loaded) {
+        return false;
+    }
+    memcpy(cursor->record.key + shared, block + cursor->pos, suffix_len);
+    cursor->key_len = shared + suffix_len;
+    cursor->record.key[cursor->key_len] = '\0';
+    cursor->pos += suffix_len;
+
+    if(has_gap) {
+        cursor->next_offset += dictionary_read_varint(block, &cursor->pos, cursor->loaded);
+    }
+    uint32_t def_len = dictionary_read_varint(block, &cursor->pos, cursor->loaded);
+
+    cursor->record.id++;
+    cursor->record.offset = cursor->next_offset;
+    cursor->record.length = def_len;
+    cursor->record.hot = false;
+    cursor->next_offset += def_len;
+    return true;
+}
+
+static const char* dictionary_key_index_leader(const DictionaryKeyIndex* index, uint32_t block) {
+    return index->leaders + index->leader_offsets[block];
+}
+
+uint32_t dictionary_key_index_locate(const DictionaryKeyIndex* index, const char* word) {
+    uint32_t low = 0, high = index->block_count;
+    while(low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if(strcasecmp(dictionary_key_index_leader(index, mid), word) <= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool dictionary_key_index_is_resident(const DictionaryKeyIndex* index, const char* word) {
+    // A word before the first leader is not in any block
+    uint32_t blocks = dictionary_key_index_locate(index, word);
+    return blocks == 0 || blocks <= index->resident_blocks;
+}
+
+bool dictionary_key_index_find(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* word,
+    DictionaryRecord* record) {
+    uint32_t low = dictionary_key_index_locate(index, word);
+    if(low == 0) return false;
+
+    DictionaryBlockCursor cursor;
+    if(!dictionary_block_cursor_init(&cursor, index, storage, idx_file, low - 1)) return false;
+    while(dictionary_block_cursor_next(&cursor)) {
+        int cmp = strcasecmp(word, cursor.record.key);
+        if(cmp == 0) {
+            *record = cursor.record;
+            return true;
+        } else if(cmp < 0) {
+            break;
+        }
+    }
+    return false;
+}
+
+bool dictionary_key_index_join(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* const* words,
+    uint32_t count,
+    DictionaryJoinCallback visit,
+    void* context) {
+    DictionaryBlockCursor cursor;
+    bool open = false; // the cursor is in block `blocks - 1`
+    uint32_t blocks = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        const char* word = words[i];
+        // The word is in the open block unless it reaches the next leader
+        if(!open || (blocks < index->block_count &&
+                     strcasecmp(dictionary_key_index_leader(index, blocks), word) <= 0)) {
+            open = false;
+            blocks = dictionary_key_index_locate(index, word);
+            if(blocks > 0) {
+                if(!dictionary_block_cursor_init(
+                       &cursor, index, storage, idx_file, blocks - 1) ||
+                   !dictionary_block_cursor_next(&cursor)) {
+                    return false;
+                }
+                open = true;
+            }
+        }
+
+        int cmp = 1;
+        while(open && (cmp = strcasecmp(word, cursor.record.key)) > 0) {
+            if(!dictionary_block_cursor_next(&cursor)) {
+                if(cursor.loaded < cursor.size) return false;
+                break;
+            }
+        }
+        if(!visit(context, i, cmp == 0 ? &cursor.record : NULL)) break;
+        // The visit may have read from idx_file
+        cursor.positioned = false;
+    }
+    return true;
+}
+
+bool dictionary_key_index_read_record(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t id,
+    DictionaryRecord* record) {
+    uint32_t block_index = id / index->block_keys;
+    if(block_index >= index->block_count) return false;
+
+    DictionaryBlockCursor cursor;
+    if(!dictionary_block_cursor_init(&cursor, index, storage, idx_file, block_index)) {
+        return false;
+    }
+    while(dictionary_block_cursor_next(&cursor)) {
+        if(cursor.record.id == id) {
+            *record = cursor.record;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t dictionary_key_index_lower_bound(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* prefix,
+    bool past_prefix,
+    uint32_t low,
+    uint32_t high) {
+    if(low >= high) return low;
+
+    // First block after low's block whose leader is already reached; the
+    // answer then lies in the block before it, or at that block's start.
+    uint32_t first_block = low / index->block_keys;
+    uint32_t lo = first_block + 1, hi = (high - 1) / index->block_keys + 1;
+    while(lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const char* leader = dictionary_key_index_leader(index, mid);
+        if(dictionary_index_key_reached(leader, prefix, past_prefix)) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    uint32_t bound = lo * index->block_keys;
+    if(bound > high) bound = high;
+
+    DictionaryBlockCursor cursor;
+    if(!dictionary_block_cursor_init(&cursor, index, storage, idx_file, lo - 1)) return bound;
+    while(dictionary_block_cursor_next(&cursor) && cursor.record.id < bound) {
+        if(cursor.record.id >= low &&
+           dictionary_index_key_reached(cursor.record.key, prefix, past_prefix)) {
+            return cursor.record.id;
+        }
+    }
+    return bound;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "dictionary_storage.h"
+
+// Headword buffer size, including the NUL; room for multi-word entries
+#define MAX_WORD_LENGTH 64
+
+// engdict.idx v2 layout, see tools/README.md. Version 3 is the same with
+// u32 definition lengths in RECS, written only when a definition needs it.
+#define DICTIONARY_IDX_MAGIC           "EDIX"
+#define DICTIONARY_IDX_VERSION         2
+#define DICTIONARY_IDX_VERSION_WIDE    3
+#define DICTIONARY_IDX_HEADER_SIZE     16
+#define DICTIONARY_IDX_SECTION_SIZE    12
+#define DICTIONARY_IDX_SECTION_RECORDS "RECS"
+#define DICTIONARY_IDX_RECORD_HEAD     7 // u32 offset, u16 length, u8 key length
+#define DICTIONARY_IDX_RECORD_HEAD_WIDE 9 // u32 offset, u32 length, u8 key length
+#define DICTIONARY_IDX_SECTION_KEYS    "FCIX"
+#define DICTIONARY_IDX_KEYS_HEAD_SIZE  20
+#define DICTIONARY_IDX_SECTION_DELETES "DELS"
+#define DICTIONARY_IDX_SECTION_RANDOM  "RAND"
+#define DICTIONARY_IDX_RANDOM_HEAD_SIZE 16
+#define DICTIONARY_IDX_RANDOM_ENTRY     8 // u32 threshold, u32 alias
+#define DICTIONARY_IDX_SECTION_TERMS    "TERM"
+#define DICTIONARY_IDX_SECTION_HASH     "HASH"
+#define DICTIONARY_IDX_SECTION_INFLECTIONS "INFL"
+#define DICTIONARY_IDX_SECTION_SOUNDS   "SNDX"
+#define DICTIONARY_IDX_SECTION_SIGNATURES "SIGS"
+#define DICTIONARY_IDX_SECTION_GLOSSES  "GLOS"
+#define DICTIONARY_IDX_SECTION_LAYOUT   "LINE"
+
+typedef struct {
+    bool is_v2;
+    uint32_t record_count;
+    uint32_t records_offset;
+    uint16_t record_stride;
+    uint8_t record_head; // bytes before the key in a RECS record
+    uint8_t key_width;
+    uint32_t keys_offset; // FCIX section, 0 if absent
+    uint32_t deletes_offset; // DELS section, 0 if absent
+    uint32_t random_offset; // RAND section, 0 if absent
+    uint32_t terms_offset; // TERM section, 0 if absent
+    uint32_t hash_offset; // HASH section, 0 if absent
+    uint32_t inflections_offset; // INFL section, 0 if absent
+    uint32_t sounds_offset; // SNDX section, 0 if absent
+    uint32_t signatures_offset; // SIGS section, 0 if absent
+    uint32_t glosses_offset; // GLOS section, 0 if absent
+    uint32_t layout_offset; // LINE section, 0 if absent
+} DictionaryIndexInfo;
+
+// An index entry: the headword and where its definition lives in engdict.dat
+typedef struct {
+    char key[MAX_WORD_LENGTH];
+    uint32_t id; // position in key order, UINT32_MAX for legacy indexes
+    uint32_t offset; // into the plain text, which a GLOS index stores as glosses
+    uint32_t length;
+    bool hot; // in the .fap instead, see dictionary_hot.h; offset is the entry
+} DictionaryRecord;
+
+// Returns false for the legacy layout (or a damaged header).
+bool dictionary_index_read_header(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    DictionaryIndexInfo* info);
+
+// Reads record `index` of a v2 index with a single seek and read.
+bool dictionary_index_read_record(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t index,
+    DictionaryRecord* record);
+
+// Decodes the record_head + key_width bytes of a RECS record (or a copy of
+// one) at `raw` as record `index`.
+bool dictionary_index_decode_record(
+    const DictionaryIndexInfo* info,
+    const uint8_t* raw,
+    uint32_t index,
+    DictionaryRecord* record);
+
+// Resolves alias table slot `slot` of the RAND section to a record id: the
+// slot's own record when `coin` is below its threshold, else its alias.
+bool dictionary_index_read_alias(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t slot,
+    uint32_t coin,
+    uint32_t* id);
+
+bool dictionary_index_find(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* word,
+    DictionaryRecord* record);
+
+// First record in [low, high) whose key is >= prefix, or with past_prefix
+// set, the first whose key sorts after every key starting with prefix.
+// Returns high if there is none.
+uint32_t dictionary_index_lower_bound(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* prefix,
+    bool past_prefix,
+    uint32_t low,
+    uint32_t high);
+
+bool dictionary_index_find_legacy(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* word,
+    DictionaryRecord* record);
+
+uint32_t dictionary_index_count_legacy(DictionaryStorage* storage, DictionaryFile* idx_file);
+
+bool dictionary_index_read_nth_legacy(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t target,
+    DictionaryRecord* record);
+
+// --- RAM key index (FCIX section) ---
+
+typedef struct DictionaryKeyIndex DictionaryKeyIndex;
+
+// Loads the block directory and leaders, then as many leading blocks as fit
+// in `budget` bytes. Returns NULL if the section is missing or the directory
+// alone does not fit.
+DictionaryKeyIndex* dictionary_key_index_load(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    size_t budget);
+
+void dictionary_key_index_free(DictionaryKeyIndex* index);
+
+uint32_t dictionary_key_index_get_block_count(const DictionaryKeyIndex* index);
+
+uint32_t dictionary_key_index_get_resident_blocks(const DictionaryKeyIndex* index);
+
+// Number of blocks whose leader is <= word, i.e. one past the block that
+// would hold it; 0 if it sorts before every key
+uint32_t dictionary_key_index_locate(const DictionaryKeyIndex* index, const char* word);
+
+// True if the block that would hold `word` is resident, so finding it reads
+// nothing.
+bool dictionary_key_index_is_resident(const DictionaryKeyIndex* index, const char* word);
+
+// Bisects the leaders in RAM, then decodes one block (read from idx_file
+// unless it is resident).
+bool dictionary_key_index_find(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* word,
+    DictionaryRecord* record);
+
+// Called for each word of a join with its record, or NULL when it is not a
+// key. Returns false to stop the join.
+typedef bool (*DictionaryJoinCallback)(
+    void* context,
+    uint32_t word_index,
+    const DictionaryRecord* record);
+
+// Looks up `count` words sorted by strcasecmp() in one pass: each block
+// holding one of them is read once, in file order, and the cursor walks on
+// from the previous word instead of bisecting again. Returns false if a
+// block could not be read; stopping through `visit` is not a failure.
+bool dictionary_key_index_join(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* const* words,
+    uint32_t count,
+    DictionaryJoinCallback visit,
+    void* context);
+
+bool dictionary_key_index_read_record(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    uint32_t id,
+    DictionaryRecord* record);
+
+// Same contract as dictionary_index_lower_bound(); bisects the leaders of
+// the blocks covering [low, high) in RAM and decodes a single block.
+uint32_t dictionary_key_index_lower_bound(
+    DictionaryKeyIndex* index,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const char* prefix,
+    bool past_prefix,
+    uint32_t low,
+    uint32_t high);
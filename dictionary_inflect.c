@@ -0,0 +1,100 @@
+#include "dictionary_inflect.h"
+
+#include "dictionary_core.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DICTIONARY_INFLECT_HEAD_SIZE 16
+#define DICTIONARY_INFLECT_EMPTY     UINT32_MAX
+
+struct DictionaryInflections {
+    uint32_t bucket_count; // plus one more for the last one's spill
+    uint32_t count;
+    uint32_t id_bits;
+    uint32_t slots; // entries per bucket
+    uint32_t buckets_offset;
+};
+
+DictionaryInflections* dictionary_inflections_load(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info) {
+    uint8_t head[DICTIONARY_INFLECT_HEAD_SIZE];
+    if(info->inflections_offset == 0 ||
+       !dictionary_storage_read_at(
+           storage, idx_file, info->inflections_offset, head, sizeof(head))) {
+        return NULL;
+    }
+
+    DictionaryInflections* inflections = malloc(sizeof(DictionaryInflections));
+    memcpy(&inflections->bucket_count, head, sizeof(uint32_t));
+    memcpy(&inflections->count, head + 4, sizeof(uint32_t));
+    memcpy(&inflections->id_bits, head + 8, sizeof(uint32_t));
+    memcpy(&inflections->slots, head + 12, sizeof(uint32_t));
+    inflections->buckets_offset = info->inflections_offset + sizeof(head);
+    // An id of all ones must not be a record, so empty slots never match
+    if(inflections->bucket_count == 0 || inflections->id_bits == 0 ||
+       inflections->id_bits >= 32 || (info->record_count >> inflections->id_bits) != 0 ||
+       inflections->slots == 0 || inflections->slots > DICTIONARY_INFLECT_MAX_SLOTS) {
+        free(inflections);
+        return NULL;
+    }
+    return inflections;
+}
+
+void dictionary_inflections_free(DictionaryInflections* inflections) {
+    free(inflections);
+}
+
+uint32_t dictionary_inflections_get_count(const DictionaryInflections* inflections) {
+    return inflections->count;
+}
+
+// MurmurHash3's finalizer, as fmix32() in tools/dictc.py
+static uint32_t dictionary_inflect_mix(uint32_t hash) {
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35;
+    return hash ^ (hash >> 16);
+}
+
+bool dictionary_inflections_find(
+    const DictionaryInflections* inflections,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* form,
+    uint32_t* id) {
+    // FNV-1a of the lowercase form
+    uint32_t hash = DICTIONARY_FNV1A_BASIS;
+    for(const char* c = form; *c; c++) {
+        uint8_t byte = (uint8_t)tolower((unsigned char)*c);
+        hash = dictionary_fnv1a(&byte, 1, hash);
+    }
+
+    // The home bucket and the next, which holds its spill
+    uint32_t entries[2 * DICTIONARY_INFLECT_MAX_SLOTS];
+    uint32_t count = 2 * inflections->slots;
+    uint32_t bucket = dictionary_inflect_mix(hash) % inflections->bucket_count;
+    if(!dictionary_storage_read_at(
+           storage,
+           idx_file,
+           inflections->buckets_offset + bucket * inflections->slots * sizeof(uint32_t),
+           entries,
+           count * sizeof(uint32_t))) {
+        return false;
+    }
+
+    uint32_t id_bits = inflections->id_bits;
+    for(uint32_t i = 0; i < count; i++) {
+        if(entries[i] == DICTIONARY_INFLECT_EMPTY || entries[i] >> id_bits != hash >> id_bits) {
+            continue;
+        }
+        *id = entries[i] & ((1UL << id_bits) - 1);
+        return *id < info->record_count;
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "dictionary_index.h"
+
+// Inflected forms that are not headwords ("mice", "stopped", "happier"),
+// through the INFL section of engdict.idx. tools/dictc.py makes the forms
+// from suffix rules and a table of irregular ones, and hashes each to a
+// fingerprint plus the id of its lemma: (hash >> id_bits) << id_bits | id.
+// A form's hash picks a home bucket of a few entries, and the builder keeps
+// every entry in its home bucket or the next, so one read of two buckets
+// finds it. Only fingerprints are stored, so about one word in ten thousand
+// that is neither a headword nor a known form still matches some entry; the
+// result names the lemma it went to, so such a match shows.
+
+// Bucket entries read per lookup are at most twice this
+#define DICTIONARY_INFLECT_MAX_SLOTS 16
+
+typedef struct DictionaryInflections DictionaryInflections;
+
+// Reads the section header. Returns NULL if the section is missing or
+// damaged.
+DictionaryInflections* dictionary_inflections_load(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info);
+
+void dictionary_inflections_free(DictionaryInflections* inflections);
+
+uint32_t dictionary_inflections_get_count(const DictionaryInflections* inflections);
+
+// Sets `id` to the record id of the lemma of `form`; false if the form is
+// not in the map or the read failed
+bool dictionary_inflections_find(
+    const DictionaryInflections* inflections,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    const char* form,
+    uint32_t* id);
@@ -0,0 +1,91 @@
+#include "dictionary_layout.h"
+#include "dictionary_pager.h"
+
+#include <string.h>
+
+bool dictionary_layout_check(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info) {
+    if(info->layout_offset == 0) return false;
+    uint32_t head[DICTIONARY_LAYOUT_HEAD_SIZE / 4];
+    if(!dictionary_storage_read_at(storage, idx_file, info->layout_offset, head, sizeof(head))) {
+        return false;
+    }
+    // Lines wrapped at another width would not match what the pager draws
+    return head[0] == info->record_count && head[2] == DICTIONARY_PAGER_COLUMNS &&
+           head[3] == DICTIONARY_PAGER_LINE_SIZE - 1;
+}
+
+bool dictionary_layout_load(
+    DictionaryLayout* layout,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t id) {
+    memset(layout, 0, sizeof(DictionaryLayout));
+    if(info->layout_offset == 0 || id >= info->record_count) return false;
+
+    uint32_t range[2];
+    if(!dictionary_storage_read_at(
+           storage,
+           idx_file,
+           info->layout_offset + DICTIONARY_LAYOUT_HEAD_SIZE + id * sizeof(uint32_t),
+           range,
+           sizeof(range)) ||
+       range[1] < range[0]) {
+        return false;
+    }
+    layout->first = range[0];
+    layout->count = range[1] - range[0];
+    return true;
+}
+
+// Offset of the entry of line `line` of the section
+static uint32_t dictionary_layout_entry_offset(const DictionaryIndexInfo* info, uint32_t line) {
+    return info->layout_offset + DICTIONARY_LAYOUT_HEAD_SIZE +
+           (info->record_count + 1) * sizeof(uint32_t) + line * DICTIONARY_LAYOUT_ENTRY_SIZE;
+}
+
+bool dictionary_layout_read_line(
+    const DictionaryLayout* layout,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t line,
+    DictionaryFormatState* state) {
+    if(line >= layout->count) return false;
+    uint8_t entry[DICTIONARY_LAYOUT_ENTRY_SIZE];
+    if(!dictionary_storage_read_at(
+           storage,
+           idx_file,
+           dictionary_layout_entry_offset(info, layout->first + line),
+           entry,
+           sizeof(entry))) {
+        return false;
+    }
+    dictionary_layout_decode(entry, state);
+    return true;
+}
+
+bool dictionary_layout_read_lines(
+    const DictionaryLayout* layout,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    void* entries) {
+    return layout->count == 0 ||
+           dictionary_storage_read_at(
+               storage,
+               idx_file,
+               dictionary_layout_entry_offset(info, layout->first),
+               entries,
+               layout->count * DICTIONARY_LAYOUT_ENTRY_SIZE);
+}
+
+void dictionary_layout_decode(const void* entry, DictionaryFormatState* state) {
+    uint16_t fields[DICTIONARY_LAYOUT_ENTRY_SIZE / 2];
+    memcpy(fields, entry, sizeof(fields));
+    dictionary_format_state_init_body(
+        state, fields[0], fields[1] >> 5, fields[1] & 1, (fields[1] >> 1) & 0xF);
+}
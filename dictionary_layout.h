@@ -0,0 +1,65 @@
+#pragma once
+
+#include "dictionary_format.h"
+
+// Definitions laid out ahead for the result screen, through the LINE section
+// of engdict.idx. tools/dictc.py formats and wraps every definition as the
+// pager does (dictionary_pager.h) and stores the formatter state each line of
+// its body starts at, so the pager starts any line with one small read
+// instead of formatting the text before it, and knows how many lines there
+// are. The headline is left out: it depends on the word shown (an inflected
+// form heads its lemma's entry) and ends with its own line break, so the
+// body lines are the same under any headline.
+//
+// The section holds u32 record count, line count, columns and line bytes
+// (those of the pager it was laid out for), then record count + 1 u32 line
+// numbers (the first body line of each record, then the total), then a
+// 4-byte entry per line: u16 raw position and u16 senses numbered << 5 |
+// pending spaces << 1 | within a sense. A record with no lines is formatted
+// as it goes, as without the section.
+
+#define DICTIONARY_LAYOUT_HEAD_SIZE  16
+#define DICTIONARY_LAYOUT_ENTRY_SIZE 4
+
+typedef struct {
+    uint32_t first; // line number of the record's first body line
+    uint32_t count; // body lines, 0 if none are laid out
+} DictionaryLayout;
+
+// Whether the section is there and laid out for this build's pager; reads
+// its head
+bool dictionary_layout_check(
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info);
+
+// Reads the lines of record `id` with one read; false on a read error or a
+// damaged entry, which leaves `layout` empty. The section must have passed
+// dictionary_layout_check().
+bool dictionary_layout_load(
+    DictionaryLayout* layout,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t id);
+
+// Reads the state body line `line` (< layout->count) starts at
+bool dictionary_layout_read_line(
+    const DictionaryLayout* layout,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    uint32_t line,
+    DictionaryFormatState* state);
+
+// Reads the entries of all lines of `layout` into `entries`
+// (layout->count * DICTIONARY_LAYOUT_ENTRY_SIZE bytes) with one read
+bool dictionary_layout_read_lines(
+    const DictionaryLayout* layout,
+    DictionaryStorage* storage,
+    DictionaryFile* idx_file,
+    const DictionaryIndexInfo* info,
+    void* entries);
+
+// The state a line starts at, from its entry
+void dictionary_layout_decode(const void* entry, DictionaryFormatState* state);
@@ -0,0 +1,182 @@
+#include "dictionary_pager.h"
+
+#include <string.h>
+
+// Records the state of line `number`, which starts at the formatter's state,
+// if it falls on the next checkpoint
+static void dictionary_pager_checkpoint(DictionaryPager* pager, uint32_t number) {
+    if(number % pager->checkpoint_stride != 0 ||
+       number / pager->checkpoint_stride != pager->checkpoint_count) {
+        return;
+    }
+    if(pager->checkpoint_count == DICTIONARY_PAGER_CHECKPOINTS) {
+        for(uint8_t i = 0; i < DICTIONARY_PAGER_CHECKPOINTS / 2; i++) {
+            pager->checkpoints[i] = pager->checkpoints[i * 2];
+        }
+        pager->checkpoint_count = DICTIONARY_PAGER_CHECKPOINTS / 2;
+        pager->checkpoint_stride *= 2;
+        // The new stride is even, so `number` is on it
+    }
+    pager->checkpoints[pager->checkpoint_count++] = pager->formatter.state;
+}
+
+// Formats line `number` into `line`, wrapping at the last space that fits or
+// breaking the word when there is none. Returns false when the text has ended.
+static bool dictionary_pager_read_line(DictionaryPager* pager, uint32_t number, char* line) {
+    DictionaryFormatter* formatter = &pager->formatter;
+    dictionary_pager_checkpoint(pager, number);
+
+    size_t length = 0;
+    uint8_t columns = 0;
+    bool read_any = false;
+    size_t space_length = SIZE_MAX; // line up to the last space
+    DictionaryFormatState after_space;
+    for(;;) {
+        DictionaryFormatState before = formatter->state;
+        int c = dictionary_formatter_next(formatter);
+        if(c < 0) break;
+        read_any = true;
+        if(c == '\n') break;
+
+        bool continuation = (c & 0xC0) == 0x80;
+        if(!continuation && columns == DICTIONARY_PAGER_COLUMNS) {
+            if(c == ' ') break; // a space at the edge just ends the line
+            if(space_length != SIZE_MAX) {
+                length = space_length;
+                formatter->state = after_space;
+            } else {
+                formatter->state = before;
+            }
+            break;
+        }
+        if(length + 1 == DICTIONARY_PAGER_LINE_SIZE) {
+            formatter->state = before;
+            break;
+        }
+
+        line[length++] = c;
+        if(!continuation) columns++;
+        if(c == ' ') {
+            space_length = length - 1;
+            after_space = formatter->state;
+        }
+    }
+    line[length] = '\0';
+    return read_any;
+}
+
+// Whether anything follows the formatter's state
+static bool dictionary_pager_has_more(DictionaryPager* pager) {
+    DictionaryFormatState state = pager->formatter.state;
+    bool more = dictionary_formatter_next(&pager->formatter) >= 0;
+    pager->formatter.state = state;
+    return more;
+}
+
+// Fills the screen with the lines from `top` on, starting from the state of
+// line `number` (<= top) in the formatter
+static bool dictionary_pager_fill(DictionaryPager* pager, uint32_t number, uint32_t top) {
+    char skipped[DICTIONARY_PAGER_LINE_SIZE];
+    while(number < top && dictionary_pager_read_line(pager, number, skipped)) {
+        number++;
+    }
+    pager->top = number;
+    pager->line_count = 0;
+    while(pager->line_count < DICTIONARY_PAGER_LINES) {
+        DictionaryFormatState state = pager->formatter.state;
+        if(!dictionary_pager_read_line(
+               pager, pager->top + pager->line_count, pager->lines[pager->line_count])) {
+            break;
+        }
+        pager->line_states[pager->line_count++] = state;
+    }
+    pager->at_end = !dictionary_pager_has_more(pager);
+    return !pager->formatter.failed;
+}
+
+// Counts the lines of the headline, which the layout leaves out: those on
+// the screen, and past it for a headline longer than the screen
+static uint32_t dictionary_pager_count_headline(DictionaryPager* pager) {
+    for(uint8_t i = 0; i < pager->line_count; i++) {
+        if(dictionary_format_state_in_body(&pager->line_states[i])) return i;
+    }
+    DictionaryFormatState state = pager->formatter.state;
+    uint32_t number = pager->top + pager->line_count;
+    char skipped[DICTIONARY_PAGER_LINE_SIZE];
+    while(!dictionary_format_state_in_body(&pager->formatter.state) &&
+          dictionary_pager_read_line(pager, number, skipped)) {
+        number++;
+    }
+    pager->formatter.state = state;
+    return number;
+}
+
+bool dictionary_pager_init(
+    DictionaryPager* pager,
+    const DictionaryTextSource* source,
+    const char* word) {
+    memset(pager, 0, sizeof(DictionaryPager));
+    dictionary_formatter_init(&pager->formatter, source, word);
+    pager->checkpoint_stride = 1;
+    if(!dictionary_pager_fill(pager, 0, 0)) return false;
+    if(source->read_line && word) {
+        pager->headline_lines = dictionary_pager_count_headline(pager);
+        pager->line_count_total = pager->headline_lines + source->lines;
+    }
+    return !pager->formatter.failed;
+}
+
+static bool dictionary_pager_scroll_down(DictionaryPager* pager, uint32_t lines) {
+    for(; lines > 0 && !pager->at_end; lines--) {
+        DictionaryFormatState state = pager->formatter.state;
+        uint32_t number = pager->top + pager->line_count;
+        char* last = pager->lines[DICTIONARY_PAGER_LINES - 1];
+        if(pager->line_count == DICTIONARY_PAGER_LINES) {
+            memmove(
+                pager->lines[0], pager->lines[1], sizeof(pager->lines) - sizeof(pager->lines[0]));
+            memmove(
+                pager->line_states,
+                pager->line_states + 1,
+                sizeof(pager->line_states) - sizeof(pager->line_states[0]));
+            pager->top++;
+        } else {
+            last = pager->lines[pager->line_count++];
+        }
+        dictionary_pager_read_line(pager, number, last);
+        pager->line_states[pager->line_count - 1] = state;
+        pager->at_end = !dictionary_pager_has_more(pager);
+    }
+    return !pager->formatter.failed;
+}
+
+bool dictionary_pager_scroll(DictionaryPager* pager, int32_t lines) {
+    if(lines >= 0) return dictionary_pager_scroll_down(pager, lines);
+
+    uint32_t up = (uint32_t)-lines;
+    if(pager->top == 0) return true;
+    uint32_t top = up < pager->top ? pager->top - up : 0;
+    uint32_t checkpoint = top / pager->checkpoint_stride;
+    if(checkpoint >= pager->checkpoint_count) checkpoint = pager->checkpoint_count - 1;
+    uint32_t number = checkpoint * pager->checkpoint_stride;
+    if(pager->line_count_total > 0 && top >= pager->headline_lines &&
+       top - number > DICTIONARY_PAGER_REFORMAT_LINES) {
+        // A body line laid out ahead starts from its own state
+        const DictionaryTextSource* source = &pager->formatter.source;
+        DictionaryFormatState state;
+        if(!source->read_line(source->context, top - pager->headline_lines, &state)) {
+            return false;
+        }
+        pager->formatter.state = state;
+        return dictionary_pager_fill(pager, top, top);
+    }
+    pager->formatter.state = pager->checkpoints[checkpoint];
+    return dictionary_pager_fill(pager, number, top);
+}
+
+uint32_t dictionary_pager_get_position(const DictionaryPager* pager) {
+    return pager->line_count > 0 ? pager->line_states[0].pos : pager->formatter.state.pos;
+}
+
+uint32_t dictionary_pager_get_line_count(const DictionaryPager* pager) {
+    return pager->line_count_total;
+}
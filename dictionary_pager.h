@@ -0,0 +1,53 @@
+#pragma once
+
+#include "dictionary_format.h"
+
+// Word-wrapped screen of formatted result text. Only the visible lines are
+// kept; scrolling down formats the next line from where the last one ended,
+// scrolling up restarts from a saved formatter state. A state is saved every
+// `checkpoint_stride` lines, and when the table fills every other one is
+// dropped and the stride doubles, so stepping back never re-formats more than
+// a stride of lines however long the definition is. When the source has the
+// body laid out ahead (dictionary_layout.h) the line count is known, and a
+// body line further than a few lines past its checkpoint restarts from its
+// own state instead.
+
+#define DICTIONARY_PAGER_LINES   5
+#define DICTIONARY_PAGER_COLUMNS 20
+// Columns are characters, which take up to four bytes in UTF-8
+#define DICTIONARY_PAGER_LINE_SIZE   (DICTIONARY_PAGER_COLUMNS * 4 + 1)
+#define DICTIONARY_PAGER_CHECKPOINTS 16
+// Lines re-formatted from a checkpoint rather than reading the layout, which
+// costs a read of the index
+#define DICTIONARY_PAGER_REFORMAT_LINES 2
+
+typedef struct {
+    DictionaryFormatter formatter; // positioned after the last visible line
+    char lines[DICTIONARY_PAGER_LINES][DICTIONARY_PAGER_LINE_SIZE];
+    DictionaryFormatState line_states[DICTIONARY_PAGER_LINES]; // where each line starts
+    uint8_t line_count;
+    uint32_t top; // number of the first visible line
+    bool at_end; // nothing follows the last visible line
+    DictionaryFormatState checkpoints[DICTIONARY_PAGER_CHECKPOINTS];
+    uint8_t checkpoint_count;
+    uint32_t checkpoint_stride;
+    uint32_t headline_lines; // before the body, counted when the source has its lines
+    uint32_t line_count_total; // 0 unless the source has its lines
+} DictionaryPager;
+
+// Shows the first lines of `source`, formatted as the entry for `word` or
+// unchanged when `word` is NULL. Returns false if the source failed.
+bool dictionary_pager_init(
+    DictionaryPager* pager,
+    const DictionaryTextSource* source,
+    const char* word);
+
+// Moves the view by `lines` (negative is up), stopping at either end.
+// Returns false if the source failed.
+bool dictionary_pager_scroll(DictionaryPager* pager, int32_t lines);
+
+// Raw text position of the first visible line, for a scrollbar
+uint32_t dictionary_pager_get_position(const DictionaryPager* pager);
+
+// Lines of the whole text, 0 when the source does not have its lines laid out
+uint32_t dictionary_pager_get_line_count(const DictionaryPager* pager);
@@ -0,0 +1,290 @@
+#include "dictionary_pattern.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DICTIONARY_PATTERN_HEAD_SIZE    16
+#define DICTIONARY_PATTERN_LENGTH_SHIFT 26
+#define DICTIONARY_PATTERN_LETTER_BITS  ((1UL << DICTIONARY_PATTERN_LENGTH_SHIFT) - 1)
+#define DICTIONARY_PATTERN_LENGTH_BITS  (~DICTIONARY_PATTERN_LETTER_BITS)
+// Two signatures per 64-bit word: the lowest and the highest bit of each
+#define DICTIONARY_PATTERN_LANE_LOWS  0x0000000100000001ULL
+#define DICTIONARY_PATTERN_LANE_HIGHS 0x8000000080000000ULL
+
+struct DictionaryPatterns {
+    Dictionary* dict;
+    uint32_t count;
+    uint32_t offset; // of the first signature in engdict.idx
+    uint32_t* signatures; // NULL when read from the card per query
+};
+
+typedef struct {
+    uint32_t select; // signature bits the filter compares
+    uint32_t want; // what they must be
+    uint8_t min_length; // checked after the filter when there is a '*'
+    uint8_t prefix_length; // letters before the first wildcard
+    bool anagram;
+    char text[MAX_WORD_LENGTH]; // lowercase
+    uint8_t letters[26]; // letter counts of an anagram query
+} DictionaryPatternQuery;
+
+typedef struct {
+    DictionaryPatterns* patterns;
+    DictionaryFile* idx_file;
+    const DictionaryPatternQuery* query;
+    DictionaryPatternResults* results;
+    uint8_t checks;
+    bool failed;
+} DictionaryPatternScan;
+
+bool dictionary_patterns_is_available(const Dictionary* dict) {
+    return dictionary_get_index_info(dict)->signatures_offset != 0;
+}
+
+uint32_t dictionary_pattern_signature(const char* key) {
+    uint32_t mask = 0;
+    size_t length = 0;
+    for(; key[length]; length++) {
+        if(key[length] < 'a' || key[length] > 'z') return 0;
+        mask |= 1UL << (key[length] - 'a');
+    }
+    if(length >> (32 - DICTIONARY_PATTERN_LENGTH_SHIFT)) return 0;
+    return mask | (uint32_t)length << DICTIONARY_PATTERN_LENGTH_SHIFT;
+}
+
+DictionaryPatterns* dictionary_patterns_alloc(Dictionary* dict, size_t ram_budget) {
+    const DictionaryIndexInfo* info = dictionary_get_index_info(dict);
+    DictionaryFile* idx_file = dictionary_get_index_file(dict);
+    if(!info->signatures_offset || !idx_file) return NULL;
+
+    uint8_t head[DICTIONARY_PATTERN_HEAD_SIZE];
+    uint32_t count;
+    DictionaryStorage* storage = dictionary_get_storage(dict);
+    if(!dictionary_storage_read_at(
+           storage, idx_file, info->signatures_offset, head, sizeof(head))) {
+        dictionary_check_files(dict);
+        return NULL;
+    }
+    memcpy(&count, head, sizeof(count));
+    if(count != info->record_count) return NULL;
+
+    DictionaryPatterns* patterns = malloc(sizeof(DictionaryPatterns));
+    patterns->dict = dict;
+    patterns->count = count;
+    patterns->offset = info->signatures_offset + DICTIONARY_PATTERN_HEAD_SIZE;
+    patterns->signatures = NULL;
+    size_t size = (size_t)count * sizeof(uint32_t);
+    if(size > 0 && size <= ram_budget) {
+        patterns->signatures = malloc(size);
+        if(!dictionary_storage_read_at(
+               storage, idx_file, patterns->offset, patterns->signatures, size)) {
+            free(patterns->signatures);
+            patterns->signatures = NULL;
+        }
+    }
+    dictionary_check_files(dict);
+    return patterns;
+}
+
+void dictionary_patterns_free(DictionaryPatterns* patterns) {
+    if(!patterns) return;
+    free(patterns->signatures);
+    free(patterns);
+}
+
+size_t dictionary_patterns_get_size(const DictionaryPatterns* patterns) {
+    return patterns->signatures ? patterns->count * sizeof(uint32_t) : 0;
+}
+
+// Fills `query` from the text; false if it is not a pattern (or, for an
+// anagram, a word) of ASCII letters
+static bool dictionary_pattern_parse(
+    DictionaryPatternQuery* query,
+    const char* text,
+    bool anagram) {
+    memset(query, 0, sizeof(DictionaryPatternQuery));
+    query->anagram = anagram;
+    size_t length = strlen(text);
+    if(length == 0 || length >= MAX_WORD_LENGTH) return false;
+
+    uint32_t mask = 0;
+    bool star = false;
+    bool wildcard = false;
+    for(size_t i = 0; i < length; i++) {
+        char c = tolower((unsigned char)text[i]);
+        query->text[i] = c;
+        if(c >= 'a' && c <= 'z') {
+            mask |= 1UL << (c - 'a');
+            query->letters[c - 'a']++;
+            query->min_length++;
+            if(!wildcard && !anagram) query->prefix_length++;
+        } else if(c == '?' && !anagram) {
+            query->min_length++;
+            wildcard = true;
+        } else if(c == '*' && !anagram) {
+            star = true;
+            wildcard = true;
+        } else {
+            return false;
+        }
+    }
+
+    // An exact length is part of the filter; a minimum one is checked after
+    uint32_t length_bits = (uint32_t)query->min_length << DICTIONARY_PATTERN_LENGTH_SHIFT;
+    query->select = star ? mask : mask | DICTIONARY_PATTERN_LENGTH_BITS;
+    query->want = star ? mask : mask | length_bits;
+    if(anagram) query->select = UINT32_MAX; // same letters, same length
+    return true;
+}
+
+// '?' matches one letter and '*' any run of them, backtracking to the last
+// '*' on a mismatch
+static bool dictionary_pattern_matches(const char* pattern, const char* key) {
+    const char* star = NULL;
+    const char* resume = NULL;
+    while(*key) {
+        if(*pattern == '*') {
+            star = pattern++;
+            resume = key;
+        } else if(*pattern == '?' || *pattern == *key) {
+            pattern++;
+            key++;
+        } else if(star) {
+            pattern = star + 1;
+            key = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while(*pattern == '*')
+        pattern++;
+    return *pattern == '\0';
+}
+
+static bool dictionary_pattern_is_anagram(const DictionaryPatternQuery* query, const char* key) {
+    if(strcmp(key, query->text) == 0) return false;
+    uint8_t letters[26];
+    memcpy(letters, query->letters, sizeof(letters));
+    for(const char* c = key; *c; c++) {
+        if(*c < 'a' || *c > 'z' || letters[*c - 'a']-- == 0) return false;
+    }
+    return true;
+}
+
+// Checks the record behind a signature the word filter let through. Returns
+// false once the scan should stop.
+static bool
+    dictionary_pattern_check(DictionaryPatternScan* scan, uint32_t signature, uint32_t id) {
+    const DictionaryPatternQuery* query = scan->query;
+    DictionaryPatternResults* results = scan->results;
+    if(signature == 0 || (signature & query->select) != query->want ||
+       signature >> DICTIONARY_PATTERN_LENGTH_SHIFT < query->min_length) {
+        return true;
+    }
+    results->candidates++;
+    if(results->count == DICTIONARY_PATTERN_MAX || scan->checks == DICTIONARY_PATTERN_MAX_CHECKS) {
+        results->truncated = true;
+        return false;
+    }
+
+    DictionaryRecord record;
+    scan->checks++;
+    if(!dictionary_read_key(scan->patterns->dict, scan->idx_file, id, &record)) {
+        scan->failed = true;
+        return false;
+    }
+    bool match = query->anagram ? dictionary_pattern_is_anagram(query, record.key) :
+                                  dictionary_pattern_matches(query->text, record.key);
+    if(match) memcpy(results->words[results->count++], record.key, MAX_WORD_LENGTH);
+    return true;
+}
+
+// Runs `count` signatures of records from `first` through the filter, two
+// per 64-bit word: a lane of (signature & select) ^ want is zero where the
+// signature passes, and the borrow trick flags a word with a zero lane.
+// Returns false once the scan should stop.
+static bool dictionary_pattern_filter(
+    DictionaryPatternScan* scan,
+    const uint32_t* signatures,
+    uint32_t first,
+    uint32_t count) {
+    uint64_t select = scan->query->select * DICTIONARY_PATTERN_LANE_LOWS;
+    uint64_t want = scan->query->want * DICTIONARY_PATTERN_LANE_LOWS;
+    uint32_t i = 0;
+    for(; i + 1 < count; i += 2) {
+        uint64_t pair;
+        memcpy(&pair, signatures + i, sizeof(pair));
+        uint64_t lanes = (pair & select) ^ want;
+        uint64_t zero = (lanes - DICTIONARY_PATTERN_LANE_LOWS) & ~lanes;
+        if((zero & DICTIONARY_PATTERN_LANE_HIGHS) == 0) continue;
+        // The flag can be set for the high lane by a borrow from the low
+        // one, so both are checked on their own
+        if(!dictionary_pattern_check(scan, signatures[i], first + i) ||
+           !dictionary_pattern_check(scan, signatures[i + 1], first + i + 1)) {
+            return false;
+        }
+    }
+    return i == count || dictionary_pattern_check(scan, signatures[i], first + i);
+}
+
+DictionaryStatus dictionary_patterns_search(
+    DictionaryPatterns* patterns,
+    const char* query_text,
+    bool anagram,
+    DictionaryPatternResults* results) {
+    memset(results, 0, sizeof(DictionaryPatternResults));
+    DictionaryPatternQuery query;
+    if(!dictionary_pattern_parse(&query, query_text, anagram)) return DictionaryStatusNotFound;
+
+    Dictionary* dict = patterns->dict;
+    DictionaryPatternScan scan = {
+        .patterns = patterns,
+        .idx_file = dictionary_get_index_file(dict),
+        .query = &query,
+        .results = results,
+    };
+    if(!scan.idx_file) return DictionaryStatusNoFiles;
+
+    // Keys are sorted, so letters before the first wildcard narrow the scan
+    // to the keys starting with them
+    uint32_t low = 0;
+    uint32_t high = patterns->count;
+    if(query.prefix_length > 0) {
+        char prefix[MAX_WORD_LENGTH];
+        memcpy(prefix, query.text, query.prefix_length);
+        prefix[query.prefix_length] = '\0';
+        low = dictionary_lower_bound(dict, scan.idx_file, prefix, false, low, high);
+        high = dictionary_lower_bound(dict, scan.idx_file, prefix, true, low, high);
+    }
+
+    if(patterns->signatures) {
+        dictionary_pattern_filter(&scan, patterns->signatures + low, low, high - low);
+    } else {
+        uint32_t* chunk = malloc(DICTIONARY_PATTERN_CHUNK * sizeof(uint32_t));
+        DictionaryStorage* storage = dictionary_get_storage(dict);
+        for(uint32_t first = low; first < high;) {
+            uint32_t count = high - first;
+            if(count > DICTIONARY_PATTERN_CHUNK) count = DICTIONARY_PATTERN_CHUNK;
+            if(!dictionary_storage_read_at(
+                   storage,
+                   scan.idx_file,
+                   patterns->offset + first * sizeof(uint32_t),
+                   chunk,
+                   count * sizeof(uint32_t))) {
+                scan.failed = true;
+                break;
+            }
+            if(!dictionary_pattern_filter(&scan, chunk, first, count)) break;
+            first += count;
+        }
+        free(chunk);
+    }
+    dictionary_check_files(dict);
+
+    if(scan.failed) {
+        memset(results, 0, sizeof(DictionaryPatternResults));
+        return DictionaryStatusReadError;
+    }
+    return results->count > 0 ? DictionaryStatusOk : DictionaryStatusNotFound;
+}
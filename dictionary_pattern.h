@@ -0,0 +1,58 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Crossword patterns ("c?t", "ab*on") and anagrams ("listen" -> "silent",
+// "enlist") over every key. The SIGS section of engdict.idx holds one u32
+// signature per record: the letters the key uses as a 26-bit mask and its
+// length above them. A query turns into the mask and length a match must
+// have, and the signatures are filtered two at a time in 64-bit words; only
+// the few keys that pass are read and checked exactly. Letters before the
+// first wildcard narrow the scan to the keys starting with them.
+//
+// The table is read into RAM once when the budget allows, so a query scans
+// no card at all until the keys that pass; otherwise each query streams the
+// section in chunks. Keys with anything but a-z in them have signature 0 and
+// never match.
+
+// Matches listed per query
+#define DICTIONARY_PATTERN_MAX 8
+// Keys read and checked per query at most; a query whose filter lets more
+// through is cut short
+#define DICTIONARY_PATTERN_MAX_CHECKS 96
+// Signatures per read when the table is not in RAM
+#define DICTIONARY_PATTERN_CHUNK 128
+
+typedef struct {
+    char words[DICTIONARY_PATTERN_MAX][MAX_WORD_LENGTH];
+    uint8_t count; // in key order
+    uint32_t candidates; // keys the signatures let through
+    bool truncated; // the list filled up or the checks ran out before the end
+} DictionaryPatternResults;
+
+typedef struct DictionaryPatterns DictionaryPatterns;
+
+// True if the index has a SIGS section to search
+bool dictionary_patterns_is_available(const Dictionary* dict);
+
+// Signature of a lowercase key as tools/dictc.py writes it (signature())
+uint32_t dictionary_pattern_signature(const char* key);
+
+// Reads the table into RAM if it fits `ram_budget`, else keeps reading it
+// from the card per query. NULL without a SIGS section.
+DictionaryPatterns* dictionary_patterns_alloc(Dictionary* dict, size_t ram_budget);
+
+void dictionary_patterns_free(DictionaryPatterns* patterns);
+
+// Bytes of RAM the table takes, 0 when it stays on the card
+size_t dictionary_patterns_get_size(const DictionaryPatterns* patterns);
+
+// Keys matching `query`: a pattern of letters, '?' for any one letter and '*'
+// for any run of them, or with `anagram` set the words spelt with the same
+// letters (other than the query itself). DictionaryStatusNotFound when
+// nothing matches or the query is not one of those.
+DictionaryStatus dictionary_patterns_search(
+    DictionaryPatterns* patterns,
+    const char* query,
+    bool anagram,
+    DictionaryPatternResults* results);
@@ -0,0 +1,137 @@
+#include "dictionary_result_view.h"
+
+#include <furi.h>
+#include <gui/elements.h>
+
+#define RESULT_VIEW_LINE_TOP    10
+#define RESULT_VIEW_LINE_HEIGHT 12
+
+// The pager lives outside the model: scrolling may read the SD card, which is
+// done without holding the model lock. The model gets a copy of the lines.
+struct DictionaryResultView {
+    View* view;
+    DictionaryPager pager;
+};
+
+typedef struct {
+    char lines[DICTIONARY_PAGER_LINES][DICTIONARY_PAGER_LINE_SIZE];
+    uint8_t line_count;
+    bool scrollable;
+    uint16_t position;
+    uint16_t length;
+} DictionaryResultViewModel;
+
+static void result_view_draw_callback(Canvas* canvas, void* _model) {
+    DictionaryResultViewModel* model = _model;
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    // Monospace, so the pager's column count is the screen width
+    canvas_set_font(canvas, FontKeyboard);
+    for(uint8_t i = 0; i < model->line_count; i++) {
+        canvas_draw_str(
+            canvas, 0, RESULT_VIEW_LINE_TOP + i * RESULT_VIEW_LINE_HEIGHT, model->lines[i]);
+    }
+    if(model->scrollable) {
+        elements_scrollbar_pos(canvas, 128, 0, 64, model->position, model->length);
+    }
+}
+
+static void result_view_update(DictionaryResultView* result_view) {
+    const DictionaryPager* pager = &result_view->pager;
+    uint32_t lines = dictionary_pager_get_line_count(pager);
+    uint32_t length, position;
+    if(lines > 0) {
+        // Laid out ahead: the top line among those that can be on top
+        length = lines > DICTIONARY_PAGER_LINES ? lines - DICTIONARY_PAGER_LINES + 1 : 1;
+        position = pager->top;
+    } else {
+        // Otherwise the raw text position stands in for it
+        length = pager->formatter.source.length;
+        position = pager->at_end && length > 0 ? length - 1 :
+                                                 dictionary_pager_get_position(pager);
+    }
+    with_view_model(
+        result_view->view,
+        DictionaryResultViewModel * model,
+        {
+            memcpy(model->lines, pager->lines, sizeof(model->lines));
+            model->line_count = pager->line_count;
+            model->scrollable = pager->top > 0 || !pager->at_end;
+            // The scrollbar only takes 16-bit values
+            model->length = MIN(length, UINT16_MAX);
+            model->position = MIN(position, model->length);
+        },
+        true);
+}
+
+static bool result_view_input_callback(InputEvent* event, void* context) {
+    DictionaryResultView* result_view = context;
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat) return false;
+
+    int32_t lines;
+    switch(event->key) {
+    case InputKeyUp:
+        lines = -1;
+        break;
+    case InputKeyDown:
+        lines = 1;
+        break;
+    case InputKeyLeft:
+        lines = -DICTIONARY_PAGER_LINES;
+        break;
+    case InputKeyRight:
+        lines = DICTIONARY_PAGER_LINES;
+        break;
+    default:
+        return false;
+    }
+
+    if(!dictionary_pager_scroll(&result_view->pager, lines)) {
+        FURI_LOG_W("Dictionary", "Result text read failed");
+    }
+    result_view_update(result_view);
+    return true;
+}
+
+DictionaryResultView* dictionary_result_view_alloc(void) {
+    DictionaryResultView* result_view = malloc(sizeof(DictionaryResultView));
+    memset(&result_view->pager, 0, sizeof(DictionaryPager));
+    result_view->view = view_alloc();
+    view_set_context(result_view->view, result_view);
+    view_allocate_model(
+        result_view->view, ViewModelTypeLocking, sizeof(DictionaryResultViewModel));
+    view_set_draw_callback(result_view->view, result_view_draw_callback);
+    view_set_input_callback(result_view->view, result_view_input_callback);
+    with_view_model(
+        result_view->view,
+        DictionaryResultViewModel * model,
+        { memset(model, 0, sizeof(DictionaryResultViewModel)); },
+        false);
+    return result_view;
+}
+
+void dictionary_result_view_free(DictionaryResultView* result_view) {
+    furi_assert(result_view);
+    view_free(result_view->view);
+    free(result_view);
+}
+
+View* dictionary_result_view_get_view(DictionaryResultView* result_view) {
+    return result_view->view;
+}
+
+bool dictionary_result_view_set_source(
+    DictionaryResultView* result_view,
+    const DictionaryTextSource* source,
+    const char* word) {
+    bool read_ok = dictionary_pager_init(&result_view->pager, source, word);
+    result_view_update(result_view);
+    return read_ok;
+}
+
+void dictionary_result_view_set_loading(DictionaryResultView* result_view) {
+    static const char loading[] = "Loading...";
+    DictionaryTextSource source;
+    dictionary_text_source_init_memory(&source, loading, sizeof(loading) - 1);
+    dictionary_result_view_set_source(result_view, &source, NULL);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <gui/view.h>
+
+#include "dictionary_pager.h"
+
+// Scrolling result screen. The entry is formatted and wrapped a line at a
+// time (dictionary_pager.h) as the user scrolls, so a long definition can be
+// shown straight from engdict.dat without holding it in RAM. Up and Down move
+// a line, Left and Right a page.
+
+typedef struct DictionaryResultView DictionaryResultView;
+
+DictionaryResultView* dictionary_result_view_alloc(void);
+
+void dictionary_result_view_free(DictionaryResultView* result_view);
+
+View* dictionary_result_view_get_view(DictionaryResultView* result_view);
+
+// Shows `source` from the top, formatted as the entry for `word` or as it is
+// when `word` is NULL. The source's context must stay valid while it is
+// shown. Returns false if reading it failed.
+bool dictionary_result_view_set_source(
+    DictionaryResultView* result_view,
+    const DictionaryTextSource* source,
+    const char* word);
+
+// Shows a placeholder while the entry is looked up
+void dictionary_result_view_set_loading(DictionaryResultView* result_view);
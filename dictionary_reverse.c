@@ -0,0 +1,347 @@
+#include "dictionary_reverse.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DICTIONARY_TERM_HEAD_SIZE 16
+#define DICTIONARY_TERM_ENTRY_WORDS 3 // u32 hash, u32 postings offset, u32 count
+// Bucket entries read at a time; buckets average 4
+#define DICTIONARY_TERM_ENTRY_CHUNK 8
+
+// Same list as STOPWORDS in tools/dictc.py, sorted
+static const char* const dictionary_reverse_stopwords[] = {
+    "an",   "and",   "any",   "are",   "as",    "at",   "be",    "but",  "by",   "for",
+    "from", "has",   "have",  "how",   "in",    "into", "is",    "it",   "its",  "not",
+    "of",   "on",    "or",    "so",    "such",  "than", "that",  "the",  "their", "them",
+    "then", "there", "these", "this",  "those", "to",   "was",   "were", "what", "when",
+    "where", "which", "who",  "whom",  "whose", "why",  "with",
+};
+
+#define DICTIONARY_REVERSE_STOPWORD_COUNT \
+    (sizeof(dictionary_reverse_stopwords) / sizeof(dictionary_reverse_stopwords[0]))
+
+// One term's posting list, decoded as the merge advances
+typedef struct {
+    uint32_t offset; // next byte to read, from the start of the postings
+    uint32_t end;
+    uint32_t count;
+    uint8_t weight; // per posting, higher for rarer terms
+    uint8_t buffer[DICTIONARY_REVERSE_CHUNK];
+    uint16_t pos, fill;
+    uint32_t id; // current posting, UINT32_MAX once the list has ended
+    uint8_t sense; // first sense of the current entry using the term, up to 3
+} DictionaryReverseCursor;
+
+typedef struct {
+    Dictionary* dict;
+    DictionaryFile* idx_file;
+    uint32_t bucket_count;
+    uint32_t term_count;
+    uint32_t postings_size;
+    uint32_t directory_offset;
+    uint32_t entries_offset;
+    uint32_t postings_offset;
+    bool failed;
+    DictionaryReverseCursor cursors[DICTIONARY_REVERSE_MAX_TERMS];
+    uint8_t cursor_count;
+    // Best entries so far, by rank
+    uint32_t best_ids[DICTIONARY_REVERSE_MAX];
+    uint32_t best_ranks[DICTIONARY_REVERSE_MAX];
+    uint8_t best_count;
+} DictionaryReverseQuery;
+
+static bool dictionary_reverse_is_stopword(const char* word) {
+    for(size_t i = 0; i < DICTIONARY_REVERSE_STOPWORD_COUNT; i++) {
+        if(strcmp(word, dictionary_reverse_stopwords[i]) == 0) return true;
+    }
+    return false;
+}
+
+static bool dictionary_reverse_ends_with(const char* word, size_t length, const char* suffix) {
+    size_t suffix_length = strlen(suffix);
+    return length >= suffix_length &&
+           memcmp(word + length - suffix_length, suffix, suffix_length) == 0;
+}
+
+static bool dictionary_reverse_has_vowel(const char* word, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        if(strchr("aeiouy", word[i])) return true;
+    }
+    return false;
+}
+
+static size_t dictionary_reverse_undouble(const char* word, size_t length) {
+    if(length >= 2 && word[length - 1] == word[length - 2] && !strchr("lsz", word[length - 1])) {
+        return length - 1;
+    }
+    return length;
+}
+
+size_t dictionary_reverse_stem(char* word, size_t length) {
+    if(dictionary_reverse_ends_with(word, length, "sses")) {
+        length -= 2;
+    } else if(dictionary_reverse_ends_with(word, length, "ies") && length > 4) {
+        length -= 2;
+        word[length - 1] = 'y';
+    } else if(
+        dictionary_reverse_ends_with(word, length, "s") &&
+        !dictionary_reverse_ends_with(word, length, "ss") &&
+        !dictionary_reverse_ends_with(word, length, "us") &&
+        !dictionary_reverse_ends_with(word, length, "is") && length > 3) {
+        length--;
+    }
+
+    if(dictionary_reverse_ends_with(word, length, "ing") && length > 5 &&
+       dictionary_reverse_has_vowel(word, length - 3)) {
+        length = dictionary_reverse_undouble(word, length - 3);
+    } else if(
+        dictionary_reverse_ends_with(word, length, "ed") && length > 4 &&
+        dictionary_reverse_has_vowel(word, length - 2)) {
+        length = dictionary_reverse_undouble(word, length - 2);
+    } else if(dictionary_reverse_ends_with(word, length, "ly") && length > 5) {
+        length -= 2;
+    }
+
+    if(dictionary_reverse_ends_with(word, length, "e") && length > 3) length--;
+    word[length] = '\0';
+    return length;
+}
+
+static bool dictionary_reverse_open(DictionaryReverseQuery* query) {
+    const DictionaryIndexInfo* info = dictionary_get_index_info(query->dict);
+    if(!info->terms_offset) return false;
+
+    uint32_t head[DICTIONARY_TERM_HEAD_SIZE / 4];
+    if(!dictionary_storage_read_at(
+           dictionary_get_storage(query->dict),
+           query->idx_file,
+           info->terms_offset,
+           head,
+           sizeof(head))) {
+        return false;
+    }
+    query->bucket_count = head[0];
+    query->term_count = head[1];
+    query->postings_size = head[2];
+    if(query->bucket_count == 0) return false;
+
+    query->directory_offset = info->terms_offset + DICTIONARY_TERM_HEAD_SIZE;
+    query->entries_offset = query->directory_offset + (query->bucket_count + 1) * 4;
+    query->postings_offset =
+        query->entries_offset + query->term_count * DICTIONARY_TERM_ENTRY_WORDS * 4;
+    return true;
+}
+
+// Finds the posting list of `term`; a term that is not indexed gets an empty
+// one. False if reading failed.
+static bool dictionary_reverse_find_term(
+    DictionaryReverseQuery* query,
+    const char* term,
+    size_t length,
+    DictionaryReverseCursor* cursor) {
+    memset(cursor, 0, sizeof(DictionaryReverseCursor));
+    cursor->id = UINT32_MAX;
+
+    DictionaryStorage* storage = dictionary_get_storage(query->dict);
+    uint32_t hash = dictionary_fnv1a(term, length, DICTIONARY_FNV1A_BASIS);
+    uint32_t range[2];
+    if(!dictionary_storage_read_at(
+           storage,
+           query->idx_file,
+           query->directory_offset + (hash % query->bucket_count) * 4,
+           range,
+           sizeof(range)) ||
+       range[1] < range[0] || range[1] > query->term_count) {
+        return false;
+    }
+
+    // One entry past the chunk gives the end of the last list in it
+    uint32_t entries[(DICTIONARY_TERM_ENTRY_CHUNK + 1) * DICTIONARY_TERM_ENTRY_WORDS];
+    for(uint32_t first = range[0]; first < range[1]; first += DICTIONARY_TERM_ENTRY_CHUNK) {
+        uint32_t count = range[1] - first < DICTIONARY_TERM_ENTRY_CHUNK ?
+                             range[1] - first :
+                             DICTIONARY_TERM_ENTRY_CHUNK;
+        uint32_t read = first + count < query->term_count ? count + 1 : count;
+        if(!dictionary_storage_read_at(
+               storage,
+               query->idx_file,
+               query->entries_offset + first * DICTIONARY_TERM_ENTRY_WORDS * 4,
+               entries,
+               read * DICTIONARY_TERM_ENTRY_WORDS * 4)) {
+            return false;
+        }
+        for(uint32_t i = 0; i < count; i++) {
+            const uint32_t* entry = entries + i * DICTIONARY_TERM_ENTRY_WORDS;
+            if(entry[0] > hash) return true; // sorted by hash
+            if(entry[0] != hash) continue;
+            cursor->offset = entry[1];
+            cursor->end = i + 1 < read ? entry[DICTIONARY_TERM_ENTRY_WORDS + 1] :
+                                         query->postings_size;
+            cursor->count = entry[2];
+            return cursor->offset <= cursor->end && cursor->end <= query->postings_size;
+        }
+    }
+    return true;
+}
+
+// Moves the cursor to its next posting, refilling its buffer from the card
+static void
+    dictionary_reverse_advance(DictionaryReverseQuery* query, DictionaryReverseCursor* cursor) {
+    uint32_t value = 0;
+    for(uint8_t shift = 0;; shift += 7) {
+        if(cursor->pos == cursor->fill) {
+            uint32_t left = cursor->end - cursor->offset;
+            uint16_t size = left < DICTIONARY_REVERSE_CHUNK ? left : DICTIONARY_REVERSE_CHUNK;
+            if(size == 0 || shift > 28 ||
+               !dictionary_storage_read_at(
+                   dictionary_get_storage(query->dict),
+                   query->idx_file,
+                   query->postings_offset + cursor->offset,
+                   cursor->buffer,
+                   size)) {
+                // The end of the list, unless it ends mid-posting
+                query->failed |= size > 0 || shift > 0;
+                cursor->id = UINT32_MAX;
+                return;
+            }
+            cursor->offset += size;
+            cursor->pos = 0;
+            cursor->fill = size;
+        }
+        uint8_t byte = cursor->buffer[cursor->pos++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) break;
+    }
+    // Gaps are at least one; the first id follows a virtual -1
+    cursor->id += (value >> 2) + 1;
+    cursor->sense = value & 3;
+}
+
+// Keeps the entry if it ranks among the best so far; equal ranks keep the
+// entry found first, i.e. in key order
+static void dictionary_reverse_rank(DictionaryReverseQuery* query, uint32_t id, uint32_t rank) {
+    uint8_t pos = query->best_count;
+    while(pos > 0 && query->best_ranks[pos - 1] < rank) {
+        pos--;
+    }
+    if(pos >= DICTIONARY_REVERSE_MAX) return;
+    uint8_t last = query->best_count < DICTIONARY_REVERSE_MAX ? query->best_count :
+                                                                DICTIONARY_REVERSE_MAX - 1;
+    memmove(&query->best_ids[pos + 1], &query->best_ids[pos], (last - pos) * sizeof(uint32_t));
+    memmove(
+        &query->best_ranks[pos + 1], &query->best_ranks[pos], (last - pos) * sizeof(uint32_t));
+    query->best_ids[pos] = id;
+    query->best_ranks[pos] = rank;
+    if(query->best_count < DICTIONARY_REVERSE_MAX) query->best_count++;
+}
+
+// Walks all posting lists at once in id order, scoring each entry by the
+// terms it uses
+static uint32_t dictionary_reverse_merge(DictionaryReverseQuery* query) {
+    uint32_t record_count = dictionary_get_record_count(query->dict);
+    for(uint8_t t = 0; t < query->cursor_count; t++) {
+        DictionaryReverseCursor* cursor = &query->cursors[t];
+        // About log2 of the inverse document frequency
+        cursor->weight = 1;
+        while(cursor->count > 0 && ((uint64_t)cursor->count << cursor->weight) <= record_count) {
+            cursor->weight++;
+        }
+        if(cursor->offset < cursor->end) dictionary_reverse_advance(query, cursor);
+    }
+
+    uint32_t matches = 0;
+    for(;;) {
+        uint32_t id = UINT32_MAX;
+        for(uint8_t t = 0; t < query->cursor_count; t++) {
+            if(query->cursors[t].id < id) id = query->cursors[t].id;
+        }
+        if(id == UINT32_MAX || query->failed) break;
+
+        uint32_t terms = 0, score = 0;
+        for(uint8_t t = 0; t < query->cursor_count; t++) {
+            DictionaryReverseCursor* cursor = &query->cursors[t];
+            if(cursor->id != id) continue;
+            terms++;
+            score += cursor->weight * (4 - cursor->sense);
+            dictionary_reverse_advance(query, cursor);
+        }
+        if(terms == query->cursor_count) matches++;
+        // Every term used beats any score
+        dictionary_reverse_rank(query, id, terms << 16 | score);
+    }
+    return matches;
+}
+
+bool dictionary_reverse_is_available(const Dictionary* dict) {
+    return dictionary_get_index_info(dict)->terms_offset != 0;
+}
+
+DictionaryStatus dictionary_reverse_search(
+    Dictionary* dict,
+    const char* query_text,
+    DictionaryReverseResults* results) {
+    memset(results, 0, sizeof(DictionaryReverseResults));
+    DictionaryReverseQuery* query = malloc(sizeof(DictionaryReverseQuery));
+    memset(query, 0, sizeof(DictionaryReverseQuery));
+    query->dict = dict;
+    query->idx_file = dictionary_get_index_file(dict);
+
+    DictionaryStatus status = DictionaryStatusNotFound;
+    if(!query->idx_file) {
+        status = DictionaryStatusNoFiles;
+    } else if(dictionary_reverse_open(query)) {
+        // Words are runs of ASCII letters, as when the index was built
+        char terms[DICTIONARY_REVERSE_MAX_TERMS][DICTIONARY_REVERSE_TERM_LENGTH + 1];
+        const char* c = query_text;
+        while(*c && query->cursor_count < DICTIONARY_REVERSE_MAX_TERMS && !query->failed) {
+            if(!isalpha((unsigned char)*c)) {
+                c++;
+                continue;
+            }
+            char word[DICTIONARY_REVERSE_TERM_LENGTH + 2];
+            size_t length = 0;
+            for(; isalpha((unsigned char)*c); c++) {
+                if(length <= DICTIONARY_REVERSE_TERM_LENGTH) {
+                    word[length++] = tolower((unsigned char)*c);
+                }
+            }
+            word[length] = '\0';
+            if(length < 2 || length > DICTIONARY_REVERSE_TERM_LENGTH ||
+               dictionary_reverse_is_stopword(word)) {
+                continue;
+            }
+            length = dictionary_reverse_stem(word, length);
+            bool repeated = false;
+            for(uint8_t t = 0; t < query->cursor_count; t++) {
+                repeated |= strcmp(terms[t], word) == 0;
+            }
+            if(repeated) continue;
+
+            memcpy(terms[query->cursor_count], word, length + 1);
+            query->failed |= !dictionary_reverse_find_term(
+                query, word, length, &query->cursors[query->cursor_count]);
+            query->cursor_count++;
+        }
+
+        results->terms = query->cursor_count;
+        if(query->cursor_count > 0) results->matches = dictionary_reverse_merge(query);
+        for(uint8_t i = 0; i < query->best_count && !query->failed; i++) {
+            DictionaryRecord record;
+            if(!dictionary_read_key(dict, query->idx_file, query->best_ids[i], &record)) {
+                query->failed = true;
+                break;
+            }
+            memcpy(results->words[results->count++], record.key, MAX_WORD_LENGTH);
+        }
+        if(query->failed) {
+            memset(results, 0, sizeof(DictionaryReverseResults));
+            status = DictionaryStatusReadError;
+        } else if(results->count > 0) {
+            status = DictionaryStatusOk;
+        }
+    }
+    dictionary_check_files(dict);
+    free(query);
+    return status;
+}
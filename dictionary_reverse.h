@@ -0,0 +1,43 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Reverse lookup: the headwords whose definitions use every word of a query.
+// The TERM section of engdict.idx maps each stemmed definition word to the
+// sorted ids of the records using it, delta and varint coded. A query hashes
+// its terms to their entries, then merges their posting lists in one pass,
+// each read sequentially through a small buffer; the definitions themselves
+// are never read.
+//
+// Entries matching every term rank first, by the summed weight of the terms:
+// rarer terms weigh more, and more again when they appear in the entry's
+// first senses. Entries missing some terms follow, so a query that is too
+// specific still lists the closest entries.
+
+#define DICTIONARY_REVERSE_MAX 6
+#define DICTIONARY_REVERSE_MAX_TERMS 4
+// Longer words are not indexed (TERM_MAX_LENGTH in tools/dictc.py)
+#define DICTIONARY_REVERSE_TERM_LENGTH 24
+// Bytes of posting list read at a time, per term
+#define DICTIONARY_REVERSE_CHUNK 256
+
+typedef struct {
+    char words[DICTIONARY_REVERSE_MAX][MAX_WORD_LENGTH];
+    uint8_t count; // best first
+    uint8_t terms; // query words looked up, without stopwords and repeats
+    uint32_t matches; // entries using every term
+} DictionaryReverseResults;
+
+// Reduces a lowercase word to its index term in place, the way the index
+// was built (stem() in tools/dictc.py); returns its new length
+size_t dictionary_reverse_stem(char* word, size_t length);
+
+// True if the index has a TERM section to search
+bool dictionary_reverse_is_available(const Dictionary* dict);
+
+// DictionaryStatusNotFound when no entry uses any query term or the index
+// has no TERM section
+DictionaryStatus dictionary_reverse_search(
+    Dictionary* dict,
+    const char* query,
+    DictionaryReverseResults* results);
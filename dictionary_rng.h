@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+// xoshiro128** (Blackman & Vigna): small, fast and far better distributed
+// than newlib's rand(). The app seeds it once from the hardware RNG.
+
+typedef struct {
+    uint32_t s[4];
+} DictionaryRng;
+
+static inline uint32_t dictionary_rng_rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t dictionary_rng_next(DictionaryRng* rng) {
+    uint32_t* s = rng->s;
+    uint32_t result = dictionary_rng_rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = dictionary_rng_rotl(s[3], 11);
+    return result;
+}
+
+// Expands `seed` with splitmix64 so any value, including 0, gives a usable state
+static inline void dictionary_rng_seed(DictionaryRng* rng, uint64_t seed) {
+    for(int i = 0; i < 4; i += 2) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        rng->s[i] = (uint32_t)z;
+        rng->s[i + 1] = (uint32_t)(z >> 32);
+    }
+}
+
+// Uniform in [0, bound) without modulo bias (Lemire's method)
+static inline uint32_t dictionary_rng_below(DictionaryRng* rng, uint32_t bound) {
+    uint64_t m = (uint64_t)dictionary_rng_next(rng) * bound;
+    if((uint32_t)m < bound) {
+        uint32_t threshold = -bound % bound;
+        while((uint32_t)m < threshold) {
+            m = (uint64_t)dictionary_rng_next(rng) * bound;
+        }
+    }
+    return m >> 32;
+}
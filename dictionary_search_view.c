@@ -0,0 +1,379 @@
+#include "dictionary_search_view.h"
+
+#include <furi.h>
+#include <gui/elements.h>
+#include <stdio.h>
+
+#define SEARCH_VIEW_BACKSPACE '\b'
+#define SEARCH_VIEW_ENTER     '\n'
+#define SEARCH_VIEW_SPACE     ' '
+#define SEARCH_VIEW_WIDTH     128
+
+#define SEARCH_VIEW_LIST_ROWS  2
+#define SEARCH_VIEW_LIST_TOP   13
+#define SEARCH_VIEW_ROW_HEIGHT 9
+#define SEARCH_VIEW_KEYS_TOP   32
+#define SEARCH_VIEW_KEY_WIDTH  12
+#define SEARCH_VIEW_KEY_HEIGHT 10
+// Room left of the match count for the typed text
+#define SEARCH_VIEW_TEXT_WIDTH 100
+
+static const char* const search_view_rows[] = {
+    "qwertyuiop",
+    "asdfghjkl",
+    "zxcvbnm\b\n",
+};
+
+// Phrases have a space key after the 'l'
+static const char* const search_view_phrase_rows[] = {
+    "qwertyuiop",
+    "asdfghjkl ",
+    "zxcvbnm\b\n",
+};
+
+// Patterns have '?' after the 'l' and '*' after the 'm'
+static const char* const search_view_pattern_rows[] = {
+    "qwertyuiop",
+    "asdfghjkl?",
+    "zxcvbnm*\b\n",
+};
+
+#define SEARCH_VIEW_ROW_COUNT ((uint8_t)COUNT_OF(search_view_rows))
+
+struct DictionarySearchView {
+    View* view;
+    DictionarySearchViewChangedCallback changed_callback;
+    DictionarySearchViewDoneCallback done_callback;
+    void* context;
+};
+
+typedef struct {
+    char text[MAX_WORD_LENGTH];
+    DictionaryCompletions completions;
+    uint8_t row;
+    uint8_t column;
+    bool in_list; // focus is on the completions instead of the keyboard
+    uint8_t list_index;
+    DictionarySearchViewMode mode;
+    const char* hint; // outside word mode
+} DictionarySearchViewModel;
+
+static const char* search_view_row_keys(DictionarySearchViewModel* model, uint8_t row) {
+    switch(model->mode) {
+    case DictionarySearchViewModePhrase:
+        return search_view_phrase_rows[row];
+    case DictionarySearchViewModePattern:
+        return search_view_pattern_rows[row];
+    default:
+        return search_view_rows[row];
+    }
+}
+
+static uint8_t search_view_row_length(DictionarySearchViewModel* model, uint8_t row) {
+    return (uint8_t)strlen(search_view_row_keys(model, row));
+}
+
+static void search_view_draw_text(Canvas* canvas, DictionarySearchViewModel* model) {
+    canvas_draw_frame(canvas, 0, 0, 128, 12);
+
+    // Show the tail of the text when it does not fit
+    char line[MAX_WORD_LENGTH + 1];
+    snprintf(line, sizeof(line), "%s_", model->text);
+    const char* visible = line;
+    while(visible[1] && canvas_string_width(canvas, visible) > SEARCH_VIEW_TEXT_WIDTH) {
+        visible++;
+    }
+    canvas_draw_str(canvas, 2, 9, visible);
+
+    if(model->text[0] && model->mode == DictionarySearchViewModeWord) {
+        char matches[12];
+        snprintf(matches, sizeof(matches), "%lu", (unsigned long)model->completions.matches);
+        canvas_draw_str_aligned(canvas, 126, 2, AlignRight, AlignTop, matches);
+    }
+}
+
+static void search_view_draw_list(Canvas* canvas, DictionarySearchViewModel* model) {
+    const DictionaryCompletions* completions = &model->completions;
+    if(model->mode != DictionarySearchViewModeWord) {
+        if(model->hint) canvas_draw_str(canvas, 2, SEARCH_VIEW_LIST_TOP + 7, model->hint);
+        return;
+    }
+    if(completions->count == 0) {
+        if(model->text[0]) canvas_draw_str(canvas, 2, SEARCH_VIEW_LIST_TOP + 7, "No matches");
+        return;
+    }
+
+    uint8_t first = 0;
+    if(model->list_index >= SEARCH_VIEW_LIST_ROWS) {
+        first = model->list_index - SEARCH_VIEW_LIST_ROWS + 1;
+    }
+    for(uint8_t i = 0; i < SEARCH_VIEW_LIST_ROWS && first + i < completions->count; i++) {
+        int32_t y = SEARCH_VIEW_LIST_TOP + i * SEARCH_VIEW_ROW_HEIGHT;
+        bool selected = model->in_list && first + i == model->list_index;
+        if(selected) {
+            canvas_draw_box(canvas, 0, y, 124, SEARCH_VIEW_ROW_HEIGHT);
+            canvas_set_color(canvas, ColorWhite);
+        }
+        canvas_draw_str(canvas, 2, y + 7, completions->words[first + i]);
+        canvas_set_color(canvas, ColorBlack);
+    }
+    if(completions->count > SEARCH_VIEW_LIST_ROWS) {
+        elements_scrollbar_pos(
+            canvas,
+            127,
+            SEARCH_VIEW_LIST_TOP,
+            SEARCH_VIEW_LIST_ROWS * SEARCH_VIEW_ROW_HEIGHT,
+            model->list_index,
+            completions->count);
+    }
+}
+
+static void search_view_draw_keyboard(Canvas* canvas, DictionarySearchViewModel* model) {
+    canvas_set_font(canvas, FontKeyboard);
+    for(uint8_t row = 0; row < SEARCH_VIEW_ROW_COUNT; row++) {
+        const char* keys = search_view_row_keys(model, row);
+        int32_t y = SEARCH_VIEW_KEYS_TOP + row * SEARCH_VIEW_KEY_HEIGHT;
+        // Rows are staggered by half a key unless that pushes the last key
+        // off the screen
+        int32_t row_width = strlen(keys) * SEARCH_VIEW_KEY_WIDTH;
+        if(strchr(keys, SEARCH_VIEW_ENTER)) row_width += 4;
+        int32_t x = MIN(4 + row * SEARCH_VIEW_KEY_WIDTH / 2, SEARCH_VIEW_WIDTH - row_width);
+        for(uint8_t column = 0; keys[column]; column++, x += SEARCH_VIEW_KEY_WIDTH) {
+            bool selected = !model->in_list && row == model->row && column == model->column;
+            char label[3] = {keys[column], '\0', '\0'};
+            int32_t width = SEARCH_VIEW_KEY_WIDTH;
+            if(keys[column] == SEARCH_VIEW_SPACE) {
+                label[0] = '_';
+            } else if(keys[column] == SEARCH_VIEW_BACKSPACE) {
+                label[0] = '<';
+            } else if(keys[column] == SEARCH_VIEW_ENTER) {
+                label[0] = 'O';
+                label[1] = 'K';
+                width = SEARCH_VIEW_KEY_WIDTH + 4;
+            }
+            if(selected) {
+                canvas_draw_box(canvas, x - 1, y, width - 1, SEARCH_VIEW_KEY_HEIGHT);
+                canvas_set_color(canvas, ColorWhite);
+            }
+            canvas_draw_str_aligned(
+                canvas, x + (width - 2) / 2, y + 1, AlignCenter, AlignTop, label);
+            canvas_set_color(canvas, ColorBlack);
+        }
+    }
+}
+
+static void search_view_draw_callback(Canvas* canvas, void* _model) {
+    DictionarySearchViewModel* model = _model;
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+    search_view_draw_text(canvas, model);
+    search_view_draw_list(canvas, model);
+    search_view_draw_keyboard(canvas, model);
+}
+
+typedef enum {
+    SearchViewActionNone,
+    SearchViewActionChanged,
+    SearchViewActionDone,
+} SearchViewAction;
+
+static SearchViewAction search_view_press_key(DictionarySearchViewModel* model) {
+    char key = search_view_row_keys(model, model->row)[model->column];
+    size_t len = strlen(model->text);
+    if(key == SEARCH_VIEW_ENTER) {
+        return len > 0 ? SearchViewActionDone : SearchViewActionNone;
+    }
+    if(key == SEARCH_VIEW_BACKSPACE) {
+        if(len == 0) return SearchViewActionNone;
+        model->text[len - 1] = '\0';
+        return SearchViewActionChanged;
+    }
+    if(len >= MAX_WORD_LENGTH - 1) return SearchViewActionNone;
+    // Words are separated by single spaces
+    if(key == SEARCH_VIEW_SPACE && (len == 0 || model->text[len - 1] == SEARCH_VIEW_SPACE)) {
+        return SearchViewActionNone;
+    }
+    model->text[len] = key;
+    model->text[len + 1] = '\0';
+    return SearchViewActionChanged;
+}
+
+static SearchViewAction
+    search_view_handle_keyboard(DictionarySearchViewModel* model, InputKey key) {
+    switch(key) {
+    case InputKeyUp:
+        if(model->row > 0) {
+            model->row--;
+            model->column = MIN(model->column, search_view_row_length(model, model->row) - 1);
+        } else if(model->completions.count > 0) {
+            model->in_list = true;
+            model->list_index = 0;
+        }
+        return SearchViewActionNone;
+    case InputKeyDown:
+        if(model->row + 1 < SEARCH_VIEW_ROW_COUNT) {
+            model->row++;
+            model->column = MIN(model->column, search_view_row_length(model, model->row) - 1);
+        }
+        return SearchViewActionNone;
+    case InputKeyLeft:
+        model->column = model->column > 0 ? model->column - 1 :
+                                            search_view_row_length(model, model->row) - 1;
+        return SearchViewActionNone;
+    case InputKeyRight:
+        model->column = (model->column + 1) % search_view_row_length(model, model->row);
+        return SearchViewActionNone;
+    case InputKeyOk:
+        return search_view_press_key(model);
+    default:
+        return SearchViewActionNone;
+    }
+}
+
+static SearchViewAction search_view_handle_list(DictionarySearchViewModel* model, InputKey key) {
+    const DictionaryCompletions* completions = &model->completions;
+    switch(key) {
+    case InputKeyUp:
+        if(model->list_index > 0) model->list_index--;
+        return SearchViewActionNone;
+    case InputKeyDown:
+        if(model->list_index + 1 < completions->count) {
+            model->list_index++;
+        } else {
+            model->in_list = false;
+            model->row = 0;
+        }
+        return SearchViewActionNone;
+    case InputKeyRight:
+        // Take the completion as the new prefix and keep typing
+        memcpy(model->text, completions->words[model->list_index], MAX_WORD_LENGTH);
+        model->in_list = false;
+        return SearchViewActionChanged;
+    case InputKeyOk:
+        memcpy(model->text, completions->words[model->list_index], MAX_WORD_LENGTH);
+        return SearchViewActionDone;
+    case InputKeyBack:
+        model->in_list = false;
+        return SearchViewActionNone;
+    default:
+        return SearchViewActionNone;
+    }
+}
+
+static bool search_view_input_callback(InputEvent* event, void* context) {
+    DictionarySearchView* search_view = context;
+    if(event->type != InputTypeShort && event->type != InputTypeRepeat &&
+       event->type != InputTypeLong) {
+        return false;
+    }
+
+    bool consumed = true;
+    SearchViewAction action = SearchViewActionNone;
+    char text[MAX_WORD_LENGTH];
+    with_view_model(
+        search_view->view,
+        DictionarySearchViewModel * model,
+        {
+            if(event->key == InputKeyBack && !model->in_list) {
+                // Back deletes; on an empty line it leaves the view. Long Back clears.
+                if(model->text[0] == '\0') {
+                    consumed = false;
+                } else if(event->type == InputTypeLong) {
+                    model->text[0] = '\0';
+                    action = SearchViewActionChanged;
+                } else if(event->type == InputTypeShort) {
+                    model->text[strlen(model->text) - 1] = '\0';
+                    action = SearchViewActionChanged;
+                }
+            } else if(event->type != InputTypeLong) {
+                action = model->in_list ? search_view_handle_list(model, event->key) :
+                                          search_view_handle_keyboard(model, event->key);
+            }
+            memcpy(text, model->text, MAX_WORD_LENGTH);
+        },
+        true);
+
+    // Outside the model lock: the changed callback sets the completions
+    if(action == SearchViewActionChanged && search_view->changed_callback) {
+        search_view->changed_callback(search_view->context, text);
+    } else if(action == SearchViewActionDone && search_view->done_callback) {
+        search_view->done_callback(search_view->context, text);
+    }
+    return consumed;
+}
+
+DictionarySearchView* dictionary_search_view_alloc(void) {
+    DictionarySearchView* search_view = malloc(sizeof(DictionarySearchView));
+    search_view->changed_callback = NULL;
+    search_view->done_callback = NULL;
+    search_view->context = NULL;
+    search_view->view = view_alloc();
+    view_set_context(search_view->view, search_view);
+    view_allocate_model(
+        search_view->view, ViewModelTypeLocking, sizeof(DictionarySearchViewModel));
+    view_set_draw_callback(search_view->view, search_view_draw_callback);
+    view_set_input_callback(search_view->view, search_view_input_callback);
+    dictionary_search_view_reset(search_view);
+    return search_view;
+}
+
+void dictionary_search_view_free(DictionarySearchView* search_view) {
+    furi_assert(search_view);
+    view_free(search_view->view);
+    free(search_view);
+}
+
+View* dictionary_search_view_get_view(DictionarySearchView* search_view) {
+    return search_view->view;
+}
+
+void dictionary_search_view_set_callbacks(
+    DictionarySearchView* search_view,
+    DictionarySearchViewChangedCallback changed_callback,
+    DictionarySearchViewDoneCallback done_callback,
+    void* context) {
+    search_view->changed_callback = changed_callback;
+    search_view->done_callback = done_callback;
+    search_view->context = context;
+}
+
+void dictionary_search_view_reset(DictionarySearchView* search_view) {
+    with_view_model(
+        search_view->view,
+        DictionarySearchViewModel * model,
+        { memset(model, 0, sizeof(DictionarySearchViewModel)); },
+        true);
+}
+
+void dictionary_search_view_set_mode(
+    DictionarySearchView* search_view,
+    DictionarySearchViewMode mode,
+    const char* hint) {
+    with_view_model(
+        search_view->view,
+        DictionarySearchViewModel * model,
+        {
+            model->mode = mode;
+            model->hint = hint;
+        },
+        true);
+}
+
+void dictionary_search_view_set_completions(
+    DictionarySearchView* search_view,
+    const DictionaryCompletions* completions) {
+    with_view_model(
+        search_view->view,
+        DictionarySearchViewModel * model,
+        {
+            model->completions = *completions;
+            if(model->completions.count == 0) {
+                model->in_list = false;
+                model->list_index = 0;
+            } else if(model->list_index >= model->completions.count) {
+                model->list_index = model->completions.count - 1;
+            }
+        },
+        true);
+}
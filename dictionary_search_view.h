@@ -0,0 +1,54 @@
+#pragma once
+
+#include <gui/view.h>
+
+#include "dictionary_complete.h"
+
+// Search input with live completions: the typed prefix on top, the matching
+// headwords below it and a lowercase keyboard at the bottom. Unlike TextInput
+// it reports every change, so the app can refresh the completions as the
+// user types. The other modes have no completions: phrase mode takes several
+// words, with a space key, pattern mode adds '?' and '*' keys for crossword
+// patterns and letters mode takes a single word as it is.
+
+typedef enum {
+    DictionarySearchViewModeWord,
+    DictionarySearchViewModePhrase,
+    DictionarySearchViewModePattern,
+    DictionarySearchViewModeLetters,
+} DictionarySearchViewMode;
+
+typedef struct DictionarySearchView DictionarySearchView;
+
+// Called after each edit with the current text
+typedef void (*DictionarySearchViewChangedCallback)(void* context, const char* text);
+
+// Called when the user submits the text or picks a completion
+typedef void (*DictionarySearchViewDoneCallback)(void* context, const char* text);
+
+DictionarySearchView* dictionary_search_view_alloc(void);
+
+void dictionary_search_view_free(DictionarySearchView* search_view);
+
+View* dictionary_search_view_get_view(DictionarySearchView* search_view);
+
+void dictionary_search_view_set_callbacks(
+    DictionarySearchView* search_view,
+    DictionarySearchViewChangedCallback changed_callback,
+    DictionarySearchViewDoneCallback done_callback,
+    void* context);
+
+// Clears the text and completions and puts the cursor back on the keyboard,
+// in word mode
+void dictionary_search_view_reset(DictionarySearchView* search_view);
+
+// Switches mode after a reset; outside word mode `hint` is shown where the
+// completions would be
+void dictionary_search_view_set_mode(
+    DictionarySearchView* search_view,
+    DictionarySearchViewMode mode,
+    const char* hint);
+
+void dictionary_search_view_set_completions(
+    DictionarySearchView* search_view,
+    const DictionaryCompletions* completions);
@@ -0,0 +1,183 @@
+#include "dictionary_sound.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#define DICTIONARY_SOUND_HEAD_SIZE 16
+
+static bool dictionary_sound_is_vowel(char c) {
+    return c != '\0' && strchr("aeiou", c) != NULL;
+}
+
+static bool dictionary_sound_is_front(char c) {
+    return c == 'e' || c == 'i' || c == 'y';
+}
+
+size_t dictionary_sound_encode(const char* word, char* code) {
+    char w[MAX_WORD_LENGTH];
+    size_t len = strlen(word);
+    if(len == 0 || len >= MAX_WORD_LENGTH) return 0;
+    for(size_t i = 0; i <= len; i++) {
+        w[i] = tolower((unsigned char)word[i]);
+        if(i < len && (w[i] < 'a' || w[i] > 'z')) return 0;
+    }
+
+    // Silent first letters, and initial "x" and "wh"
+    const char* s = w;
+    if(len >= 2 && (memcmp(w, "ae", 2) == 0 || memcmp(w, "gn", 2) == 0 ||
+                    memcmp(w, "kn", 2) == 0 || memcmp(w, "pn", 2) == 0 ||
+                    memcmp(w, "wr", 2) == 0)) {
+        s++;
+        len--;
+    }
+    if(s[0] == 'x') {
+        w[s - w] = 's';
+    } else if(s[0] == 'w' && s[1] == 'h') {
+        w[s - w + 1] = 'w';
+        s++;
+        len--;
+    }
+
+    size_t n = 0;
+    for(size_t i = 0; i < len && n < DICTIONARY_SOUND_CODE_LENGTH; i++) {
+        char c = s[i];
+        char prev = i > 0 ? s[i - 1] : '\0';
+        char next1 = s[i + 1];
+        char next2 = next1 ? s[i + 2] : '\0';
+        if(c == prev && c != 'c') continue;
+        switch(c) {
+        case 'a':
+        case 'e':
+        case 'i':
+        case 'o':
+        case 'u':
+            if(i == 0) code[n++] = 'A';
+            break;
+        case 'b':
+            if(!(prev == 'm' && i == len - 1)) code[n++] = 'B';
+            break;
+        case 'c':
+            if((next1 == 'i' && next2 == 'a') || (next1 == 'h' && prev != 's')) {
+                code[n++] = 'X';
+            } else if(dictionary_sound_is_front(next1)) {
+                if(prev != 's') code[n++] = 'S';
+            } else {
+                code[n++] = 'K';
+            }
+            break;
+        case 'd':
+            code[n++] = next1 == 'g' && dictionary_sound_is_front(next2) ? 'J' : 'T';
+            break;
+        case 'g':
+            if(next1 == 'h' && !dictionary_sound_is_vowel(next2)) break; // "night"
+            if(next1 == 'n' && (i + 2 == len || strcmp(s + i + 2, "ed") == 0)) break; // "sign"
+            if(prev == 'd' && dictionary_sound_is_front(next1)) break; // "edge"
+            code[n++] = dictionary_sound_is_front(next1) ? 'J' : 'K';
+            break;
+        case 'h':
+            if(dictionary_sound_is_vowel(next1) && !(prev && strchr("cgpst", prev))) {
+                code[n++] = 'H';
+            }
+            break;
+        case 'k':
+            if(prev != 'c') code[n++] = 'K';
+            break;
+        case 'p':
+            code[n++] = next1 == 'h' ? 'F' : 'P';
+            break;
+        case 'q':
+            code[n++] = 'K';
+            break;
+        case 's':
+            code[n++] = next1 == 'h' || (next1 == 'i' && (next2 == 'o' || next2 == 'a')) ? 'X' :
+                                                                                          'S';
+            break;
+        case 't':
+            if(next1 == 'i' && (next2 == 'o' || next2 == 'a')) {
+                code[n++] = 'X';
+            } else if(next1 == 'h') {
+                code[n++] = '0';
+            } else if(!(next1 == 'c' && next2 == 'h')) {
+                code[n++] = 'T';
+            }
+            break;
+        case 'v':
+            code[n++] = 'F';
+            break;
+        case 'w':
+        case 'y':
+            if(dictionary_sound_is_vowel(next1)) code[n++] = toupper((unsigned char)c);
+            break;
+        case 'x':
+            code[n++] = 'K';
+            if(n < DICTIONARY_SOUND_CODE_LENGTH) code[n++] = 'S';
+            break;
+        case 'z':
+            code[n++] = 'S';
+            break;
+        default:
+            code[n++] = toupper((unsigned char)c);
+            break;
+        }
+    }
+    code[n] = '\0';
+    return n;
+}
+
+// MurmurHash3's finalizer, as fmix32() in tools/dictc.py
+static uint32_t dictionary_sound_mix(uint32_t hash) {
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35;
+    return hash ^ (hash >> 16);
+}
+
+uint8_t dictionary_sound_find(
+    Dictionary* dict,
+    DictionaryFile* idx_file,
+    const char* word,
+    uint32_t ids[DICTIONARY_SOUND_MAX]) {
+    const DictionaryIndexInfo* info = dictionary_get_index_info(dict);
+    char code[DICTIONARY_SOUND_CODE_LENGTH + 1];
+    if(!info->sounds_offset || dictionary_sound_encode(word, code) == 0) return 0;
+
+    uint8_t head[DICTIONARY_SOUND_HEAD_SIZE];
+    DictionaryStorage* storage = dictionary_get_storage(dict);
+    if(!dictionary_storage_read_at(storage, idx_file, info->sounds_offset, head, sizeof(head))) {
+        return 0;
+    }
+    uint32_t bucket_count, id_bits;
+    memcpy(&bucket_count, head, sizeof(bucket_count));
+    memcpy(&id_bits, head + 8, sizeof(id_bits));
+    if(bucket_count == 0 || id_bits == 0 || id_bits >= 32) return 0;
+
+    uint32_t hash = dictionary_fnv1a(code, strlen(code), DICTIONARY_FNV1A_BASIS);
+    uint32_t directory_offset = info->sounds_offset + DICTIONARY_SOUND_HEAD_SIZE;
+    uint32_t bucket = dictionary_sound_mix(hash) % bucket_count;
+    uint32_t range[2];
+    if(!dictionary_storage_read_at(
+           storage, idx_file, directory_offset + bucket * 4, range, sizeof(range)) ||
+       range[1] < range[0] || range[1] - range[0] > DICTIONARY_SOUND_MAX_BUCKET) {
+        return 0;
+    }
+
+    uint32_t entries[DICTIONARY_SOUND_MAX_BUCKET];
+    uint32_t count = range[1] - range[0];
+    uint32_t entries_offset = directory_offset + (bucket_count + 1) * 4;
+    if(count == 0 || !dictionary_storage_read_at(
+                         storage, idx_file, entries_offset + range[0] * 4, entries, count * 4)) {
+        return 0;
+    }
+
+    // A code's entries are together, most common first
+    uint8_t found = 0;
+    uint32_t id_mask = (1UL << id_bits) - 1;
+    for(uint32_t i = 0; i < count && found < DICTIONARY_SOUND_MAX; i++) {
+        uint32_t id = entries[i] & id_mask;
+        if(entries[i] >> id_bits == hash >> id_bits && id < info->record_count) {
+            ids[found++] = id;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Sound-alike headwords for a misspelt word ("nite" -> "night", "fone" ->
+// "phone"). The SNDX section of engdict.idx files every single-word key
+// under the Metaphone code of its spelling and, where it has CMUdict
+// phonetics, under the same letters made from its pronunciation, so "laf"
+// finds "laugh" although their spellings code differently. A query is coded
+// by its spelling only and costs three reads, whatever the index size: the
+// section head, its bucket's directory entry and the bucket, which holds at
+// most DICTIONARY_SOUND_MAX_BUCKET entries.
+
+// Letters of a code (SOUND_CODE_LENGTH in tools/dictc.py)
+#define DICTIONARY_SOUND_CODE_LENGTH 6
+// Headwords per code, the most common kept (SOUND_MAX_PER_CODE)
+#define DICTIONARY_SOUND_MAX 8
+// Entries per bucket at most (SOUND_MAX_BUCKET)
+#define DICTIONARY_SOUND_MAX_BUCKET 48
+
+// Writes the code of `word` to `code` (DICTIONARY_SOUND_CODE_LENGTH + 1
+// bytes), as metaphone() in tools/dictc.py. Returns its length, 0 if the
+// word is not all letters.
+size_t dictionary_sound_encode(const char* word, char* code);
+
+// Sets `ids` to the records filed under the code of `word`, most common
+// first, and returns their count: 0 when there are none, the read failed or
+// the index has no SNDX section. Only a hash of the code is stored, so on
+// rare collisions an unrelated headword comes along.
+uint8_t dictionary_sound_find(
+    Dictionary* dict,
+    DictionaryFile* idx_file,
+    const char* word,
+    uint32_t ids[DICTIONARY_SOUND_MAX]);
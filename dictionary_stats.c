@@ -0,0 +1,153 @@
+#include "dictionary_stats.h"
+
+#ifdef DICTIONARY_STATS
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* const dictionary_stats_op_names[DictionaryStatsOpCount] = {
+    "search",
+    "random",
+    "reverse",
+    "pattern",
+    "glossary",
+};
+
+static uint16_t dictionary_stats_saturate(uint32_t value) {
+    return value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+}
+
+void dictionary_stats_reset(DictionaryStats* stats) {
+    memset(stats, 0, sizeof(DictionaryStats));
+}
+
+void dictionary_stats_add(
+    DictionaryStats* stats,
+    DictionaryStatsOp op,
+    DictionaryStatus status,
+    bool cache_hit,
+    const DictionaryStorageStats* storage,
+    uint32_t ms) {
+    DictionaryStatsTotals* totals = &stats->totals[op];
+    totals->lookups++;
+    totals->cache_hits += cache_hit;
+    totals->failures += status != DictionaryStatusOk && status != DictionaryStatusNotFound &&
+                        status != DictionaryStatusCancelled;
+    totals->seeks += storage->seeks;
+    totals->reads += storage->reads;
+    totals->bytes_read += storage->bytes_read;
+    totals->ms += ms;
+
+    DictionaryStatsSample* sample = &stats->samples[stats->next];
+    sample->op = op;
+    sample->status = status;
+    sample->cache_hit = cache_hit;
+    sample->seeks = dictionary_stats_saturate(storage->seeks);
+    sample->reads = dictionary_stats_saturate(storage->reads);
+    sample->bytes_read = dictionary_stats_saturate(storage->bytes_read);
+    sample->ms = dictionary_stats_saturate(ms);
+    stats->next = (stats->next + 1) % DICTIONARY_STATS_WINDOW;
+    if(stats->count < DICTIONARY_STATS_WINDOW) stats->count++;
+}
+
+const char* dictionary_stats_op_get_name(DictionaryStatsOp op) {
+    return op < DictionaryStatsOpCount ? dictionary_stats_op_names[op] : "?";
+}
+
+bool dictionary_stats_get_percentiles(
+    const DictionaryStats* stats,
+    DictionaryStatsOp op,
+    uint32_t* p50,
+    uint32_t* p99) {
+    // Insertion sort of the op's times; the window is small
+    uint16_t sorted[DICTIONARY_STATS_WINDOW];
+    uint16_t count = 0;
+    for(uint16_t i = 0; i < stats->count; i++) {
+        const DictionaryStatsSample* sample = &stats->samples[i];
+        if(sample->op != op) continue;
+        uint16_t j = count++;
+        for(; j > 0 && sorted[j - 1] > sample->ms; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = sample->ms;
+    }
+    if(count == 0) return false;
+    // Nearest rank, as in the host benchmark
+    *p50 = sorted[(50 * (count - 1) + 50) / 100];
+    *p99 = sorted[(99 * (count - 1) + 50) / 100];
+    return true;
+}
+
+static void dictionary_stats_printf(DictionaryOutput* out, const char* format, ...) {
+    char line[64];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if(length <= 0) return;
+    // Lines are short; a longer one is cut
+    size_t size = (size_t)length < sizeof(line) ? (size_t)length : sizeof(line) - 1;
+    out->write(out->context, line, size);
+}
+
+// Tenths of total / count, e.g. 14 for 1.4
+static unsigned long dictionary_stats_average(uint32_t total, uint32_t count) {
+    return (unsigned long)(((uint64_t)total * 10 + count / 2) / count);
+}
+
+void dictionary_stats_write_summary(const DictionaryStats* stats, DictionaryOutput* out) {
+    bool any = false;
+    for(uint8_t op = 0; op < DictionaryStatsOpCount; op++) {
+        const DictionaryStatsTotals* totals = &stats->totals[op];
+        if(totals->lookups == 0) continue;
+        any = true;
+        unsigned long seeks = dictionary_stats_average(totals->seeks, totals->lookups);
+        unsigned long reads = dictionary_stats_average(totals->reads, totals->lookups);
+        dictionary_stats_printf(
+            out,
+            "%s: %lu, %lu cached\n",
+            dictionary_stats_op_names[op],
+            (unsigned long)totals->lookups,
+            (unsigned long)totals->cache_hits);
+        uint32_t p50, p99;
+        if(dictionary_stats_get_percentiles(stats, op, &p50, &p99)) {
+            dictionary_stats_printf(
+                out, " p50 %lu ms, p99 %lu ms\n", (unsigned long)p50, (unsigned long)p99);
+        }
+        dictionary_stats_printf(
+            out,
+            " %lu.%lu seeks, %lu.%lu reads\n",
+            seeks / 10,
+            seeks % 10,
+            reads / 10,
+            reads % 10);
+        dictionary_stats_printf(
+            out,
+            " %lu bytes, %lu failed\n",
+            (unsigned long)(totals->bytes_read / totals->lookups),
+            (unsigned long)totals->failures);
+    }
+    if(!any) dictionary_stats_printf(out, "No lookups yet\n");
+}
+
+void dictionary_stats_write_csv(const DictionaryStats* stats, DictionaryOutput* out) {
+    dictionary_stats_printf(out, "op,status,cache_hit,seeks,reads,bytes_read,ms\n");
+    uint16_t first = stats->count < DICTIONARY_STATS_WINDOW ? 0 : stats->next;
+    for(uint16_t i = 0; i < stats->count; i++) {
+        const DictionaryStatsSample* sample =
+            &stats->samples[(first + i) % DICTIONARY_STATS_WINDOW];
+        dictionary_stats_printf(
+            out,
+            "%s,%u,%u,%u,%u,%u,%u\n",
+            dictionary_stats_op_get_name(sample->op),
+            sample->status,
+            sample->cache_hit,
+            sample->seeks,
+            sample->reads,
+            sample->bytes_read,
+            sample->ms);
+    }
+}
+
+#endif
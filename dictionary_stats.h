@@ -0,0 +1,81 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// Lookup instrumentation, built only with DICTIONARY_STATS defined (cdefines
+// in application.fam); otherwise this header and dictionary_stats.c are empty
+// and the worker records nothing. Each lookup the worker runs is recorded as
+// a sample: the storage operations it caused, whether the cache answered it
+// and how long it took. Totals are kept per operation since launch,
+// percentiles over the most recent samples.
+
+#ifdef DICTIONARY_STATS
+
+// Recent lookups kept for percentiles and the CSV dump
+#define DICTIONARY_STATS_WINDOW 128
+
+typedef enum {
+    DictionaryStatsOpSearch,
+    DictionaryStatsOpRandom,
+    DictionaryStatsOpReverse,
+    DictionaryStatsOpPattern,
+    DictionaryStatsOpGlossary, // a whole run
+    DictionaryStatsOpCount,
+} DictionaryStatsOp;
+
+// One lookup; counts saturate at UINT16_MAX
+typedef struct {
+    uint8_t op; // DictionaryStatsOp
+    uint8_t status; // DictionaryStatus
+    bool cache_hit;
+    uint16_t seeks;
+    uint16_t reads;
+    uint16_t bytes_read;
+    uint16_t ms;
+} DictionaryStatsSample;
+
+typedef struct {
+    uint32_t lookups;
+    uint32_t cache_hits;
+    uint32_t failures; // status other than Ok, NotFound or Cancelled
+    uint32_t seeks;
+    uint32_t reads;
+    uint32_t bytes_read;
+    uint32_t ms;
+} DictionaryStatsTotals;
+
+typedef struct {
+    DictionaryStatsTotals totals[DictionaryStatsOpCount];
+    DictionaryStatsSample samples[DICTIONARY_STATS_WINDOW]; // ring, oldest at `next` once full
+    uint16_t next;
+    uint16_t count;
+} DictionaryStats;
+
+void dictionary_stats_reset(DictionaryStats* stats);
+
+// Records a lookup given the storage operations it caused
+void dictionary_stats_add(
+    DictionaryStats* stats,
+    DictionaryStatsOp op,
+    DictionaryStatus status,
+    bool cache_hit,
+    const DictionaryStorageStats* storage,
+    uint32_t ms);
+
+const char* dictionary_stats_op_get_name(DictionaryStatsOp op);
+
+// Median and 99th percentile time in milliseconds of the recent lookups of `op`; false if
+// there are none
+bool dictionary_stats_get_percentiles(
+    const DictionaryStats* stats,
+    DictionaryStatsOp op,
+    uint32_t* p50,
+    uint32_t* p99);
+
+// A few lines per operation, for the Stats view
+void dictionary_stats_write_summary(const DictionaryStats* stats, DictionaryOutput* out);
+
+// The recent samples, oldest first, with a header row
+void dictionary_stats_write_csv(const DictionaryStats* stats, DictionaryOutput* out);
+
+#endif
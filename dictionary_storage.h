@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// File access for the lookup core. The device implements it on top of Furi
+// storage (dictionary_storage_furi.c), the host benchmark on POSIX file
+// descriptors (tools/host). Every call goes through the helpers below so
+// opens, seeks, reads and bytes read can be counted per lookup. Lookups only
+// read; the glossary also writes a scratch file it reads back.
+
+typedef struct DictionaryFile DictionaryFile; // backend-specific handle
+
+typedef struct {
+    DictionaryFile* (*open)(void* context, const char* path); // NULL on failure
+    void (*close)(void* context, DictionaryFile* file);
+    bool (*seek)(void* context, DictionaryFile* file, uint32_t offset); // absolute
+    size_t (*read)(void* context, DictionaryFile* file, void* buffer, size_t size);
+    uint32_t (*size)(void* context, DictionaryFile* file);
+    // True once any operation on the file failed (not for short reads at EOF),
+    // e.g. because the SD card was removed; the handle must be reopened. The
+    // flag is sticky: later successful operations do not clear it.
+    bool (*failed)(void* context, DictionaryFile* file);
+    void (*reset)(void* context, DictionaryFile* file); // clears `failed`
+    // Opens `path` for reading and writing, created empty; NULL on failure
+    DictionaryFile* (*create)(void* context, const char* path);
+    // Writes at the current position; returns the count written
+    size_t (*write)(void* context, DictionaryFile* file, const void* buffer, size_t size);
+    bool (*remove)(void* context, const char* path);
+} DictionaryStorageApi;
+
+typedef struct {
+    uint32_t opens;
+    uint32_t seeks;
+    uint32_t reads;
+    uint32_t bytes_read;
+    uint32_t writes;
+    uint32_t bytes_written;
+} DictionaryStorageStats;
+
+typedef struct {
+    const DictionaryStorageApi* api;
+    void* context;
+    DictionaryStorageStats stats;
+} DictionaryStorage;
+
+static inline DictionaryFile*
+    dictionary_storage_open(DictionaryStorage* storage, const char* path) {
+    storage->stats.opens++;
+    return storage->api->open(storage->context, path);
+}
+
+static inline DictionaryFile*
+    dictionary_storage_create(DictionaryStorage* storage, const char* path) {
+    storage->stats.opens++;
+    return storage->api->create(storage->context, path);
+}
+
+static inline void dictionary_storage_close(DictionaryStorage* storage, DictionaryFile* file) {
+    if(file) storage->api->close(storage->context, file);
+}
+
+static inline bool
+    dictionary_storage_seek(DictionaryStorage* storage, DictionaryFile* file, uint32_t offset) {
+    storage->stats.seeks++;
+    return storage->api->seek(storage->context, file, offset);
+}
+
+static inline size_t dictionary_storage_read(
+    DictionaryStorage* storage,
+    DictionaryFile* file,
+    void* buffer,
+    size_t size) {
+    size_t read = storage->api->read(storage->context, file, buffer, size);
+    storage->stats.reads++;
+    storage->stats.bytes_read += read;
+    return read;
+}
+
+static inline bool dictionary_storage_write(
+    DictionaryStorage* storage,
+    DictionaryFile* file,
+    const void* buffer,
+    size_t size) {
+    size_t written = storage->api->write(storage->context, file, buffer, size);
+    storage->stats.writes++;
+    storage->stats.bytes_written += written;
+    return written == size;
+}
+
+static inline bool dictionary_storage_remove(DictionaryStorage* storage, const char* path) {
+    return storage->api->remove(storage->context, path);
+}
+
+// Seek + read of exactly `size` bytes
+static inline bool dictionary_storage_read_at(
+    DictionaryStorage* storage,
+    DictionaryFile* file,
+    uint32_t offset,
+    void* buffer,
+    size_t size) {
+    return dictionary_storage_seek(storage, file, offset) &&
+           dictionary_storage_read(storage, file, buffer, size) == size;
+}
+
+static inline uint32_t dictionary_storage_size(DictionaryStorage* storage, DictionaryFile* file) {
+    return storage->api->size(storage->context, file);
+}
+
+static inline bool dictionary_storage_failed(DictionaryStorage* storage, DictionaryFile* file) {
+    return file && storage->api->failed(storage->context, file);
+}
+
+// Forgets a latched error, for callers that recovered without reopening
+static inline void dictionary_storage_reset(DictionaryStorage* storage, DictionaryFile* file) {
+    if(file) storage->api->reset(storage->context, file);
+}
@@ -0,0 +1,121 @@
+#include "dictionary_storage_furi.h"
+
+#include <furi.h>
+#include <storage/storage.h>
+
+// Furi only keeps the error of the last operation, so a failed seek followed
+// by a successful read would look healthy. The handle latches every failure
+// until dictionary_storage_reset().
+struct DictionaryFile {
+    File* file;
+    bool failed;
+};
+
+static void dictionary_storage_furi_check(DictionaryFile* file) {
+    if(storage_file_get_error(file->file) != FSE_OK) file->failed = true;
+}
+
+static DictionaryFile* dictionary_storage_furi_open_mode(
+    void* context,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    File* file = storage_file_alloc(context);
+    if(!storage_file_open(file, path, access_mode, open_mode)) {
+        storage_file_free(file);
+        return NULL;
+    }
+    DictionaryFile* handle = malloc(sizeof(DictionaryFile));
+    handle->file = file;
+    handle->failed = false;
+    return handle;
+}
+
+static DictionaryFile* dictionary_storage_furi_open(void* context, const char* path) {
+    return dictionary_storage_furi_open_mode(context, path, FSAM_READ, FSOM_OPEN_EXISTING);
+}
+
+static DictionaryFile* dictionary_storage_furi_create(void* context, const char* path) {
+    return dictionary_storage_furi_open_mode(context, path, FSAM_READ_WRITE, FSOM_CREATE_ALWAYS);
+}
+
+static void dictionary_storage_furi_close(void* context, DictionaryFile* file) {
+    UNUSED(context);
+    storage_file_close(file->file);
+    storage_file_free(file->file);
+    free(file);
+}
+
+static bool dictionary_storage_furi_seek(void* context, DictionaryFile* file, uint32_t offset) {
+    UNUSED(context);
+    bool ok = storage_file_seek(file->file, offset, true);
+    if(!ok) file->failed = true;
+    dictionary_storage_furi_check(file);
+    return ok;
+}
+
+static size_t
+    dictionary_storage_furi_read(void* context, DictionaryFile* file, void* buffer, size_t size) {
+    UNUSED(context);
+    size_t read = storage_file_read(file->file, buffer, size);
+    dictionary_storage_furi_check(file);
+    return read;
+}
+
+static size_t dictionary_storage_furi_write(
+    void* context,
+    DictionaryFile* file,
+    const void* buffer,
+    size_t size) {
+    UNUSED(context);
+    size_t written = storage_file_write(file->file, buffer, size);
+    dictionary_storage_furi_check(file);
+    return written;
+}
+
+static uint32_t dictionary_storage_furi_size(void* context, DictionaryFile* file) {
+    UNUSED(context);
+    uint32_t size = (uint32_t)storage_file_size(file->file);
+    dictionary_storage_furi_check(file);
+    return size;
+}
+
+static bool dictionary_storage_furi_failed(void* context, DictionaryFile* file) {
+    UNUSED(context);
+    return file->failed;
+}
+
+static void dictionary_storage_furi_reset(void* context, DictionaryFile* file) {
+    UNUSED(context);
+    file->failed = false;
+}
+
+static bool dictionary_storage_furi_remove(void* context, const char* path) {
+    return storage_simply_remove(context, path);
+}
+
+static const DictionaryStorageApi dictionary_storage_furi_api = {
+    .open = dictionary_storage_furi_open,
+    .close = dictionary_storage_furi_close,
+    .seek = dictionary_storage_furi_seek,
+    .read = dictionary_storage_furi_read,
+    .size = dictionary_storage_furi_size,
+    .failed = dictionary_storage_furi_failed,
+    .reset = dictionary_storage_furi_reset,
+    .create = dictionary_storage_furi_create,
+    .write = dictionary_storage_furi_write,
+    .remove = dictionary_storage_furi_remove,
+};
+
+DictionaryStorage* dictionary_storage_furi_alloc(void) {
+    DictionaryStorage* storage = malloc(sizeof(DictionaryStorage));
+    memset(storage, 0, sizeof(DictionaryStorage));
+    storage->api = &dictionary_storage_furi_api;
+    storage->context = furi_record_open(RECORD_STORAGE);
+    return storage;
+}
+
+void dictionary_storage_furi_free(DictionaryStorage* storage) {
+    furi_record_close(RECORD_STORAGE);
+    free(storage);
+}
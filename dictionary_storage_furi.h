@@ -0,0 +1,8 @@
+#pragma once
+
+#include "dictionary_storage.h"
+
+// DictionaryStorage backed by the Furi storage service (RECORD_STORAGE)
+DictionaryStorage* dictionary_storage_furi_alloc(void);
+
+void dictionary_storage_furi_free(DictionaryStorage* storage);
@@ -0,0 +1,292 @@
+#include "dictionary_suggest.h"
+
+#include "dictionary_sound.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#define DICTIONARY_DELS_HEAD_SIZE 16
+// Bucket entries read at a time; buckets average 8 entries
+#define DICTIONARY_DELS_CHUNK 32
+
+typedef struct {
+    Dictionary* dict;
+    DictionaryFile* idx_file;
+    uint32_t bucket_count;
+    uint32_t directory_offset;
+    uint32_t entries_offset;
+    uint8_t id_bits;
+    uint32_t reads_start; // storage reads when the query began
+    uint32_t candidates[DICTIONARY_SUGGEST_MAX_CANDIDATES];
+    uint8_t candidate_count;
+} DictionarySuggestQuery;
+
+// Reads left of the query's DICTIONARY_SUGGEST_READ_BUDGET
+static uint32_t dictionary_suggest_reads_left(const DictionarySuggestQuery* query) {
+    const DictionaryStorage* storage = dictionary_get_storage(query->dict);
+    uint32_t used = storage->stats.reads - query->reads_start;
+    return used < DICTIONARY_SUGGEST_READ_BUDGET ? DICTIONARY_SUGGEST_READ_BUDGET - used : 0;
+}
+
+static bool dictionary_suggest_spent(const DictionarySuggestQuery* query) {
+    return dictionary_suggest_reads_left(query) == 0;
+}
+
+static bool dictionary_suggest_open(DictionarySuggestQuery* query) {
+    const DictionaryIndexInfo* info = dictionary_get_index_info(query->dict);
+    if(!info->deletes_offset) return false;
+
+    uint8_t head[DICTIONARY_DELS_HEAD_SIZE];
+    DictionaryStorage* storage = dictionary_get_storage(query->dict);
+    if(!dictionary_storage_read_at(
+           storage, query->idx_file, info->deletes_offset, head, sizeof(head))) {
+        return false;
+    }
+    uint32_t id_bits;
+    memcpy(&query->bucket_count, head, sizeof(query->bucket_count));
+    memcpy(&id_bits, head + 8, sizeof(id_bits));
+    if(query->bucket_count == 0 || id_bits == 0 || id_bits >= 32) return false;
+
+    query->id_bits = id_bits;
+    query->directory_offset = info->deletes_offset + DICTIONARY_DELS_HEAD_SIZE;
+    query->entries_offset = query->directory_offset + (query->bucket_count + 1) * 4;
+    return true;
+}
+
+static void dictionary_suggest_add_candidate(DictionarySuggestQuery* query, uint32_t id) {
+    for(uint8_t i = 0; i < query->candidate_count; i++) {
+        if(query->candidates[i] == id) return;
+    }
+    if(query->candidate_count < DICTIONARY_SUGGEST_MAX_CANDIDATES) {
+        query->candidates[query->candidate_count++] = id;
+    }
+}
+
+// Adds the ids in the variant's bucket whose fingerprint matches, unless no
+// more than `reserve` reads are left
+static void dictionary_suggest_probe(
+    DictionarySuggestQuery* query,
+    const char* variant,
+    size_t len,
+    uint32_t reserve) {
+    if(len == 0 || dictionary_suggest_reads_left(query) <= reserve) return;
+
+    DictionaryStorage* storage = dictionary_get_storage(query->dict);
+    uint32_t hash = dictionary_fnv1a(variant, len, DICTIONARY_FNV1A_BASIS);
+    uint32_t bucket = hash % query->bucket_count;
+    uint32_t range[2];
+    if(!dictionary_storage_read_at(
+           storage, query->idx_file, query->directory_offset + bucket * 4, range, sizeof(range)) ||
+       range[1] < range[0] ||
+       !dictionary_storage_seek(storage, query->idx_file, query->entries_offset + range[0] * 4)) {
+        return;
+    }
+
+    uint32_t fingerprint = hash >> query->id_bits;
+    uint32_t id_mask = (1UL << query->id_bits) - 1;
+    uint32_t entries[DICTIONARY_DELS_CHUNK];
+    for(uint32_t left = range[1] - range[0]; left > 0;) {
+        uint32_t count = left < DICTIONARY_DELS_CHUNK ? left : DICTIONARY_DELS_CHUNK;
+        if(dictionary_storage_read(storage, query->idx_file, entries, count * 4) != count * 4) {
+            return;
+        }
+        for(uint32_t i = 0; i < count; i++) {
+            // Entries are sorted, so the matching fingerprint is one run
+            uint32_t entry_fingerprint = entries[i] >> query->id_bits;
+            if(entry_fingerprint == fingerprint) {
+                dictionary_suggest_add_candidate(query, entries[i] & id_mask);
+            } else if(entry_fingerprint > fingerprint) {
+                return;
+            }
+        }
+        left -= count;
+    }
+}
+
+// Optimal string alignment distance (adjacent transpositions count as one
+// edit), or limit + 1 once it exceeds limit.
+static uint8_t dictionary_suggest_distance(const char* a, const char* b, uint8_t limit) {
+    size_t la = strlen(a), lb = strlen(b);
+    if((la > lb ? la - lb : lb - la) > limit) return limit + 1;
+
+    uint8_t rows[3][MAX_WORD_LENGTH + 1];
+    uint8_t *prev2 = rows[0], *prev = rows[1], *row = rows[2];
+    for(size_t j = 0; j <= lb; j++)
+        prev[j] = j;
+    for(size_t i = 1; i <= la; i++) {
+        row[0] = i;
+        uint8_t best = row[0];
+        for(size_t j = 1; j <= lb; j++) {
+            uint8_t cost = a[i - 1] != b[j - 1];
+            uint8_t d = prev[j - 1] + cost;
+            if(prev[j] + 1 < d) d = prev[j] + 1;
+            if(row[j - 1] + 1 < d) d = row[j - 1] + 1;
+            if(i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1] &&
+               prev2[j - 2] + 1 < d) {
+                d = prev2[j - 2] + 1;
+            }
+            row[j] = d;
+            if(d < best) best = d;
+        }
+        if(best > limit) return limit + 1;
+        uint8_t* spare = prev2;
+        prev2 = prev;
+        prev = row;
+        row = spare;
+    }
+    return prev[lb] <= limit ? prev[lb] : limit + 1;
+}
+
+// Merges `key` (a record key, MAX_WORD_LENGTH bytes) into the sorted
+// suggestions, or improves its rank if it is there already
+static void
+    dictionary_suggest_insert(DictionarySuggestions* suggestions, const char* key, uint8_t rank) {
+    for(uint8_t i = 0; i < suggestions->count; i++) {
+        if(strcmp(suggestions->words[i], key) != 0) continue;
+        if(suggestions->ranks[i] <= rank) return;
+        suggestions->count--;
+        memmove(
+            suggestions->words[i],
+            suggestions->words[i + 1],
+            (suggestions->count - i) * sizeof(suggestions->words[0]));
+        memmove(&suggestions->ranks[i], &suggestions->ranks[i + 1], suggestions->count - i);
+        break;
+    }
+
+    // Insertion sort by rank, then key order
+    uint8_t pos = suggestions->count;
+    while(pos > 0 && (suggestions->ranks[pos - 1] > rank ||
+                      (suggestions->ranks[pos - 1] == rank &&
+                       strcmp(suggestions->words[pos - 1], key) > 0))) {
+        pos--;
+    }
+    if(pos >= DICTIONARY_SUGGEST_MAX) return;
+
+    uint8_t last = suggestions->count < DICTIONARY_SUGGEST_MAX ? suggestions->count :
+                                                                 DICTIONARY_SUGGEST_MAX - 1;
+    memmove(
+        suggestions->words[pos + 1],
+        suggestions->words[pos],
+        (last - pos) * sizeof(suggestions->words[0]));
+    memmove(&suggestions->ranks[pos + 1], &suggestions->ranks[pos], last - pos);
+    memcpy(suggestions->words[pos], key, MAX_WORD_LENGTH);
+    suggestions->ranks[pos] = rank;
+    if(suggestions->count < DICTIONARY_SUGGEST_MAX) suggestions->count++;
+}
+
+// Verifies the candidates and merges them into the sorted suggestions
+static void dictionary_suggest_verify(
+    DictionarySuggestQuery* query,
+    const char* word,
+    DictionarySuggestions* suggestions) {
+    for(uint8_t c = 0; c < query->candidate_count && !dictionary_suggest_spent(query); c++) {
+        DictionaryRecord record;
+        if(!dictionary_read_key(query->dict, query->idx_file, query->candidates[c], &record)) {
+            continue;
+        }
+        uint8_t distance =
+            dictionary_suggest_distance(word, record.key, DICTIONARY_SUGGEST_MAX_DISTANCE);
+        if(distance <= DICTIONARY_SUGGEST_MAX_DISTANCE) {
+            dictionary_suggest_insert(suggestions, record.key, 2 * distance);
+        }
+    }
+    query->candidate_count = 0;
+}
+
+static char dictionary_suggest_first_vowel(const char* word) {
+    const char* vowel = strpbrk(word, "aeiou");
+    return vowel ? *vowel : '\0';
+}
+
+// Adds the headwords that sound like the word however they are spelt. Those
+// more than an edit away rank between the keys one and two edits away; the
+// most common with the word's first vowel (sound codes leave vowels out) gets
+// the last place if keys one edit away took them all, so "nite" still
+// suggests "night".
+static void dictionary_suggest_sounds(
+    DictionarySuggestQuery* query,
+    const char* word,
+    DictionarySuggestions* suggestions) {
+    uint32_t ids[DICTIONARY_SOUND_MAX];
+    uint8_t count = dictionary_sound_find(query->dict, query->idx_file, word, ids);
+    char vowel = dictionary_suggest_first_vowel(word);
+    DictionaryRecord record, best = {.key = ""};
+    for(uint8_t i = 0; i < count && !dictionary_suggest_spent(query); i++) {
+        if(!dictionary_read_key(query->dict, query->idx_file, ids[i], &record)) continue;
+        // Keys within an edit rank by their spelling as usual
+        uint8_t distance = dictionary_suggest_distance(word, record.key, 1);
+        if(distance <= 1) {
+            dictionary_suggest_insert(suggestions, record.key, 2 * distance);
+            continue;
+        }
+        dictionary_suggest_insert(suggestions, record.key, 3);
+        if(!best.key[0] && vowel && dictionary_suggest_first_vowel(record.key) == vowel) {
+            best = record;
+        }
+    }
+
+    if(!best.key[0] || suggestions->count < DICTIONARY_SUGGEST_MAX) return;
+    for(uint8_t i = 0; i < suggestions->count; i++) {
+        if(strcmp(suggestions->words[i], best.key) == 0) return;
+    }
+    memcpy(suggestions->words[DICTIONARY_SUGGEST_MAX - 1], best.key, MAX_WORD_LENGTH);
+    suggestions->ranks[DICTIONARY_SUGGEST_MAX - 1] = 3;
+}
+
+DictionaryStatus
+    dictionary_suggest(Dictionary* dict, const char* word, DictionarySuggestions* suggestions) {
+    memset(suggestions, 0, sizeof(DictionarySuggestions));
+
+    // Keys are stored lowercase
+    char key[MAX_WORD_LENGTH];
+    size_t len = strlen(word);
+    if(len == 0 || len >= MAX_WORD_LENGTH) return DictionaryStatusNotFound;
+    for(size_t i = 0; i <= len; i++)
+        key[i] = tolower((unsigned char)word[i]);
+
+    DictionarySuggestQuery query = {.dict = dict, .candidate_count = 0};
+    query.idx_file = dictionary_get_index_file(dict);
+    if(!query.idx_file) return DictionaryStatusNoFiles;
+    query.reads_start = dictionary_get_storage(dict)->stats.reads;
+    if(!dictionary_suggest_open(&query)) {
+        dictionary_check_files(dict);
+        return DictionaryStatusNotFound;
+    }
+
+    // Pass 1: the word and its single deletions meet every key within one
+    // edit and some within two.
+    char variant[MAX_WORD_LENGTH];
+    dictionary_suggest_probe(&query, key, len, 0);
+    for(size_t i = 0; i < len; i++) {
+        if(i > 0 && key[i] == key[i - 1]) continue; // same variant as i - 1
+        memcpy(variant, key, i);
+        memcpy(variant + i, key + i + 1, len - i);
+        dictionary_suggest_probe(&query, variant, len - 1, 0);
+    }
+    dictionary_suggest_verify(&query, key, suggestions);
+
+    // Pass 2: double deletions, only when nothing was found and the word is
+    // long enough for two edits to leave it recognisable
+    if(suggestions->count == 0 && len >= 4) {
+        for(size_t i = 0; i < len; i++) {
+            if(i > 0 && key[i] == key[i - 1]) continue;
+            for(size_t j = i + 1; j < len; j++) {
+                if(j > i + 1 && key[j] == key[j - 1]) continue;
+                size_t n = 0;
+                for(size_t k = 0; k < len; k++) {
+                    if(k != i && k != j) variant[n++] = key[k];
+                }
+                dictionary_suggest_probe(&query, variant, n, DICTIONARY_SUGGEST_DOUBLE_RESERVE);
+            }
+        }
+        dictionary_suggest_verify(&query, key, suggestions);
+    }
+
+    // Pass 3: words spelt the way they sound ("nite"), one more probe
+    if(len >= DICTIONARY_SUGGEST_SOUND_MIN_LENGTH && !dictionary_suggest_spent(&query)) {
+        dictionary_suggest_sounds(&query, key, suggestions);
+    }
+
+    dictionary_check_files(dict);
+    return suggestions->count ? DictionaryStatusOk : DictionaryStatusNotFound;
+}
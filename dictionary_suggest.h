@@ -0,0 +1,39 @@
+#pragma once
+
+#include "dictionary_core.h"
+
+// "Did you mean" suggestions for a missed word. The DELS section of
+// engdict.idx hashes every key and its one-deletion variants; the query's own
+// deletions are probed against it, so keys within one edit are always found
+// and most within two. Each probe costs two reads, candidates are verified
+// against the real key with an edit-distance check. Headwords that sound like
+// the word (dictionary_sound.h) are added whatever their spelling.
+
+#define DICTIONARY_SUGGEST_MAX          6
+#define DICTIONARY_SUGGEST_MAX_DISTANCE 2
+// Storage reads one query may issue. Probes (two reads each) go to the word
+// and its single deletions first, then its double deletions; candidates are
+// verified with a read each and the sound lookup takes two or three. Each step
+// starts only while reads are left, so a query ends a few reads past this at
+// most.
+#define DICTIONARY_SUGGEST_READ_BUDGET 32
+// Reads the double-deletion probes leave for verifying what they find and
+// for the sound lookup; spending them on more probes finds less
+#define DICTIONARY_SUGGEST_DOUBLE_RESERVE 8
+// Candidates verified per query
+#define DICTIONARY_SUGGEST_MAX_CANDIDATES 32
+// Shorter words are not looked up by sound: their codes match too much
+#define DICTIONARY_SUGGEST_SOUND_MIN_LENGTH 3
+
+typedef struct {
+    char words[DICTIONARY_SUGGEST_MAX][MAX_WORD_LENGTH];
+    // Twice the edit distance, or 3 for a sound-alike further away: after
+    // the keys one edit away, before those two edits away
+    uint8_t ranks[DICTIONARY_SUGGEST_MAX];
+    uint8_t count; // best rank first, then in key order
+} DictionarySuggestions;
+
+// DictionaryStatusNotFound when nothing is close enough or the index has no
+// DELS section.
+DictionaryStatus
+    dictionary_suggest(Dictionary* dict, const char* word, DictionarySuggestions* suggestions);
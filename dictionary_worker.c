@@ -0,0 +1,720 @@
+#include "dictionary_worker.h"
+
+#include <ctype.h>
+#include <furi.h>
+#include <stdatomic.h>
+#include <storage/storage.h>
+#include <string.h>
+#include <toolbox/stream/buffered_file_stream.h>
+
+#define TAG "DictionaryWorker"
+
+typedef enum {
+    DictionaryWorkerJobSearch,
+    DictionaryWorkerJobRandom,
+    DictionaryWorkerJobReverse,
+    DictionaryWorkerJobPattern,
+    DictionaryWorkerJobGlossary,
+    DictionaryWorkerJobRelease,
+    DictionaryWorkerJobComplete,
+    DictionaryWorkerJobPrefetch,
+    DictionaryWorkerJobStop,
+} DictionaryWorkerJobType;
+
+typedef struct {
+    DictionaryWorkerJobType type;
+    uint32_t generation;
+    bool flag; // suggest for searches, weighted for random picks, anagram for patterns
+    char word[MAX_WORD_LENGTH];
+} DictionaryWorkerJob;
+
+// A result with what its text source reads: the definition, then the
+// entries of its laid-out lines (dictionary_layout.h), copied into RAM by the
+// worker so the GUI thread never reads the card for them
+typedef struct {
+    DictionaryWorkerResult result;
+    uint32_t generation;
+    char* text; // owned by the answer, NULL without an entry
+    size_t length;
+    uint32_t lines; // laid-out body lines, 0 to format them as they are shown
+} DictionaryWorkerAnswer;
+
+struct DictionaryWorker {
+    FuriThread* thread;
+    FuriMessageQueue* queue;
+    FuriMutex* mutex; // guards what the threads hand each other, marked below
+    Dictionary* dict; // worker thread only, as the cache, completer and patterns
+    DictionaryCache* cache;
+    DictionaryCompleter* completer;
+    DictionaryPatterns* patterns; // loaded by the first pattern search
+    size_t patterns_budget; // locked: RAM the table may take when it is loaded
+    const char* glossary_list; // locked: paths of the glossary job
+    const char* glossary_path;
+    const char* glossary_runs;
+    size_t glossary_budget; // locked: RAM it may sort and merge in
+    DictionaryRng rng;
+    DictionaryWorkerCallback callback;
+    void* context;
+
+    _Atomic uint32_t generation; // bumped by a cancel without locking
+    DictionaryWorkerAnswer answer; // being worked on, worker thread only
+    DictionaryWorkerAnswer posted; // locked, as the completions and progress
+    bool posted_ready;
+    DictionaryWorkerAnswer shown; // GUI thread only, read by its text source
+    DictionaryCompletions completions;
+    uint32_t completions_generation;
+    bool completions_ready;
+    DictionaryBatchProgress progress; // of the running glossary
+    uint32_t progress_generation;
+    bool progress_ready;
+
+#ifdef DICTIONARY_STATS
+    DictionaryStats stats; // locked
+    DictionaryStorageStats measure_storage; // when the running lookup started
+    uint32_t measure_tick;
+#endif
+};
+
+static void dictionary_worker_lock(DictionaryWorker* worker) {
+    furi_check(furi_mutex_acquire(worker->mutex, FuriWaitForever) == FuriStatusOk);
+}
+
+static void dictionary_worker_unlock(DictionaryWorker* worker) {
+    furi_check(furi_mutex_release(worker->mutex) == FuriStatusOk);
+}
+
+// False once the job was cancelled
+static bool
+    dictionary_worker_is_current(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    return job->generation == atomic_load(&worker->generation);
+}
+
+static void dictionary_worker_answer_clear(DictionaryWorkerAnswer* answer) {
+    free(answer->text);
+    memset(answer, 0, sizeof(DictionaryWorkerAnswer));
+}
+
+static bool dictionary_worker_is_idle(DictionaryWorker* worker) {
+    return furi_message_queue_get_count(worker->queue) == 0;
+}
+
+// Reads the definition of `record` into the cache if it fits there; false if
+// the read failed
+static bool dictionary_worker_cache_record(
+    DictionaryWorker* worker,
+    const DictionaryRecord* record) {
+    if(record->hot) return true; // decoded from the .fap when shown, costs no read
+    char* text = dictionary_cache_reserve(worker->cache, record->key, record->length);
+    if(!text) return true; // too long, streamed when shown
+    if(dictionary_read_definition(worker->dict, record, 0, text, record->length) ==
+       record->length) {
+        return true;
+    }
+    dictionary_cache_remove(worker->cache, record->key);
+    return false;
+}
+
+#ifdef DICTIONARY_STATS
+// Starts measuring a lookup. Only the worker thread reads the card, so the
+// storage counters move for this lookup alone.
+static void dictionary_worker_measure_start(DictionaryWorker* worker) {
+    worker->measure_storage = dictionary_get_storage(worker->dict)->stats;
+    worker->measure_tick = furi_get_tick();
+}
+
+// Records the lookup measured since dictionary_worker_measure_start()
+static void dictionary_worker_measure_end(
+    DictionaryWorker* worker,
+    DictionaryStatsOp op,
+    bool cache_hit) {
+    dictionary_worker_lock(worker);
+    const DictionaryStorageStats* now = &dictionary_get_storage(worker->dict)->stats;
+    DictionaryStorageStats delta = {
+        .seeks = now->seeks - worker->measure_storage.seeks,
+        .reads = now->reads - worker->measure_storage.reads,
+        .bytes_read = now->bytes_read - worker->measure_storage.bytes_read,
+    };
+    uint32_t ms =
+        (furi_get_tick() - worker->measure_tick) * 1000 / furi_kernel_get_tick_frequency();
+    const DictionaryWorkerResult* result = &worker->answer.result;
+    dictionary_stats_add(&worker->stats, op, result->status, cache_hit, &delta, ms);
+    dictionary_worker_unlock(worker);
+    FURI_LOG_D(
+        TAG,
+        "%s %s: status %d, %lu seeks, %lu reads, %lu bytes, %lu ms%s",
+        dictionary_stats_op_get_name(op),
+        result->word,
+        result->status,
+        delta.seeks,
+        delta.reads,
+        delta.bytes_read,
+        ms,
+        cache_hit ? ", cached" : "");
+}
+#else
+#define dictionary_worker_measure_start(worker)
+#define dictionary_worker_measure_end(worker, op, cache_hit)
+#endif
+
+static void dictionary_worker_post(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    if(!dictionary_worker_is_current(worker, job)) return;
+    dictionary_worker_lock(worker);
+    worker->answer.generation = job->generation;
+    dictionary_worker_answer_clear(&worker->posted); // never taken
+    worker->posted = worker->answer;
+    worker->answer.text = NULL;
+    worker->posted_ready = true;
+    dictionary_worker_unlock(worker);
+    worker->callback(worker->context, DictionaryWorkerEventResult);
+}
+
+// Room for `length` bytes of text, cut at the last character boundary
+// within DICTIONARY_WORKER_TEXT_MAX, and `lines` layout entries after it,
+// dropped when they would not fit or the text was cut
+static char* dictionary_worker_answer_reserve(
+    DictionaryWorkerAnswer* answer,
+    size_t length,
+    uint32_t lines) {
+    answer->length = MIN(length, (size_t)DICTIONARY_WORKER_TEXT_MAX);
+    answer->lines = answer->length == length &&
+                            length + lines * DICTIONARY_LAYOUT_ENTRY_SIZE <=
+                                DICTIONARY_WORKER_TEXT_MAX ?
+                        lines :
+                        0;
+    // One byte more, to see whether the cut splits a character
+    answer->text = malloc(answer->length + 1 + answer->lines * DICTIONARY_LAYOUT_ENTRY_SIZE);
+    return answer->text;
+}
+
+static void dictionary_worker_answer_cut(DictionaryWorkerAnswer* answer, size_t length) {
+    if(answer->length == length) return;
+    while(answer->length > 0 && ((uint8_t)answer->text[answer->length] & 0xC0) == 0x80) {
+        answer->length--;
+    }
+}
+
+// Sets the answer to the cached `text`
+static void dictionary_worker_answer_cached(
+    DictionaryWorker* worker,
+    const char* text,
+    size_t length) {
+    DictionaryWorkerAnswer* answer = &worker->answer;
+    char* copy = dictionary_worker_answer_reserve(answer, length, 0);
+    memcpy(copy, text, MIN(length, answer->length + 1));
+    dictionary_worker_answer_cut(answer, length);
+}
+
+// Sets the answer to the found `record`, reading its definition and its
+// layout, and the definition into the cache
+static void dictionary_worker_answer_record(
+    DictionaryWorker* worker,
+    const DictionaryRecord* record) {
+    DictionaryWorkerAnswer* answer = &worker->answer;
+    strcpy(answer->result.word, record->key);
+    // Without it the pager formats the lines as it goes
+    DictionaryLayout layout;
+    dictionary_get_layout(worker->dict, record, &layout);
+    char* text = dictionary_worker_answer_reserve(answer, record->length, layout.count);
+    size_t size = MIN(record->length, answer->length + 1);
+    if(dictionary_read_definition(worker->dict, record, 0, text, size) != size) {
+        free(text);
+        answer->text = NULL;
+        answer->length = answer->lines = 0;
+        answer->result.status = DictionaryStatusReadError;
+        return;
+    }
+    dictionary_worker_answer_cut(answer, record->length);
+    if(answer->lines > 0 &&
+       !dictionary_read_layout_lines(worker->dict, &layout, text + answer->length)) {
+        answer->lines = 0;
+    }
+    // Hot words are decoded from the .fap, which costs no read
+    if(!record->hot && answer->length == record->length) {
+        dictionary_cache_put(worker->cache, record->key, text, record->length);
+    }
+}
+
+static void
+    dictionary_worker_search_job(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    DictionaryWorkerAnswer* answer = &worker->answer;
+    dictionary_worker_answer_clear(answer);
+    strcpy(answer->result.word, job->word);
+
+    if(!dictionary_worker_is_current(worker, job)) return;
+    dictionary_worker_measure_start(worker);
+    const char* cached = dictionary_cache_get(worker->cache, job->word, &answer->length);
+    if(cached) {
+        // Headwords are lowercase, as the cache keys them
+        for(char* c = answer->result.word; *c; c++) {
+            *c = tolower((unsigned char)*c);
+        }
+        answer->result.status = DictionaryStatusOk;
+        dictionary_worker_answer_cached(worker, cached, answer->length);
+        dictionary_worker_measure_end(worker, DictionaryStatsOpSearch, true);
+        dictionary_worker_post(worker, job);
+        return;
+    }
+    DictionaryRecord record;
+    answer->result.status = dictionary_find(worker->dict, job->word, &record);
+    // Not a headword, but maybe an inflected form of one: one more probe
+    bool inflected = answer->result.status == DictionaryStatusNotFound &&
+                     dictionary_find_lemma(worker->dict, job->word, &record) ==
+                         DictionaryStatusOk;
+    if(inflected) answer->result.status = DictionaryStatusOk;
+
+    // Checked again between the steps, which read the card
+    if(answer->result.status == DictionaryStatusOk) {
+        if(!dictionary_worker_is_current(worker, job)) return;
+        dictionary_worker_answer_record(worker, &record);
+        if(inflected) {
+            for(size_t i = 0; i < sizeof(answer->result.form) - 1 && job->word[i]; i++) {
+                answer->result.form[i] = tolower((unsigned char)job->word[i]);
+            }
+        }
+    } else if(answer->result.status == DictionaryStatusNotFound && job->flag) {
+        if(!dictionary_worker_is_current(worker, job)) return;
+        dictionary_suggest(worker->dict, job->word, &answer->result.suggestions);
+    }
+    dictionary_worker_measure_end(worker, DictionaryStatsOpSearch, false);
+    dictionary_worker_post(worker, job);
+}
+
+static void
+    dictionary_worker_random_job(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    DictionaryWorkerAnswer* answer = &worker->answer;
+    dictionary_worker_answer_clear(answer);
+    answer->result.random = true;
+
+    if(!dictionary_worker_is_current(worker, job)) return;
+    dictionary_worker_measure_start(worker);
+    DictionaryRecord record;
+    answer->result.status = dictionary_pick(worker->dict, &worker->rng, job->flag, &record);
+    if(answer->result.status == DictionaryStatusOk) {
+        dictionary_worker_answer_record(worker, &record);
+    }
+    dictionary_worker_measure_end(worker, DictionaryStatsOpRandom, false);
+    dictionary_worker_post(worker, job);
+}
+
+static void
+    dictionary_worker_reverse_job(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    DictionaryWorkerAnswer* answer = &worker->answer;
+    dictionary_worker_answer_clear(answer);
+    answer->result.reverse = true;
+    strcpy(answer->result.word, job->word);
+
+    if(!dictionary_worker_is_current(worker, job)) return;
+    dictionary_worker_measure_start(worker);
+    answer->result.status =
+        dictionary_reverse_search(worker->dict, job->word, &answer->result.matches);
+    dictionary_worker_measure_end(worker, DictionaryStatsOpReverse, false);
+    dictionary_worker_post(worker, job);
+}
+
+static void
+    dictionary_worker_pattern_job(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    DictionaryWorkerAnswer* answer = &worker->answer;
+    dictionary_worker_answer_clear(answer);
+    answer->result.pattern = true;
+    strcpy(answer->result.word, job->word);
+
+    if(!dictionary_worker_is_current(worker, job)) return;
+    dictionary_worker_measure_start(worker);
+    if(!worker->patterns) {
+        dictionary_worker_lock(worker);
+        size_t budget = worker->patterns_budget;
+        dictionary_worker_unlock(worker);
+        worker->patterns = dictionary_patterns_alloc(worker->dict, budget);
+        if(worker->patterns) {
+            FURI_LOG_I(
+                TAG,
+                "Signatures: %u bytes in RAM",
+                (unsigned)dictionary_patterns_get_size(worker->patterns));
+        }
+    }
+    answer->result.status =
+        worker->patterns ? dictionary_patterns_search(
+                               worker->patterns, job->word, job->flag, &answer->result.patterns) :
+                           DictionaryStatusReadError;
+    dictionary_worker_measure_end(worker, DictionaryStatsOpPattern, false);
+    dictionary_worker_post(worker, job);
+}
+
+typedef struct {
+    Stream* stream;
+    bool failed;
+} DictionaryWorkerWriter;
+
+static void dictionary_worker_writer_write(void* context, const char* text, size_t length) {
+    DictionaryWorkerWriter* writer = context;
+    if(stream_write(writer->stream, (const uint8_t*)text, length) != length) {
+        writer->failed = true;
+    }
+}
+
+typedef struct {
+    DictionaryWorker* worker;
+    const DictionaryWorkerJob* job;
+} DictionaryWorkerBatch;
+
+// Called every few entries; a cancelled run stops
+static bool
+    dictionary_worker_glossary_progress(void* context, const DictionaryBatchProgress* progress) {
+    DictionaryWorkerBatch* batch = context;
+    DictionaryWorker* worker = batch->worker;
+    dictionary_worker_lock(worker);
+    worker->progress = *progress;
+    worker->progress_generation = batch->job->generation;
+    worker->progress_ready = true;
+    dictionary_worker_unlock(worker);
+    worker->callback(worker->context, DictionaryWorkerEventProgress);
+    return dictionary_worker_is_current(worker, batch->job);
+}
+
+static void
+    dictionary_worker_glossary_job(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    DictionaryWorkerAnswer* answer = &worker->answer;
+    dictionary_worker_answer_clear(answer);
+    answer->result.glossary = true;
+
+    if(!dictionary_worker_is_current(worker, job)) return;
+    dictionary_worker_measure_start(worker);
+    dictionary_worker_lock(worker);
+    const char* list_path = worker->glossary_list;
+    const char* glossary_path = worker->glossary_path;
+    const char* runs_path = worker->glossary_runs;
+    size_t budget = worker->glossary_budget;
+    dictionary_worker_unlock(worker);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* file_stream = buffered_file_stream_alloc(storage);
+    DictionaryWorkerWriter writer = {file_stream, false};
+    writer.failed =
+        !buffered_file_stream_open(file_stream, glossary_path, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if(!writer.failed) {
+        DictionaryOutput out = {dictionary_worker_writer_write, &writer};
+        DictionaryWorkerBatch batch = {worker, job};
+        answer->result.status = dictionary_batch_write(
+            worker->dict,
+            list_path,
+            runs_path,
+            budget,
+            &out,
+            dictionary_worker_glossary_progress,
+            &batch,
+            &answer->result.batch.progress);
+    }
+    writer.failed = !buffered_file_stream_close(file_stream) || writer.failed;
+    stream_free(file_stream);
+    furi_record_close(RECORD_STORAGE);
+    answer->result.batch.saved = !writer.failed;
+    dictionary_worker_lock(worker);
+    worker->progress_ready = false; // the result has the final counts
+    dictionary_worker_unlock(worker);
+    dictionary_worker_measure_end(worker, DictionaryStatsOpGlossary, false);
+    dictionary_worker_post(worker, job);
+}
+
+// Reads `word` into the cache unless it is there already or other jobs are
+// waiting
+static void dictionary_worker_prefetch_word(DictionaryWorker* worker, const char* word) {
+    if(!dictionary_worker_is_idle(worker) || dictionary_cache_peek(worker->cache, word, NULL)) {
+        return;
+    }
+    DictionaryRecord record;
+    if(dictionary_find(worker->dict, word, &record) == DictionaryStatusOk) {
+        FURI_LOG_D(TAG, "Prefetch %s", record.key);
+        dictionary_worker_cache_record(worker, &record);
+    }
+}
+
+static void
+    dictionary_worker_complete_job(DictionaryWorker* worker, const DictionaryWorkerJob* job) {
+    // A later completion (or search) makes this one useless
+    if(!dictionary_worker_is_idle(worker)) return;
+
+    DictionaryCompletions completions;
+    if(!dictionary_worker_is_current(worker, job)) return;
+    dictionary_completer_update(worker->completer, job->word, &completions);
+    dictionary_check_files(worker->dict);
+    dictionary_worker_lock(worker);
+    worker->completions = completions;
+    worker->completions_generation = job->generation;
+    worker->completions_ready = true;
+    dictionary_worker_unlock(worker);
+    worker->callback(worker->context, DictionaryWorkerEventCompletions);
+
+    // Few keys left: the user is likely to submit the first one
+    if(completions.count > 0 && completions.matches <= DICTIONARY_WORKER_PREFETCH_MATCHES) {
+        if(!dictionary_worker_is_current(worker, job)) return;
+        dictionary_worker_prefetch_word(worker, completions.words[0]);
+    }
+}
+
+static int32_t dictionary_worker_thread(void* context) {
+    DictionaryWorker* worker = context;
+    DictionaryWorkerJob job;
+    for(;;) {
+        furi_check(
+            furi_message_queue_get(worker->queue, &job, FuriWaitForever) == FuriStatusOk);
+        switch(job.type) {
+        case DictionaryWorkerJobSearch:
+            dictionary_worker_search_job(worker, &job);
+            break;
+        case DictionaryWorkerJobRandom:
+            dictionary_worker_random_job(worker, &job);
+            break;
+        case DictionaryWorkerJobReverse:
+            dictionary_worker_reverse_job(worker, &job);
+            break;
+        case DictionaryWorkerJobPattern:
+            dictionary_worker_pattern_job(worker, &job);
+            break;
+        case DictionaryWorkerJobGlossary:
+            dictionary_worker_glossary_job(worker, &job);
+            break;
+        case DictionaryWorkerJobRelease:
+            // Not skipped by a cancel: the memory is wanted back either way
+            dictionary_patterns_free(worker->patterns);
+            worker->patterns = NULL;
+            break;
+        case DictionaryWorkerJobComplete:
+            dictionary_worker_complete_job(worker, &job);
+            break;
+        case DictionaryWorkerJobPrefetch:
+            if(dictionary_worker_is_current(worker, &job)) {
+                dictionary_worker_prefetch_word(worker, job.word);
+            }
+            break;
+        case DictionaryWorkerJobStop:
+            return 0;
+        }
+    }
+}
+
+DictionaryWorker* dictionary_worker_alloc(
+    Dictionary* dict,
+    DictionaryCache* cache,
+    uint64_t seed,
+    DictionaryWorkerCallback callback,
+    void* context) {
+    DictionaryWorker* worker = malloc(sizeof(DictionaryWorker));
+    memset(worker, 0, sizeof(DictionaryWorker));
+    worker->dict = dict;
+    worker->cache = cache;
+    worker->completer = dictionary_completer_alloc(dict);
+    dictionary_rng_seed(&worker->rng, seed);
+    worker->callback = callback;
+    worker->context = context;
+#ifdef DICTIONARY_STATS
+    dictionary_stats_reset(&worker->stats);
+#endif
+    worker->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    worker->queue =
+        furi_message_queue_alloc(DICTIONARY_WORKER_QUEUE_SIZE, sizeof(DictionaryWorkerJob));
+    worker->thread = furi_thread_alloc_ex(
+        TAG, DICTIONARY_WORKER_STACK_SIZE, dictionary_worker_thread, worker);
+    furi_thread_start(worker->thread);
+    return worker;
+}
+
+// Queues a job in the current generation. Jobs the user waits for block
+// while the queue is full; the others are dropped.
+static void dictionary_worker_queue(
+    DictionaryWorker* worker,
+    DictionaryWorkerJobType type,
+    const char* word,
+    bool flag,
+    bool wait) {
+    DictionaryWorkerJob job = {.type = type, .flag = flag};
+    if(word) {
+        strncpy(job.word, word, MAX_WORD_LENGTH - 1);
+        job.word[MAX_WORD_LENGTH - 1] = '\0';
+    }
+    job.generation = atomic_load(&worker->generation);
+    if(furi_message_queue_put(worker->queue, &job, wait ? FuriWaitForever : 0) !=
+       FuriStatusOk) {
+        FURI_LOG_D(TAG, "Queue full, job dropped");
+    }
+}
+
+void dictionary_worker_free(DictionaryWorker* worker) {
+    furi_assert(worker);
+    dictionary_worker_cancel(worker);
+    dictionary_worker_queue(worker, DictionaryWorkerJobStop, NULL, false, true);
+    furi_thread_join(worker->thread);
+    furi_thread_free(worker->thread);
+#ifdef DICTIONARY_STATS
+    for(uint8_t op = 0; op < DictionaryStatsOpCount; op++) {
+        const DictionaryStatsTotals* totals = &worker->stats.totals[op];
+        if(totals->lookups == 0) continue;
+        uint32_t p50 = 0, p99 = 0;
+        dictionary_stats_get_percentiles(&worker->stats, op, &p50, &p99);
+        FURI_LOG_I(
+            TAG,
+            "Stats %s: %lu lookups, %lu cached, %lu failed, %lu seeks, %lu reads, %lu bytes, "
+            "p50 %lu ms, p99 %lu ms",
+            dictionary_stats_op_get_name(op),
+            totals->lookups,
+            totals->cache_hits,
+            totals->failures,
+            totals->seeks,
+            totals->reads,
+            totals->bytes_read,
+            p50,
+            p99);
+    }
+#endif
+    furi_message_queue_free(worker->queue);
+    furi_mutex_free(worker->mutex);
+    dictionary_worker_answer_clear(&worker->answer);
+    dictionary_worker_answer_clear(&worker->posted);
+    dictionary_worker_answer_clear(&worker->shown);
+    dictionary_patterns_free(worker->patterns);
+    dictionary_completer_free(worker->completer);
+    free(worker);
+}
+
+void dictionary_worker_cancel(DictionaryWorker* worker) {
+    atomic_fetch_add(&worker->generation, 1);
+}
+
+void dictionary_worker_search(DictionaryWorker* worker, const char* word, bool suggest) {
+    // Whatever was queued before is of no use now
+    dictionary_worker_cancel(worker);
+    dictionary_worker_queue(worker, DictionaryWorkerJobSearch, word, suggest, true);
+}
+
+void dictionary_worker_random(DictionaryWorker* worker, bool weighted) {
+    dictionary_worker_cancel(worker);
+    dictionary_worker_queue(worker, DictionaryWorkerJobRandom, NULL, weighted, true);
+}
+
+void dictionary_worker_reverse(DictionaryWorker* worker, const char* query) {
+    dictionary_worker_cancel(worker);
+    dictionary_worker_queue(worker, DictionaryWorkerJobReverse, query, false, true);
+}
+
+void dictionary_worker_pattern(
+    DictionaryWorker* worker,
+    const char* query,
+    bool anagram,
+    size_t ram_budget) {
+    dictionary_worker_cancel(worker);
+    dictionary_worker_lock(worker);
+    worker->patterns_budget = ram_budget;
+    dictionary_worker_unlock(worker);
+    dictionary_worker_queue(worker, DictionaryWorkerJobPattern, query, anagram, true);
+}
+
+void dictionary_worker_glossary(
+    DictionaryWorker* worker,
+    const char* list_path,
+    const char* glossary_path,
+    const char* runs_path,
+    size_t ram_budget) {
+    dictionary_worker_cancel(worker);
+    dictionary_worker_lock(worker);
+    worker->glossary_list = list_path;
+    worker->glossary_path = glossary_path;
+    worker->glossary_runs = runs_path;
+    worker->glossary_budget = ram_budget;
+    dictionary_worker_unlock(worker);
+    dictionary_worker_queue(worker, DictionaryWorkerJobGlossary, NULL, false, true);
+}
+
+void dictionary_worker_release_patterns(DictionaryWorker* worker) {
+    dictionary_worker_queue(worker, DictionaryWorkerJobRelease, NULL, false, true);
+}
+
+void dictionary_worker_complete(DictionaryWorker* worker, const char* prefix) {
+    dictionary_worker_queue(worker, DictionaryWorkerJobComplete, prefix, false, false);
+}
+
+void dictionary_worker_prefetch(DictionaryWorker* worker, const char* word) {
+    dictionary_worker_queue(worker, DictionaryWorkerJobPrefetch, word, false, false);
+}
+
+// The text sources of a result read the copy the worker made: the GUI
+// thread owns `shown` once it took it
+static size_t
+    dictionary_worker_source_read(void* context, uint32_t pos, char* buffer, size_t size) {
+    const DictionaryWorkerAnswer* shown = context;
+    if(pos >= shown->length) return 0;
+    size_t count = MIN(size, shown->length - pos);
+    memcpy(buffer, shown->text + pos, count);
+    return count;
+}
+
+static bool dictionary_worker_source_read_line(
+    void* context,
+    uint32_t line,
+    DictionaryFormatState* state) {
+    const DictionaryWorkerAnswer* shown = context;
+    if(line >= shown->lines) return false;
+    dictionary_layout_decode(
+        shown->text + shown->length + line * DICTIONARY_LAYOUT_ENTRY_SIZE, state);
+    return true;
+}
+
+bool dictionary_worker_get_result(
+    DictionaryWorker* worker,
+    DictionaryWorkerResult* result,
+    DictionaryTextSource* source) {
+    dictionary_worker_lock(worker);
+    bool ready = worker->posted_ready &&
+                 worker->posted.generation == atomic_load(&worker->generation);
+    if(ready) {
+        dictionary_worker_answer_clear(&worker->shown);
+        worker->shown = worker->posted;
+        worker->posted.text = NULL;
+        worker->posted_ready = false;
+        *result = worker->shown.result;
+    }
+    dictionary_worker_unlock(worker);
+    if(ready) {
+        source->read = dictionary_worker_source_read;
+        source->read_line = worker->shown.lines > 0 ? dictionary_worker_source_read_line : NULL;
+        source->context = &worker->shown;
+        source->length = worker->shown.length;
+        source->lines = worker->shown.lines;
+    }
+    return ready;
+}
+
+bool dictionary_worker_get_completions(
+    DictionaryWorker* worker,
+    DictionaryCompletions* completions) {
+    dictionary_worker_lock(worker);
+    bool ready = worker->completions_ready &&
+                 worker->completions_generation == atomic_load(&worker->generation);
+    if(ready) {
+        *completions = worker->completions;
+        worker->completions_ready = false;
+    }
+    dictionary_worker_unlock(worker);
+    return ready;
+}
+
+bool dictionary_worker_get_progress(DictionaryWorker* worker, DictionaryBatchProgress* progress) {
+    dictionary_worker_lock(worker);
+    bool ready = worker->progress_ready &&
+                 worker->progress_generation == atomic_load(&worker->generation);
+    if(ready) {
+        *progress = worker->progress;
+        worker->progress_ready = false;
+    }
+    dictionary_worker_unlock(worker);
+    return ready;
+}
+
+#ifdef DICTIONARY_STATS
+void dictionary_worker_write_stats(DictionaryWorker* worker, DictionaryOutput* out, bool csv) {
+    dictionary_worker_lock(worker);
+    if(csv) {
+        dictionary_stats_write_csv(&worker->stats, out);
+    } else {
+        dictionary_stats_write_summary(&worker->stats, out);
+    }
+    dictionary_worker_unlock(worker);
+}
+#endif
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "dictionary_batch.h"
+#include "dictionary_cache.h"
+#include "dictionary_complete.h"
+#include "dictionary_pattern.h"
+#include "dictionary_reverse.h"
+#include "dictionary_stats.h"
+#include "dictionary_suggest.h"
+
+// Lookup thread. Searches, reverse lookups, pattern searches, random picks,
+// glossaries and completions are queued to it, so the GUI thread never waits for
+// the SD card; the result is handed back through a callback that runs on the
+// worker thread and only has to post an event to the GUI
+// (view_dispatcher_send_custom_event()).
+//
+// Once started the worker owns the dictionary, the cache and the completer;
+// the GUI thread does not touch them. A result comes with a copy of its
+// definition in RAM, which its text source reads while the result is shown.
+// The worker's lock guards only what the threads hand each other and is
+// never held across a read of the card. Every job carries the generation it
+// was queued in, an atomic counter; cancelling starts a new one, so queued
+// jobs are skipped and a running one stops at its next step without posting
+// anything.
+//
+// When it has nothing else to do the worker prefetches words likely to be
+// looked up next into the cache: the first history items, and the
+// completion while a typed prefix has narrowed down to a few keys.
+
+// Stack of the worker thread. The deepest path is a glossary entry, about
+// 2 KB of frames from the job through the join and the formatter down to the
+// gloss list (measured with -fstack-usage; a suggestion search on a miss takes
+// 1.5 KB) plus the storage calls and logging.
+#define DICTIONARY_WORKER_STACK_SIZE (4 * 1024)
+// Jobs waiting; completions and prefetches are dropped rather than waited
+// for when the queue is full
+#define DICTIONARY_WORKER_QUEUE_SIZE 8
+// A completion with at most this many matches is prefetched
+#define DICTIONARY_WORKER_PREFETCH_MATCHES 4
+// Longest definition copied for the result view, laid-out lines included (the
+// shipped data's longest is 4219 bytes). A longer one is cut off there and its
+// lines are formatted as they are shown.
+#define DICTIONARY_WORKER_TEXT_MAX (8 * 1024)
+
+typedef enum {
+    DictionaryWorkerEventResult, // dictionary_worker_get_result()
+    DictionaryWorkerEventCompletions, // dictionary_worker_get_completions()
+    DictionaryWorkerEventProgress, // dictionary_worker_get_progress()
+} DictionaryWorkerEvent;
+
+typedef struct {
+    DictionaryBatchProgress progress;
+    bool saved; // the glossary file was written without error
+} DictionaryWorkerGlossary;
+
+typedef void (*DictionaryWorkerCallback)(void* context, DictionaryWorkerEvent event);
+
+typedef struct {
+    DictionaryStatus status; // Ok when the entry was found
+    char word[MAX_WORD_LENGTH]; // as searched, or the picked headword
+    // The inflected form searched when `word` is its lemma, else empty
+    char form[MAX_WORD_LENGTH];
+    bool random;
+    bool reverse; // `word` is the description looked up
+    bool pattern; // `word` is the pattern or the letters of an anagram
+    bool glossary; // `word` is empty
+    union {
+        DictionarySuggestions suggestions; // on a miss, when asked for
+        DictionaryReverseResults matches; // of a reverse lookup
+        DictionaryPatternResults patterns; // of a pattern search
+        DictionaryWorkerGlossary batch; // of a glossary
+    };
+} DictionaryWorkerResult;
+
+typedef struct DictionaryWorker DictionaryWorker;
+
+DictionaryWorker* dictionary_worker_alloc(
+    Dictionary* dict,
+    DictionaryCache* cache,
+    uint64_t seed, // of the random word picker
+    DictionaryWorkerCallback callback,
+    void* context);
+
+// Stops the thread; the dictionary and the cache are the caller's again
+void dictionary_worker_free(DictionaryWorker* worker);
+
+// Skips the jobs queued so far and drops the result of the running one
+void dictionary_worker_cancel(DictionaryWorker* worker);
+
+// Looks up `word`; with `suggest` set a miss comes with suggestions
+void dictionary_worker_search(DictionaryWorker* worker, const char* word, bool suggest);
+
+void dictionary_worker_random(DictionaryWorker* worker, bool weighted);
+
+// Lists the headwords whose definitions use the words of `query`
+void dictionary_worker_reverse(DictionaryWorker* worker, const char* query);
+
+// Lists the keys matching a crossword pattern or, with `anagram` set, spelt
+// with the letters of `query`. The signature table is loaded on the first
+// one, into RAM if it fits `ram_budget`, and kept until released.
+void dictionary_worker_pattern(
+    DictionaryWorker* worker,
+    const char* query,
+    bool anagram,
+    size_t ram_budget);
+
+// Frees the signature table of the pattern searches
+void dictionary_worker_release_patterns(DictionaryWorker* worker);
+
+// Writes the glossary of the word list at `list_path` to `glossary_path`
+// (dictionary_batch.h), sorting runs of up to `ram_budget` bytes of words
+// into the scratch file `runs_path` and posting its progress as it goes. The
+// paths must stay valid until the result is posted. A cancel stops it
+// between two entries, leaving the file as far as it got and posting nothing.
+void dictionary_worker_glossary(
+    DictionaryWorker* worker,
+    const char* list_path,
+    const char* glossary_path,
+    const char* runs_path,
+    size_t ram_budget);
+
+// Completions of a prefix. Only the latest queued one is computed.
+void dictionary_worker_complete(DictionaryWorker* worker, const char* prefix);
+
+// Reads `word` into the cache if the worker is idle by then
+void dictionary_worker_prefetch(DictionaryWorker* worker, const char* word);
+
+// Copies the latest result; false if it is stale (queued before a cancel)
+// or was taken already. On success `source` reads the entry's definition,
+// and its lines when they are laid out ahead (dictionary_layout.h), from
+// RAM until the next result is taken.
+bool dictionary_worker_get_result(
+    DictionaryWorker* worker,
+    DictionaryWorkerResult* result,
+    DictionaryTextSource* source);
+
+// Like get_result, for the latest completions
+bool dictionary_worker_get_completions(
+    DictionaryWorker* worker,
+    DictionaryCompletions* completions);
+
+// Like get_result, for the latest progress of a glossary
+bool dictionary_worker_get_progress(DictionaryWorker* worker, DictionaryBatchProgress* progress);
+
+#ifdef DICTIONARY_STATS
+// Writes the statistics of the lookups run so far: the summary, or with
+// `csv` set the recent samples
+void dictionary_worker_write_stats(DictionaryWorker* worker, DictionaryOutput* out, bool csv);
+#endif
@@ -0,0 +1,2169 @@
+#!/usr/bin/env python3
+"""Dictionary compiler for the EngDict Flipper app.
+
+Builds engdict.idx and engdict.dat from WordNet glosses and CMUdict
+phonetics, optionally restricted to a word list, and checks the result.
+It also reads an existing engdict.idx (legacy, v2 or v3) and writes the
+current index layout, or models the SD operations a device lookup costs on
+each layout, and generates made-up dictionaries of any size for benchmarks.
+The v2 index carries the fixed-stride record table (RECS), a front-coded
+block index (FCIX) that the app keeps in RAM, a deletion-neighbourhood
+hash (DELS) for "did you mean" suggestions, an alias table (RAND) for
+frequency-weighted random picks, an inverted index of the definitions
+(TERM) for reverse lookup, a perfect hash of the keys (HASH) for exact
+lookups, a map of inflected forms to their lemma (INFL), the keys by sound
+(SNDX) for sound-alike suggestions, letter signatures of the keys (SIGS)
+for wildcard and anagram queries, the gloss lists (GLOS) of an
+engdict.dat that stores each gloss once and where each line of a definition
+starts on the result screen (LINE). A v3 index is the same with
+u32 definition lengths, written only when a definition is over 64 KB.
+
+It also block-compresses engdict.dat so the app only decompresses the block
+holding a definition; the index is unchanged, offsets stay uncompressed.
+And it compiles the most common entries into a C header the app build links
+into the .fap, so they are looked up without touching the card.
+
+    python3 tools/dictc.py build --wordnet wn/dict --cmudict cmudict.dict -o files
+    python3 tools/dictc.py convert files/engdict.idx [--frequency words.txt] [--dedup]
+    python3 tools/dictc.py stats files/engdict.idx
+    python3 tools/dictc.py compress files/engdict.dat -o engdict.dat
+    python3 tools/dictc.py synth --entries 100000 -o /tmp/synth
+    python3 tools/dictc.py hot files/engdict.idx --count 32 -o dictionary_hot_table.h
+"""
+
+import argparse
+import bisect
+import os
+import random
+import re
+import struct
+import sys
+from collections import Counter
+
+IDX_MAGIC = b"EDIX"
+IDX_VERSION = 2
+# v3 differs only in RECS: u32 definition lengths, for definitions over 64 KB
+IDX_VERSION_WIDE = 3
+IDX_HEADER = struct.Struct("<4sHHIHBB")
+IDX_SECTION = struct.Struct("<4sII")
+REC_HEAD = struct.Struct("<IHB")
+REC_HEAD_WIDE = struct.Struct("<IIB")
+FCIX_HEAD = struct.Struct("<HHIIII")
+DELS_HEAD = struct.Struct("<IIII")
+RAND_HEAD = struct.Struct("<IIII")
+RAND_ENTRY = struct.Struct("<II")
+TERM_HEAD = struct.Struct("<IIII")
+TERM_ENTRY = struct.Struct("<III")
+HASH_HEAD = struct.Struct("<IIII")
+INFL_HEAD = struct.Struct("<IIII")
+SNDX_HEAD = struct.Struct("<IIII")
+SIGS_HEAD = struct.Struct("<IIII")
+GLOS_HEAD = struct.Struct("<IIII")
+LINE_HEAD = struct.Struct("<IIII")
+LINE_ENTRY = struct.Struct("<HH")
+DZ_MAGIC = b"EDDZ"
+DZ_VERSION = 1
+DZ_HEAD = struct.Struct("<4sHBBIIIHH")
+
+# Keys per front-coded block; must stay <= 255 (the device decodes with u8s)
+FCIX_BLOCK_KEYS = 64
+FCIX_MAX_BLOCK_KEYS = 255
+# Larger dictionaries get larger blocks, so the part of FCIX the app always
+# keeps in RAM (block directory, leader offsets and leaders) stays this small
+FCIX_RAM_TARGET = 16 * 1024
+
+# DELS entries pack a 12-bit hash fingerprint above a 20-bit record id
+DELS_ID_BITS = 20
+# Average entries per DELS bucket
+DELS_BUCKET_LOAD = 8
+
+# Average terms per TERM bucket
+TERM_BUCKET_LOAD = 4
+
+# HASH: average keys per bucket, each with one u16 displacement, and share
+# of the slots used; a few spare slots keep the displacements small
+HASH_BUCKET_LOAD = 5
+HASH_SLOT_LOAD = 0.99
+HASH_BASIS = 0x811C9DC5
+# Tried in turn as the basis of the slot hash until every bucket places
+HASH_SEEDS = (0x5BD1E995, 0x27D4EB2F, 0x165667B1, 0x9E3779B1, 0x85EBCA77, 0xC2B2AE3D)
+# INFL: slots per bucket (a lookup reads two buckets) and share of them used
+INFL_BUCKET_SLOTS = 16
+INFL_LOAD = 0.8
+# SNDX: letters of a sound code, headwords kept per code (the most common)
+# and entries per bucket at most (must match dictionary_sound.h)
+SOUND_CODE_LENGTH = 6
+SOUND_MAX_PER_CODE = 8
+SOUND_MAX_BUCKET = 48
+SOUND_BUCKET_LOAD = 8
+# CMUdict consonants in the code letters metaphone() gives their spellings
+SOUND_PHONES = {
+    "B": "B", "CH": "X", "D": "T", "DH": "0", "ER": "R", "F": "F", "G": "K", "JH": "J", "K": "K",
+    "L": "L", "M": "M", "N": "N", "NG": "NK", "P": "P", "R": "R", "S": "S", "SH": "X", "T": "T",
+    "TH": "0", "V": "F", "Z": "S", "ZH": "X",
+}
+# Irregular forms the suffix rules cannot make, as "form lemma" pairs. `build`
+# adds the exception lists of the WordNet database (noun.exc, verb.exc, ...).
+IRREGULAR_FORMS = """
+am be are be is be was be were be been be being be has have had have does do did do done do
+went go gone go goes go made make said say saw see seen see came come took take taken take
+got get gotten get gave give given give knew know known know thought think told tell
+found find felt feel left leave kept keep brought bring began begin begun begin ran run
+wrote write written write sat sit stood stand heard hear meant mean met meet paid pay
+held hold lost lose sent send built build spent spend fell fall fallen fall led lead
+understood understand spoke speak spoken speak broke break broken break chose choose
+chosen choose drove drive driven drive ate eat eaten eat drew draw drawn draw grew grow
+grown grow threw throw thrown throw flew fly flown fly wore wear worn wear rode ride
+ridden ride rose rise risen rise sang sing sung sing swam swim swum swim taught teach
+caught catch bought buy fought fight sought seek slept sleep sold sell won win hung hang
+shook shake shaken shake forgot forget forgotten forget froze freeze frozen freeze hid hide
+hidden hide bit bite bitten bite blew blow blown blow struck strike stuck stick dug dig
+fed feed fled flee lay lie lain lie laid lay sank sink sunk sink stole steal stolen steal
+swore swear sworn swear tore tear torn tear woke wake woken wake wove weave woven weave
+men man women woman children child feet foot teeth tooth geese goose mice mouse lice louse
+oxen ox people person dice die knives knife wives wife lives life leaves leaf halves half
+wolves wolf loaves loaf shelves shelf thieves thief calves calf selves self
+criteria criterion phenomena phenomenon data datum media medium bacteria bacterium
+analyses analysis crises crisis theses thesis indices index matrices matrix
+better good best good worse bad worst bad more much most much less little least little
+further far farthest far elder old eldest old
+"""
+
+# Terms longer than this are not indexed (must match dictionary_reverse.h)
+TERM_MAX_LENGTH = 24
+# Not indexed and dropped from queries (must match dictionary_reverse.c)
+STOPWORDS = frozenset(
+    "an and any are as at be but by for from has have how in into is it its "
+    "not of on or so such than that the their them then there these this those "
+    "to was were what when where which who whom whose why with".encode().split()
+)
+
+# Block-compressed engdict.dat defaults: 1 KB blocks whose back-references
+# reach up to 2 KB back, into a shared 1 KB preset dictionary before the block
+DZ_BLOCK_SIZE = 1024
+DZ_WINDOW_BITS = 11
+DZ_LOOKAHEAD_BITS = 4
+DZ_PRESET_SIZE = 1024
+
+# Hot word table compiled into the .fap (dictionary_hot.c): entries, their
+# longest definition, the first pair code and how deep codes may nest
+HOT_COUNT = 32
+HOT_MAX_LENGTH = 512
+HOT_FIRST_CODE = 0x80
+HOT_MAX_DEPTH = 8
+
+# Ranges of engdict.dat a definition is made of (GLOS); the glosses past the
+# last one are stored again as one. Must match DICTIONARY_GLOSS_MAX_RANGES.
+GLOSS_MAX_RANGES = 16
+GLOSS_SEPARATOR = b"; "
+# Index bytes per record for its gloss list (DICTIONARY_GLOSS_SLOT_SIZE)
+GLOSS_SLOT_SIZE = 8
+PHONES_PREFIX = re.compile(rb"\[[^\]]*\] ")
+
+# The result pager the LINE section is laid out for (dictionary_pager.h):
+# characters per line and bytes a line holds, and how far the formatter
+# looks for a closing "]" (DICTIONARY_FORMAT_WINDOW)
+LINE_COLUMNS = 20
+LINE_BYTES = 80
+FORMAT_WINDOW = 128
+# A LINE entry packs the sense count, pending spaces and an in-sense bit in a u16
+LINE_MAX_SENSES = 0x7FF
+LINE_MAX_PENDING = 0xF
+
+# Must match MAX_WORD_LENGTH in dictionary_index.h (buffer size, including NUL)
+MAX_WORD_LENGTH = 64
+# Record lengths are u16 in v2 indexes and u32 in v3; offsets are u32, so
+# engdict.dat stays under 4 GB (FAT32's limit anyway)
+MAX_DEFINITION_LENGTH = 0xFFFFFFFF
+
+# WordNet parts of speech in the order their senses are listed (that of
+# NLTK's wordnet.synsets(), which the shipped data follows)
+WORDNET_POS = ("adj", "adv", "noun", "verb")
+
+
+def device_key(word):
+    # The device compares with strcasecmp(), i.e. ASCII tolower() byte order
+    return word.lower().encode("ascii") if isinstance(word, str) else bytes(word).lower()
+
+
+class Record:
+    __slots__ = ("key", "offset", "length")
+
+    def __init__(self, key, offset, length):
+        self.key = key
+        self.offset = offset
+        self.length = length
+
+
+def parse_legacy(data):
+    records = []
+    pos = 0
+    while pos < len(data):
+        (key_len,) = struct.unpack_from("<H", data, pos)
+        pos += 2
+        key = data[pos : pos + key_len]
+        pos += key_len
+        offset, length = struct.unpack_from("<IH", data, pos)
+        pos += 6
+        records.append(Record(key, offset, length))
+    return records
+
+
+def parse_sections(data):
+    magic, version, section_count, record_count, stride, key_width, _ = IDX_HEADER.unpack_from(
+        data, 0
+    )
+    if magic != IDX_MAGIC:
+        return None
+    if version not in (IDX_VERSION, IDX_VERSION_WIDE):
+        sys.exit(f"unsupported index version {version}")
+    sections = {}
+    for i in range(section_count):
+        tag, offset, size = IDX_SECTION.unpack_from(data, IDX_HEADER.size + i * IDX_SECTION.size)
+        sections[tag] = (offset, size)
+    return record_count, stride, key_width, sections, version
+
+
+def parse_v2(data, header):
+    record_count, stride, _, sections, version = header
+    rec_head = REC_HEAD_WIDE if version == IDX_VERSION_WIDE else REC_HEAD
+    base, _ = sections[b"RECS"]
+    records = []
+    for i in range(record_count):
+        offset, length, key_len = rec_head.unpack_from(data, base + i * stride)
+        key_pos = base + i * stride + rec_head.size
+        records.append(Record(data[key_pos : key_pos + key_len], offset, length))
+    return records
+
+
+def load_index(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    header = parse_sections(data) if len(data) >= IDX_HEADER.size else None
+    return parse_v2(data, header) if header else parse_legacy(data)
+
+
+def validate(records):
+    for prev, cur in zip(records, records[1:]):
+        if device_key(prev.key) >= device_key(cur.key):
+            sys.exit(f"index not in strcasecmp order: {prev.key!r} >= {cur.key!r}")
+    for rec in records:
+        if len(rec.key) >= MAX_WORD_LENGTH:
+            sys.exit(f"key longer than MAX_WORD_LENGTH - 1: {rec.key!r}")
+
+
+def build_legacy(records):
+    out = bytearray()
+    for rec in records:
+        # Only modelled by `stats`; legacy lengths are u16
+        length = min(rec.length, 0xFFFF)
+        out += struct.pack("<H", len(rec.key)) + rec.key + struct.pack("<IH", rec.offset, length)
+    return bytes(out)
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def read_varint(data, pos):
+    """(value, position after it) of a varint()."""
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, pos
+
+
+def shared_prefix(a, b):
+    n = 0
+    while n < min(len(a), len(b)) and a[n] == b[n]:
+        n += 1
+    return n
+
+
+def fcix_block_keys(records):
+    """FCIX_BLOCK_KEYS, doubled (up to 255) while the part of FCIX that stays
+    in RAM would exceed FCIX_RAM_TARGET. Lookups then read one block of the
+    same few hundred bytes to a few KB whatever the dictionary size."""
+    block_keys = FCIX_BLOCK_KEYS
+    while block_keys < FCIX_MAX_BLOCK_KEYS:
+        leaders = records[::block_keys]
+        ram = 8 * len(leaders) + 4 + sum(len(r.key) + 1 for r in leaders)
+        if ram <= FCIX_RAM_TARGET:
+            break
+        block_keys = min(FCIX_MAX_BLOCK_KEYS, block_keys * 2)
+    return block_keys
+
+
+def build_fcix(records, block_keys=None):
+    """Front-coded key blocks plus a directory of block-leading keys.
+
+    Each block starts with the u32 offset of its first definition; entries
+    are [u8 shared][u8 suffix len][suffix]([varint gap])[varint length],
+    front-coded against the previous key (the block leader for entry 0).
+    Definitions normally follow each other in engdict.dat, so the gap to the
+    previous one is only stored when bit 7 of the suffix length is set.
+    """
+    block_keys = block_keys or fcix_block_keys(records)
+    if not 0 < block_keys <= FCIX_MAX_BLOCK_KEYS:
+        sys.exit(f"FCIX: {block_keys} keys per block, must be 1 to {FCIX_MAX_BLOCK_KEYS}")
+    leaders = bytearray()
+    blocks = bytearray()
+    block_offsets = []
+    max_block = 0
+    for start in range(0, len(records), block_keys):
+        chunk = records[start : start + block_keys]
+        leader = chunk[0].key
+        leaders += bytes([len(leader)]) + leader
+
+        block = bytearray(struct.pack("<I", chunk[0].offset))
+        prev_key, prev_end = leader, chunk[0].offset
+        for rec in chunk:
+            if rec.offset < prev_end:
+                sys.exit(f"definitions out of key order at {rec.key!r}")
+            shared = shared_prefix(prev_key, rec.key)
+            gap = rec.offset - prev_end
+            block += bytes([shared, (len(rec.key) - shared) | (0x80 if gap else 0)])
+            block += rec.key[shared:] + (varint(gap) if gap else b"") + varint(rec.length)
+            prev_key, prev_end = rec.key, rec.offset + rec.length
+        block_offsets.append(len(blocks))
+        blocks += block
+        max_block = max(max_block, len(block))
+    block_offsets.append(len(blocks))
+
+    head = FCIX_HEAD.pack(block_keys, max_block, len(block_offsets) - 1, len(leaders), len(blocks), 0)
+    directory = b"".join(struct.pack("<I", o) for o in block_offsets)
+    return head + directory + bytes(leaders) + bytes(blocks)
+
+
+def fnv1a(data, basis=0x811C9DC5):
+    h = basis
+    for b in data:
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def fmix32(h):
+    """MurmurHash3's finalizer."""
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & 0xFFFFFFFF
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & 0xFFFFFFFF
+    return h ^ (h >> 16)
+
+
+def hash_slot(slot_hash, displacement, slot_count):
+    return fmix32(slot_hash ^ ((displacement * 0x9E3779B9) & 0xFFFFFFFF)) % slot_count
+
+
+def place_hash(keys, bucket_count, slot_count, seed):
+    """Displacement of each bucket, or None if one cannot be placed."""
+    buckets = [[] for _ in range(bucket_count)]
+    for key in keys:
+        buckets[fnv1a(key, HASH_BASIS) % bucket_count].append(fnv1a(key, seed))
+    used = bytearray(slot_count)
+    displacements = [0] * bucket_count
+    for b in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+        hashes = buckets[b]
+        if not hashes:
+            break
+        for d in range(0x10000):
+            slots = {hash_slot(h, d, slot_count) for h in hashes}
+            if len(slots) == len(hashes) and not any(used[x] for x in slots):
+                break
+        else:
+            return None
+        for x in slots:
+            used[x] = 1
+        displacements[b] = d
+    return displacements
+
+
+def build_hash(records, recs, stride):
+    """Perfect hash of the keys for exact lookups, CHD style.
+
+    A key's FNV-1a hash picks its bucket; the bucket's u16 displacement d
+    then puts it in slot fmix32(h ^ d * 0x9E3779B9) % slot_count, h being
+    the key's FNV-1a hash from the seed basis. The builder tries the largest
+    buckets first and each d in turn until the bucket's keys land in free,
+    distinct slots. A slot is the u32 record id followed by a copy of the
+    RECS record, so one read finds and verifies the key; empty slots have id
+    0xFFFFFFFF. The displacements are padded to 4 bytes.
+    """
+    keys = [device_key(rec.key) for rec in records]
+    bucket_count = max(1, (len(keys) + HASH_BUCKET_LOAD - 1) // HASH_BUCKET_LOAD)
+    slot_count = max(len(keys), int(len(keys) / HASH_SLOT_LOAD))
+    for seed in HASH_SEEDS:
+        displacements = place_hash(keys, bucket_count, slot_count, seed)
+        if displacements:
+            break
+    else:
+        sys.exit("HASH: no seed places every key")
+
+    slots = [None] * slot_count
+    for i, key in enumerate(keys):
+        d = displacements[fnv1a(key, HASH_BASIS) % bucket_count]
+        slots[hash_slot(fnv1a(key, seed), d, slot_count)] = i
+    out = bytearray(HASH_HEAD.pack(bucket_count, slot_count, seed, 4 + stride))
+    out += struct.pack(f"<{bucket_count}H", *displacements)
+    out += bytes(-len(out) % 4)
+    for i in slots:
+        if i is None:
+            out += struct.pack("<I", 0xFFFFFFFF) + bytes(stride)
+        else:
+            out += struct.pack("<I", i) + recs[i * stride : (i + 1) * stride]
+    return bytes(out)
+
+
+def inflect(word):
+    """Regular inflections of a lemma, the reverse of WordNet's morphy()
+    suffix rules: plural or third person, past, present participle and, for
+    words of up to six letters, comparative and superlative. A final
+    consonant after a single vowel is doubled in one-syllable words."""
+    vowels = b"aeiou"
+    y_after_consonant = len(word) >= 2 and word[-1:] == b"y" and word[-2] not in vowels
+    syllables = sum(1 for c in word if c in vowels)
+    doubled = (
+        len(word) >= 3
+        and syllables == 1
+        and word[-1] not in vowels + b"wxy"
+        and word[-2] in vowels
+        and word[-3] not in vowels
+    )
+    stem = word + word[-1:] if doubled else word
+    forms = []
+    if word.endswith((b"s", b"x", b"z", b"ch", b"sh")):
+        forms.append(word + b"es")
+    elif y_after_consonant:
+        forms.append(word[:-1] + b"ies")
+    else:
+        forms.append(word + b"s")
+    if word.endswith(b"man"):
+        forms.append(word[:-3] + b"men")
+    if word.endswith(b"e"):
+        forms.append(word + b"d")
+    elif y_after_consonant:
+        forms.append(word[:-1] + b"ied")
+    else:
+        forms.append(stem + b"ed")
+    if word.endswith(b"ie"):
+        forms.append(word[:-2] + b"ying")
+    elif word.endswith(b"e") and not word.endswith((b"ee", b"ye", b"oe")):
+        forms.append(word[:-1] + b"ing")
+    else:
+        forms.append(stem + b"ing")
+    if len(word) <= 6:
+        if word.endswith(b"e"):
+            forms += [word + b"r", word + b"st"]
+        elif y_after_consonant:
+            forms += [word[:-1] + b"ier", word[:-1] + b"iest"]
+        else:
+            forms += [stem + b"er", stem + b"est"]
+    return forms
+
+
+def parse_exceptions(directory):
+    """(form, lemma) pairs of WordNet's morphological exception lists."""
+    pairs = []
+    for pos in WORDNET_POS:
+        path = os.path.join(directory, f"{pos}.exc")
+        if not os.path.exists(path):
+            continue
+        with open(path, encoding="utf-8") as f:
+            for line in f:
+                fields = line.split()
+                if len(fields) >= 2 and "_" not in line:
+                    pairs += [(fields[0].encode(), lemma.encode()) for lemma in fields[1:]]
+    return pairs
+
+
+def place_infl(homes, bucket_count, slots):
+    """Entries per bucket, each in its home bucket or the next; None if they
+    do not fit. `homes` holds (home bucket, entry) pairs."""
+    by_home = [[] for _ in range(bucket_count + 1)]
+    for home, entry in homes:
+        by_home[home].append(entry)
+    buckets, spill = [], []
+    for own in by_home:
+        if len(spill) > slots:
+            return None
+        room = slots - len(spill)
+        buckets.append(spill + own[:room])
+        spill = own[room:]
+    return None if spill else buckets
+
+
+def build_infl(records, weights=None, exceptions=()):
+    """Inflected forms that are not headwords, mapped to their lemma.
+
+    Forms come from inflect() for every single-word lemma and from the
+    irregular pairs (IRREGULAR_FORMS and `exceptions`), which win over the
+    rules; a form made from several lemmas goes to the heaviest. A form's
+    FNV-1a hash h picks home bucket fmix32(h) % bucket_count; its entry is
+    (h >> id_bits) << id_bits | lemma id, in the home bucket or the next, so
+    one read of two buckets finds it. There is one bucket more than
+    bucket_count for the last one's spill; empty slots are 0xFFFFFFFF.
+    """
+    ids = {rec.key: i for i, rec in enumerate(records)}
+    weights = weights or [1.0] * len(records)
+    irregular = IRREGULAR_FORMS.split()
+    pairs = list(zip(irregular[::2], irregular[1::2]))
+    forms = {}
+    for form, lemma in [(f.encode(), l.encode()) for f, l in pairs] + list(exceptions):
+        form, lemma = device_key(form), device_key(lemma)
+        if form not in ids and lemma in ids and form not in forms:
+            forms[form] = ids[lemma]
+    irregular_count = len(forms)
+    ranked = sorted(range(len(records)), key=lambda i: -weights[i])
+    for i in ranked:
+        key = records[i].key
+        if re.fullmatch(rb"[a-z]{2,}", key):
+            for form in inflect(key):
+                if form not in ids and form not in forms:
+                    forms[form] = i
+
+    id_bits = max(1, len(records).bit_length())
+    homes = []
+    for form, lemma in forms.items():
+        h = fnv1a(form, HASH_BASIS)
+        homes.append((h, ((h >> id_bits) << id_bits) | lemma))
+    bucket_count = max(1, int(len(homes) / (INFL_BUCKET_SLOTS * INFL_LOAD)))
+    while True:
+        placed = [(fmix32(h) % bucket_count, entry) for h, entry in homes]
+        buckets = place_infl(placed, bucket_count, INFL_BUCKET_SLOTS)
+        if buckets:
+            break
+        bucket_count = bucket_count * 51 // 50 + 1
+    out = bytearray(INFL_HEAD.pack(bucket_count, len(homes), id_bits, INFL_BUCKET_SLOTS))
+    for bucket in buckets:
+        entries = bucket + [0xFFFFFFFF] * (INFL_BUCKET_SLOTS - len(bucket))
+        out += struct.pack(f"<{INFL_BUCKET_SLOTS}I", *entries)
+    # A form whose fingerprint an earlier entry of its two buckets shares
+    # resolves to that entry's lemma instead
+    shadowed = sum(1 for form, lemma in forms.items() if model_infl(out, form) != lemma)
+    report = {"forms": len(homes), "irregular": irregular_count, "shadowed": shadowed, "bytes": len(out)}
+    return bytes(out), report
+
+
+def model_infl(section, form, ops=None):
+    """Lemma id of `form` as the device finds it, or None."""
+    bucket_count, _, id_bits, slots = INFL_HEAD.unpack_from(section, 0)
+    h = fnv1a(device_key(form), HASH_BASIS)
+    start = INFL_HEAD.size + fmix32(h) % bucket_count * 4 * slots
+    if ops is not None:
+        ops.seeks += 1
+        ops.read(8 * slots)
+    for entry in struct.unpack_from(f"<{2 * slots}I", section, start):
+        if entry != 0xFFFFFFFF and entry >> id_bits == h >> id_bits:
+            return entry & ((1 << id_bits) - 1)
+    return None
+
+
+def infl_report(report):
+    return (
+        f"inflections: {report['forms']} forms ({report['irregular']} irregular) in "
+        f"{report['bytes']} bytes, {report['shadowed']} shadowed by hash collisions"
+    )
+
+
+def metaphone(word, length=SOUND_CODE_LENGTH):
+    """Metaphone code of a lowercase word of letters, at most `length` long:
+    consonant sounds as letters (0 for "th", X for "sh" and "ch", J for soft
+    g), vowels dropped but a leading one, which is A. Must match
+    dictionary_sound_encode()."""
+    vowels = b"aeiou"
+    w = word
+    if w[:2] in (b"ae", b"gn", b"kn", b"pn", b"wr"):
+        w = w[1:]
+    if w[:1] == b"x":
+        w = b"s" + w[1:]
+    elif w[:2] == b"wh":
+        w = b"w" + w[2:]
+    code = ""
+    for i, c in enumerate(w):
+        if len(code) >= length:
+            break
+        prev = w[i - 1] if i > 0 else 0
+        next1 = w[i + 1] if i + 1 < len(w) else 0
+        next2 = w[i + 2] if i + 2 < len(w) else 0
+        c, prev, next1, next2 = (chr(x) if x else "" for x in (c, prev, next1, next2))
+        if c == prev and c != "c":
+            continue
+        if c in "aeiou":
+            code += "A" if i == 0 else ""
+        elif c == "b":
+            code += "" if prev == "m" and i == len(w) - 1 else "B"
+        elif c == "c":
+            if next1 == "i" and next2 == "a" or next1 == "h" and prev != "s":
+                code += "X"
+            elif next1 in ("e", "i", "y"):
+                code += "" if prev == "s" else "S"
+            else:
+                code += "K"
+        elif c == "d":
+            code += "J" if next1 == "g" and next2 in ("e", "i", "y") else "T"
+        elif c == "g":
+            if next1 == "h" and next2 not in ("a", "e", "i", "o", "u"):
+                pass  # "night", "through"
+            elif next1 == "n" and (i + 2 == len(w) or w[i + 2 :] == b"ed"):
+                pass  # "sign", "resigned"
+            elif prev == "d" and next1 in ("e", "i", "y"):
+                pass  # "edge", spelt by the d
+            else:
+                code += "J" if next1 in ("e", "i", "y") else "K"
+        elif c == "h":
+            code += "H" if next1 and next1 in "aeiou" and prev not in ("c", "g", "p", "s", "t") else ""
+        elif c == "k":
+            code += "" if prev == "c" else "K"
+        elif c == "p":
+            code += "F" if next1 == "h" else "P"
+        elif c == "q":
+            code += "K"
+        elif c == "s":
+            code += "X" if next1 == "h" or next1 == "i" and next2 in ("o", "a") else "S"
+        elif c == "t":
+            if next1 == "i" and next2 in ("o", "a"):
+                code += "X"
+            elif next1 == "h":
+                code += "0"
+            elif not (next1 == "c" and next2 == "h"):
+                code += "T"
+        elif c == "v":
+            code += "F"
+        elif c in "wy":
+            code += c.upper() if next1 and next1 in "aeiou" else ""
+        elif c == "x":
+            code += "KS"
+        elif c == "z":
+            code += "S"
+        else:
+            code += c.upper()
+    return code[:length]
+
+
+def phone_code(phones, length=SOUND_CODE_LENGTH):
+    """The code of a CMUdict pronunciation in metaphone()'s letters, so a
+    spelling that sounds right meets a word its letters do not ("laf")."""
+    code = ""
+    phones = [re.sub(r"\d", "", p) for p in phones.split()]
+    for i, p in enumerate(phones):
+        vowel_next = i + 1 < len(phones) and phones[i + 1][0] in "AEIOU"
+        if p[0] in "AEIOU":
+            code += ("A" if i == 0 else "") + ("R" if p == "ER" else "")
+        elif p in ("HH", "W", "Y"):
+            code += {"HH": "H"}.get(p, p) if vowel_next else ""
+        else:
+            letters = SOUND_PHONES.get(p, "")
+            code += letters[1:] if code[-1:] == letters[:1] else letters
+    return code[:length]
+
+
+def build_sounds(records, dat, weights=None):
+    """Sound codes of the single-word keys mapped to their records.
+
+    A key is filed under the metaphone() of its spelling and, with CMUdict
+    phonetics, the phone_code() of its pronunciation. Each code keeps its
+    SOUND_MAX_PER_CODE heaviest records. A code's FNV-1a hash h picks bucket
+    fmix32(h) % bucket_count; entries are u32 (h >> id_bits) << id_bits | id,
+    grouped by code within a bucket, heaviest first, and no bucket holds more
+    than SOUND_MAX_BUCKET. The directory holds bucket_count + 1 entry indexes.
+    """
+    weights = weights or [1.0] * len(records)
+    codes = {}
+    for i, rec in enumerate(records):
+        if not re.fullmatch(rb"[a-z]{2,}", rec.key):
+            continue
+        own = {metaphone(rec.key)}
+        definition = dat[rec.offset : rec.offset + rec.length]
+        if definition.startswith(b"[") and b"]" in definition:
+            own.add(phone_code(definition[1 : definition.find(b"]")].decode("ascii", "replace")))
+        for code in own - {""}:
+            codes.setdefault(code, []).append(i)
+    dropped = 0
+    for code, ids in codes.items():
+        ids.sort(key=lambda i: (-weights[i], i))
+        dropped += max(0, len(ids) - SOUND_MAX_PER_CODE)
+        del ids[SOUND_MAX_PER_CODE:]
+
+    id_bits = max(1, len(records).bit_length())
+    hashed = [(fnv1a(code.encode(), HASH_BASIS), ids) for code, ids in sorted(codes.items())]
+    count = sum(len(ids) for _, ids in hashed)
+    bucket_count = max(1, count // SOUND_BUCKET_LOAD)
+    while True:
+        buckets = [[] for _ in range(bucket_count)]
+        for h, ids in hashed:
+            buckets[fmix32(h) % bucket_count] += [(h >> id_bits) << id_bits | i for i in ids]
+        if max(len(b) for b in buckets) <= SOUND_MAX_BUCKET:
+            break
+        bucket_count = bucket_count * 51 // 50 + 1
+
+    directory = bytearray()
+    entries = bytearray()
+    for bucket in buckets:
+        directory += struct.pack("<I", len(entries) // 4)
+        entries += struct.pack(f"<{len(bucket)}I", *bucket)
+    directory += struct.pack("<I", len(entries) // 4)
+    out = SNDX_HEAD.pack(bucket_count, count, id_bits, SOUND_MAX_PER_CODE) + bytes(directory) + bytes(entries)
+    report = {"codes": len(codes), "entries": count, "dropped": dropped, "bytes": len(out)}
+    return out, report
+
+
+def model_sounds(section, word):
+    """Record ids the device finds for a misspelt `word`, heaviest first."""
+    bucket_count, _, id_bits, per_code = SNDX_HEAD.unpack_from(section, 0)
+    code = metaphone(device_key(word)) if re.fullmatch(rb"[a-z]+", device_key(word)) else ""
+    if not code:
+        return []
+    h = fnv1a(code.encode(), HASH_BASIS)
+    bucket = fmix32(h) % bucket_count
+    start, end = struct.unpack_from("<II", section, SNDX_HEAD.size + 4 * bucket)
+    base = SNDX_HEAD.size + 4 * (bucket_count + 1)
+    entries = struct.unpack_from(f"<{end - start}I", section, base + 4 * start)
+    return [e & ((1 << id_bits) - 1) for e in entries if e >> id_bits == h >> id_bits][:per_code]
+
+
+def sound_report(report):
+    return (
+        f"sound codes: {report['codes']} codes, {report['entries']} entries in {report['bytes']} bytes, "
+        f"{report['dropped']} dropped beyond {SOUND_MAX_PER_CODE} per code"
+    )
+
+
+def deletions(key):
+    """The key itself and every string one deletion away from it."""
+    return {key} | {key[:i] + key[i + 1 :] for i in range(len(key))} - {b""}
+
+
+def build_dels(records, load=DELS_BUCKET_LOAD):
+    """Hash of the deletion neighbourhood of every key.
+
+    A query whose own deletions (up to two) hit a bucket entry with the same
+    fingerprint has a candidate within that many edits; the device verifies
+    candidates against the real key. Entries are u32 (fingerprint << 20) | id
+    sorted within each bucket; the directory holds bucket_count + 1 entry
+    indexes.
+    """
+    if len(records) >= 1 << DELS_ID_BITS:
+        sys.exit(f"DELS: {len(records)} records do not fit {DELS_ID_BITS}-bit ids")
+    hashed = []
+    for i, rec in enumerate(records):
+        for variant in deletions(rec.key):
+            hashed.append((fnv1a(variant), i))
+    bucket_count = max(1, len(hashed) // load)
+    buckets = [set() for _ in range(bucket_count)]
+    for h, i in hashed:
+        buckets[h % bucket_count].add((h >> DELS_ID_BITS) << DELS_ID_BITS | i)
+
+    directory = bytearray()
+    entries = bytearray()
+    count = 0
+    for bucket in buckets:
+        directory += struct.pack("<I", count)
+        for entry in sorted(bucket):
+            entries += struct.pack("<I", entry)
+        count += len(bucket)
+    directory += struct.pack("<I", count)
+    return DELS_HEAD.pack(bucket_count, count, DELS_ID_BITS, 0) + bytes(directory) + bytes(entries)
+
+
+def load_weights(records, dat, frequency_path):
+    """Relative pick weight of every record.
+
+    With a frequency list (one word per line, most common first, e.g.
+    google-10000-english) a word of rank r weighs 1 / (r + 10); unlisted words
+    weigh as much as the last listed one. Without a list the number of senses
+    in engdict.dat stands in, since common words tend to have more of them.
+    """
+    if frequency_path:
+        with open(frequency_path, encoding="ascii", errors="replace") as f:
+            ranks = {}
+            for line in f:
+                word = device_key(line.strip())
+                if word and word not in ranks:
+                    ranks[word] = len(ranks)
+        tail = len(ranks)
+        return [1.0 / (ranks.get(rec.key, tail) + 10) for rec in records], "frequency list"
+
+    weights = []
+    for rec in records:
+        definition = dat[rec.offset : rec.offset + rec.length]
+        if definition.startswith(b"["):
+            definition = definition[definition.find(b"]") + 1 :]
+        weights.append(float(max(1, sum(1 for s in definition.split(b";") if s.strip()))))
+    return weights, "sense count"
+
+
+def signature(key):
+    """Letter-presence mask of a key in bits 0-25 (a = bit 0) and its length
+    in bits 26-31; 0 for a key with anything but a-z, which wildcard and
+    anagram queries leave out. Must match dictionary_pattern_signature()."""
+    if not re.fullmatch(rb"[a-z]+", key):
+        return 0
+    mask = 0
+    for c in key:
+        mask |= 1 << (c - ord("a"))
+    return mask | len(key) << 26
+
+
+def build_sigs(records):
+    """A u32 signature() per record, in record order, for the RAM table
+    wildcard and anagram queries filter before reading any key."""
+    sigs = [signature(rec.key) for rec in records]
+    return SIGS_HEAD.pack(len(records), 0, 0, 0) + struct.pack(f"<{len(sigs)}I", *sigs)
+
+
+def join_ranges(dat, ranges, prefix):
+    """The text of a gloss list: its ranges of engdict.dat joined by "; ",
+    except right after the pronunciation when `prefix` is set."""
+    out = bytearray()
+    for i, (offset, length) in enumerate(ranges):
+        if i > 1 or (i == 1 and not prefix):
+            out += GLOSS_SEPARATOR
+        out += dat[offset : offset + length]
+    return bytes(out)
+
+
+def build_glosses(records, dat):
+    """(GLOS section, engdict.dat storing each gloss once, report).
+
+    Definitions are "[phones] gloss; gloss; ..." and the glosses of a WordNet
+    synset recur in the entry of every word in it. The new engdict.dat keeps
+    the record order, but writes a gloss only where it first appears; a later
+    definition names the ranges of the file it is made of instead. Glosses
+    first seen together are written together, and a reused run that follows
+    on from the last range extends it, so most definitions are one or two
+    ranges. Records keep their offsets and lengths into the plain text: they
+    place a definition in it, and the device maps positions through the
+    list.
+
+    A list is varint(range count << 1 | prefix) and a varint offset and
+    length per range; the ranges are joined by "; " but for the one after the
+    pronunciation when `prefix` is set. After a GLOS_HEAD (record count,
+    distinct glosses, overflow bytes, most ranges per list) come a
+    GLOSS_SLOT_SIZE slot per record, then the overflow area. A list that fits
+    is stored in its slot, zero-padded, so most definitions cost one read of
+    the index; the slot of a longer one is two zero bytes, its u16 size and
+    its u32 offset in the overflow area.
+    """
+    out = bytearray()
+    where = {}  # gloss -> its offset in `out`
+    slots = bytearray()
+    overflow = bytearray()
+    parts = total = most = restored = 0
+    for rec in records:
+        definition = dat[rec.offset : rec.offset + rec.length]
+        match = PHONES_PREFIX.match(definition)
+        pronunciation = match.group(0) if match else b""
+        glosses = definition[len(pronunciation) :].split(GLOSS_SEPARATOR)
+        parts += len(glosses)
+        ranges = []
+        prefix = False
+        if pronunciation:
+            ranges.append([len(out), len(pronunciation)])
+            out += pronunciation
+        for i, gloss in enumerate(glosses):
+            separator = GLOSS_SEPARATOR if i > 0 else b""
+            end = ranges[-1][0] + ranges[-1][1] if ranges else None
+            at = where.get(gloss)
+            if at is None and end == len(out):
+                # A new gloss right after the last range extends it
+                out += separator
+                at = where[gloss] = len(out)
+                out += gloss
+            elif at is None:
+                at = where[gloss] = len(out)
+                out += gloss
+            if end is not None and end + len(separator) == at and out[end:at] == separator:
+                ranges[-1][1] += len(separator) + len(gloss)
+            else:
+                # A reused first gloss is the range after the pronunciation
+                prefix = prefix or (i == 0 and bool(pronunciation))
+                ranges.append([at, len(gloss)])
+
+        if len(ranges) > GLOSS_MAX_RANGES:
+            # The text from the last range allowed on is written out again
+            start = len(join_ranges(out, ranges[: GLOSS_MAX_RANGES - 1], prefix) + GLOSS_SEPARATOR)
+            ranges[GLOSS_MAX_RANGES - 1 :] = [[len(out), len(definition) - start]]
+            out += definition[start:]
+            restored += 1
+        if join_ranges(out, ranges, prefix) != definition:
+            sys.exit(f"gloss list of {rec.key!r} does not read back")
+        total += len(ranges)
+        most = max(most, len(ranges))
+        item = varint(len(ranges) << 1 | prefix)
+        for offset, length in ranges:
+            item += varint(offset) + varint(length)
+        if len(item) <= GLOSS_SLOT_SIZE:
+            slots += item.ljust(GLOSS_SLOT_SIZE, b"\0")
+        else:
+            slots += struct.pack("<HHI", 0, len(item), len(overflow))
+            overflow += item
+    if len(out) > 0xFFFFFFFF:
+        sys.exit("engdict.dat over 4 GB: offsets are u32")
+
+    section = (
+        GLOS_HEAD.pack(len(records), len(where), len(overflow), GLOSS_MAX_RANGES) + slots + overflow
+    )
+    report = {
+        "parts": parts,
+        "glosses": len(where),
+        "plain": sum(rec.length for rec in records),
+        "dat": len(out),
+        "section": len(section),
+        "ranges": total / max(1, len(records)),
+        "most": most,
+        "restored": restored,
+        "inline": sum(1 for i in range(0, len(slots), GLOSS_SLOT_SIZE) if slots[i]),
+    }
+    return section, bytes(out), report
+
+
+def gloss_report(report):
+    saved = report["plain"] - report["dat"] - report["section"]
+    return (
+        f"glosses: {report['glosses']} distinct of {report['parts']}, engdict.dat {report['plain']} -> "
+        f"{report['dat']} bytes plus {report['section']} of GLOS, {saved} saved "
+        f"({100 * saved / max(1, report['plain']):.1f}%); {report['ranges']:.1f} ranges per definition, "
+        f"at most {report['most']} ({report['restored']} stored again past {GLOSS_MAX_RANGES}), "
+        f"{report['inline']} lists in their slot"
+    )
+
+
+def expand_glosses(section, dat, records):
+    """Plain engdict.dat text back from a GLOS section and the file it
+    indexes, each definition at its record's offset."""
+    count = GLOS_HEAD.unpack_from(section, 0)[0]
+    if count != len(records):
+        sys.exit(f"GLOS section of {count} records for {len(records)}")
+    base = GLOS_HEAD.size + GLOSS_SLOT_SIZE * count
+    plain = bytearray(max((rec.offset + rec.length for rec in records), default=0))
+    for i, rec in enumerate(records):
+        pos = GLOS_HEAD.size + GLOSS_SLOT_SIZE * i
+        if section[pos] == 0:
+            pos = base + struct.unpack_from("<HHI", section, pos)[2]
+        head, pos = read_varint(section, pos)
+        values = []
+        for _ in range(2 * (head >> 1)):
+            value, pos = read_varint(section, pos)
+            values.append(value)
+        text = join_ranges(dat, list(zip(values[::2], values[1::2])), head & 1)
+        if len(text) != rec.length:
+            sys.exit(f"gloss list of {rec.key!r} is {len(text)} bytes for {rec.length}")
+        plain[rec.offset : rec.offset + rec.length] = text
+    return bytes(plain)
+
+
+def read_glosses(idx_path):
+    """The GLOS section of an index, None if it has none."""
+    with open(idx_path, "rb") as f:
+        data = f.read()
+    header = parse_sections(data) if len(data) >= IDX_HEADER.size else None
+    if not header or b"GLOS" not in header[3]:
+        return None
+    offset, size = header[3][b"GLOS"]
+    return data[offset : offset + size]
+
+
+def read_definitions(idx_path, dat_path, records):
+    """engdict.dat as plain text at the record offsets: decompressed, and
+    put back together when the index has a GLOS section."""
+    dat = read_dat(dat_path)
+    section = read_glosses(idx_path)
+    return dat if section is None else expand_glosses(section, dat, records)
+
+
+class BodyFormatter:
+    """The body of an entry as dictionary_format.c writes it, a byte at a
+    time: senses split on ";" with the whitespace around them dropped, each
+    numbered "n. " on a line of its own."""
+
+    def __init__(self, text, pos, senses=0, in_sense=False, pending=0):
+        self.text = text
+        self.pos = pos
+        self.senses = senses
+        self.in_sense = in_sense
+        self.pending = pending  # spaces held back until the sense goes on
+        self.number = b""  # what is left of "n. "
+        self.ended = False
+
+    def save(self):
+        return (self.pos, self.senses, self.in_sense, self.pending, self.number, self.ended)
+
+    def restore(self, state):
+        self.pos, self.senses, self.in_sense, self.pending, self.number, self.ended = state
+
+    def next(self):
+        """Next output byte, None at the end."""
+        if self.number:
+            c, self.number = self.number[0], self.number[1:]
+            return c
+        text = self.text
+        while not self.ended:
+            c = text[self.pos] if self.pos < len(text) else ord(";")
+            if c == ord(";"):
+                self.ended = self.pos >= len(text)
+                self.pos += 1
+                self.pending = 0
+                if self.in_sense:
+                    self.in_sense = False
+                    return ord("\n")
+            elif c in b" \t\n\v\f\r":
+                self.pos += 1
+                if self.in_sense:
+                    self.pending = min(self.pending + 1, 0xFF)
+            elif not self.in_sense:
+                self.senses += 1
+                self.in_sense = True
+                self.number = b"%d. " % self.senses
+                return self.next()
+            elif self.pending:
+                self.pending -= 1
+                return ord(" ")
+            else:
+                self.pos += 1
+                return c
+        return None
+
+
+def wrap_line(formatter):
+    """The next line as dictionary_pager.c wraps it: at the last space that
+    fits in LINE_COLUMNS characters, or mid-word when there is none; None at
+    the end of the text."""
+    line = bytearray()
+    columns = 0
+    read_any = False
+    space_length = after_space = None
+    while True:
+        before = formatter.save()
+        c = formatter.next()
+        if c is None:
+            break
+        read_any = True
+        if c == ord("\n"):
+            break
+        continuation = (c & 0xC0) == 0x80
+        if not continuation and columns == LINE_COLUMNS:
+            # A space at the edge just ends the line
+            if c != ord(" "):
+                if space_length is not None:
+                    del line[space_length:]
+                    formatter.restore(after_space)
+                else:
+                    formatter.restore(before)
+            break
+        if len(line) == LINE_BYTES:
+            formatter.restore(before)
+            break
+        line.append(c)
+        if not continuation:
+            columns += 1
+        if c == ord(" "):
+            space_length = len(line) - 1
+            after_space = formatter.save()
+    return bytes(line) if read_any else None
+
+
+def lay_out(definition):
+    """([formatter state where each body line starts], [lines]) of a
+    definition. The headline ends with its own line break, so the body lines
+    are the same whatever word heads the entry."""
+    start = 0
+    if definition[:1] == b"[":
+        end = definition.find(b"]", 0, FORMAT_WINDOW)
+        if end > 0:
+            start = end + 1
+    formatter = BodyFormatter(definition, start)
+    states, lines = [], []
+    while True:
+        state = formatter.save()
+        line = wrap_line(formatter)
+        if line is None:
+            return states, lines
+        states.append(state)
+        lines.append(line)
+
+
+def pack_line(state):
+    """The LINE entry of a line start, None if it does not fit one. A line
+    starts between senses or in one, never inside its "n. ": a wrap there
+    would follow the number's space, which is its last character."""
+    pos, senses, in_sense, pending, number, ended = state
+    if number or ended or pos > 0xFFFF or senses > LINE_MAX_SENSES or pending > LINE_MAX_PENDING:
+        return None
+    return LINE_ENTRY.pack(pos, senses << 5 | pending << 1 | in_sense)
+
+
+def build_lines(records, dat):
+    """(LINE section, report): the result screen's layout of every
+    definition, so the device starts any line without formatting the text
+    before it.
+
+    The headline depends on the word shown (an inflected form heads its
+    lemma's entry), so only the body is laid out. After a LINE_HEAD (record
+    count, line count, LINE_COLUMNS, LINE_BYTES) come record count + 1 u32
+    line numbers, the first body line of each record and the total, then a
+    LINE_ENTRY per line: u16 position in the definition and u16 sense count
+    << 5 | pending spaces << 1 | in a sense. A definition with a line that
+    does not fit an entry gets none and is formatted on the device as before.
+    """
+    firsts = []
+    entries = bytearray()
+    most = skipped = 0
+    for rec in records:
+        firsts.append(len(entries) // LINE_ENTRY.size)
+        definition = dat[rec.offset : rec.offset + rec.length]
+        states, lines = lay_out(definition)
+        packed = [pack_line(state) for state in states]
+        if None in packed:
+            skipped += 1
+            continue
+        for item, line in zip(packed, lines):
+            pos, flags = LINE_ENTRY.unpack(item)
+            formatter = BodyFormatter(definition, pos, flags >> 5, bool(flags & 1), flags >> 1 & 0xF)
+            if wrap_line(formatter) != line:
+                sys.exit(f"line layout of {rec.key!r} does not read back")
+        entries += b"".join(packed)
+        most = max(most, len(packed))
+    count = len(entries) // LINE_ENTRY.size
+    firsts.append(count)
+    section = (
+        LINE_HEAD.pack(len(records), count, LINE_COLUMNS, LINE_BYTES)
+        + struct.pack(f"<{len(firsts)}I", *firsts)
+        + entries
+    )
+    report = {"lines": count, "size": len(section), "most": most, "skipped": skipped}
+    return section, report
+
+
+def line_report(report):
+    return (
+        f"line layout: {report['lines']} lines of {LINE_COLUMNS} columns in {report['size']} bytes, "
+        f"at most {report['most']} per definition, {report['skipped']} left to the device"
+    )
+
+
+def build_rand(weights):
+    """Vose alias table: slot i keeps record i when a uniform u32 is below
+    threshold[i] and yields alias[i] otherwise, so a weighted pick costs one
+    random slot plus one comparison."""
+    n = len(weights)
+    total = sum(weights)
+    scaled = [w * n / total for w in weights]
+    threshold = [0] * n
+    alias = list(range(n))
+    small = [i for i, p in enumerate(scaled) if p < 1.0]
+    large = [i for i, p in enumerate(scaled) if p >= 1.0]
+    while small and large:
+        s, l = small.pop(), large.pop()
+        threshold[s] = min(0xFFFFFFFF, int(scaled[s] * 2**32))
+        alias[s] = l
+        scaled[l] -= 1.0 - scaled[s]
+        (small if scaled[l] < 1.0 else large).append(l)
+    for i in small + large:
+        # Rounding leftovers: always keep the slot's own record
+        threshold[i] = 0xFFFFFFFF
+        alias[i] = i
+    entries = b"".join(RAND_ENTRY.pack(t, a) for t, a in zip(threshold, alias))
+    return RAND_HEAD.pack(n, 0, 0, 0) + entries
+
+
+def undouble(word):
+    if len(word) >= 2 and word[-1] == word[-2] and word[-1] not in b"lsz":
+        return word[:-1]
+    return word
+
+
+def has_vowel(word):
+    return any(c in b"aeiouy" for c in word)
+
+
+def stem(word):
+    """Light suffix stripper, the same as dictionary_reverse_stem() on the
+    device: plurals, then -ing, -ed or -ly, then a final e. It only has to
+    map a word and its inflections to one term, not produce a real stem."""
+    if word.endswith(b"sses"):
+        word = word[:-2]
+    elif word.endswith(b"ies") and len(word) > 4:
+        word = word[:-3] + b"y"
+    elif word.endswith(b"s") and not word.endswith((b"ss", b"us", b"is")) and len(word) > 3:
+        word = word[:-1]
+    if word.endswith(b"ing") and len(word) > 5 and has_vowel(word[:-3]):
+        word = undouble(word[:-3])
+    elif word.endswith(b"ed") and len(word) > 4 and has_vowel(word[:-2]):
+        word = undouble(word[:-2])
+    elif word.endswith(b"ly") and len(word) > 5:
+        word = word[:-2]
+    if word.endswith(b"e") and len(word) > 3:
+        word = word[:-1]
+    return word
+
+
+def terms(text):
+    """(term, sense) for each indexed word of a definition, in text order.
+    Words are runs of ASCII letters; senses are counted by semicolons after
+    the phonetics."""
+    if text.startswith(b"["):
+        text = text[text.find(b"]") + 1 :]
+    for sense, gloss in enumerate(text.split(b";")):
+        for word in re.findall(rb"[A-Za-z]+", gloss):
+            word = word.lower()
+            if len(word) < 2 or len(word) > TERM_MAX_LENGTH or word in STOPWORDS:
+                continue
+            yield stem(word), sense
+
+
+def build_terms(records, dat, load=TERM_BUCKET_LOAD):
+    """Inverted index: stemmed term -> the records whose definition uses it.
+
+    Terms are found by FNV-1a hash: a directory of bucket_count + 1 entry
+    indexes, then per bucket [u32 hash][u32 postings offset][u32 count]
+    entries sorted by hash. A term's postings end where the next entry's
+    begin. A posting is varint((id gap - 1) << 2 | sense), sense being the
+    first sense using the term, capped at 3. Of two terms with the same hash
+    the rarer one is dropped. Returns (section, report).
+    """
+    postings = {}
+    for i, rec in enumerate(records):
+        for term, sense in terms(dat[rec.offset : rec.offset + rec.length]):
+            ids = postings.setdefault(term, {})
+            if i not in ids:
+                ids[i] = min(sense, 3)
+    by_hash = {}
+    for term, ids in postings.items():
+        h = fnv1a(term)
+        if h not in by_hash or len(ids) > len(postings[by_hash[h]]):
+            by_hash[h] = term
+    dropped = len(postings) - len(by_hash)
+
+    bucket_count = max(1, len(by_hash) // load)
+    buckets = [[] for _ in range(bucket_count)]
+    for h in sorted(by_hash):
+        buckets[h % bucket_count].append(h)
+    directory = bytearray()
+    entries = bytearray()
+    lists = bytearray()
+    count = 0
+    for bucket in buckets:
+        directory += struct.pack("<I", count)
+        for h in bucket:
+            ids = postings[by_hash[h]]
+            entries += TERM_ENTRY.pack(h, len(lists), len(ids))
+            prev = -1
+            for i in sorted(ids):
+                lists += varint((i - prev - 1) << 2 | ids[i])
+                prev = i
+        count += len(bucket)
+    directory += struct.pack("<I", count)
+    head = TERM_HEAD.pack(bucket_count, count, len(lists), 0)
+    report = {"terms": count, "postings": sum(len(postings[t]) for t in by_hash.values()),
+              "bytes": len(lists), "dropped": dropped}
+    return head + bytes(directory) + bytes(entries) + bytes(lists), report
+
+
+def term_report(report):
+    return (
+        f"reverse index: {report['terms']} terms, {report['postings']} postings in "
+        f"{report['bytes']} bytes, {report['dropped']} dropped on hash collisions"
+    )
+
+
+def build_recs(records):
+    """(version, stride, key width, RECS section); v3 if a definition is too
+    long for a u16 length."""
+    wide = any(rec.length > 0xFFFF for rec in records)
+    version, rec_head = (IDX_VERSION_WIDE, REC_HEAD_WIDE) if wide else (IDX_VERSION, REC_HEAD)
+    key_width = max(len(r.key) for r in records)
+    stride = rec_head.size + key_width
+    recs = bytearray()
+    for rec in records:
+        recs += rec_head.pack(rec.offset, rec.length, len(rec.key)) + rec.key.ljust(key_width, b"\0")
+    return version, stride, key_width, bytes(recs)
+
+
+def build_v2(
+    records,
+    weights=None,
+    term_section=None,
+    block_keys=None,
+    exact_hash=True,
+    infl_section=None,
+    sound_section=None,
+    signatures=True,
+    gloss_section=None,
+    line_section=None,
+):
+    """The v2 index, or v3 if a definition is too long for a u16 length."""
+    version, stride, key_width, recs = build_recs(records)
+    sections = [
+        (b"RECS", recs),
+        (b"FCIX", build_fcix(records, block_keys)),
+        (b"DELS", build_dels(records)),
+    ]
+    if weights:
+        sections.append((b"RAND", build_rand(weights)))
+    if term_section:
+        sections.append((b"TERM", term_section))
+    if exact_hash:
+        sections.append((b"HASH", build_hash(records, recs, stride)))
+    if infl_section:
+        sections.append((b"INFL", infl_section))
+    if sound_section:
+        sections.append((b"SNDX", sound_section))
+    if signatures:
+        sections.append((b"SIGS", build_sigs(records)))
+    if gloss_section:
+        sections.append((b"GLOS", gloss_section))
+    if line_section:
+        sections.append((b"LINE", line_section))
+
+    out = bytearray(IDX_HEADER.pack(IDX_MAGIC, version, len(sections), len(records), stride, key_width, 0))
+    offset = IDX_HEADER.size + IDX_SECTION.size * len(sections)
+    for tag, payload in sections:
+        out += IDX_SECTION.pack(tag, offset, len(payload))
+        offset += len(payload)
+    for _, payload in sections:
+        out += payload
+    return bytes(out)
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.count = 0
+
+    def put(self, value, bits):
+        self.acc = (self.acc << bits) | value
+        self.count += bits
+        while self.count >= 8:
+            self.count -= 8
+            self.out.append((self.acc >> self.count) & 0xFF)
+        self.acc &= (1 << self.count) - 1
+
+    def finish(self):
+        if self.count:
+            self.out.append((self.acc << (8 - self.count)) & 0xFF)
+        return bytes(self.out)
+
+
+def build_preset(data, size):
+    """Shared dictionary every block may refer back into: the most frequent
+    3 to 9 byte substrings of a sample of the text, weighted by the bits a
+    back-reference saves."""
+    counts = Counter()
+    for start in range(0, len(data), 7 * 4096):
+        chunk = data[start : start + 4096]
+        for n in (3, 4, 6, 9):
+            for i in range(len(chunk) - n):
+                counts[chunk[i : i + n]] += 1
+    preset = bytearray()
+    for gram, _ in sorted(counts.items(), key=lambda kv: -kv[1] * (len(kv[0]) - 1)):
+        if len(preset) + len(gram) <= size and gram not in preset:
+            preset += gram
+            if len(preset) >= size - 2:
+                break
+    return bytes(preset)
+
+
+def compress_block(block, preset, window_bits, lookahead_bits):
+    """heatshrink bit stream: 1 + 8-bit literal, or 0 + (distance - 1) in
+    window_bits + (length - 1) in lookahead_bits. The window starts with the
+    preset; matches are greedy and may overlap the bytes they produce."""
+    buf = preset + block
+    window, longest = 1 << window_bits, 1 << lookahead_bits
+    writer = BitWriter()
+    i = len(preset)
+    while i < len(buf):
+        best = best_pos = 0
+        low = max(0, i - window)
+        k = 2
+        while k <= longest and i + k <= len(buf):
+            pos = buf.rfind(buf[i : i + k], low, i + k - 1)
+            if pos < 0:
+                break
+            best, best_pos = k, pos
+            k += 1
+        if best * 9 > 1 + window_bits + lookahead_bits:
+            writer.put(0, 1)
+            writer.put(i - best_pos - 1, window_bits)
+            writer.put(best - 1, lookahead_bits)
+            i += best
+        else:
+            writer.put(0x100 | buf[i], 9)
+            i += 1
+    return writer.finish()
+
+
+def decompress_block(data, length, preset, window_bits, lookahead_bits):
+    out = bytearray(preset)
+    end = len(preset) + length
+    acc = count = pos = 0
+
+    def get(bits):
+        nonlocal acc, count, pos
+        while count < bits:
+            acc = (acc << 8) | data[pos]
+            pos += 1
+            count += 8
+        count -= bits
+        value = acc >> count
+        acc &= (1 << count) - 1
+        return value
+
+    while len(out) < end:
+        if get(1):
+            out.append(get(8))
+        else:
+            distance = get(window_bits) + 1
+            for _ in range(get(lookahead_bits) + 1):
+                out.append(out[-distance])
+    return bytes(out[len(preset) :])
+
+
+def compress_dat(data, block_size, window_bits, lookahead_bits, preset_size):
+    """engdict.dat as independently decodable blocks; see tools/README.md."""
+    preset = build_preset(data, preset_size) if preset_size else b""
+    blocks = [
+        compress_block(data[start : start + block_size], preset, window_bits, lookahead_bits)
+        for start in range(0, len(data), block_size)
+    ]
+    head = DZ_HEAD.pack(
+        DZ_MAGIC,
+        DZ_VERSION,
+        window_bits,
+        lookahead_bits,
+        block_size,
+        len(blocks),
+        len(data),
+        len(preset),
+        0,
+    )
+    directory = bytearray()
+    offset = 0
+    for block in blocks:
+        directory += struct.pack("<I", offset)
+        offset += len(block)
+    directory += struct.pack("<I", offset)
+    return head + preset + bytes(directory) + b"".join(blocks)
+
+
+def decompress_dat(blob):
+    _, version, window_bits, lookahead_bits, block_size, block_count, size, preset_size, _ = (
+        DZ_HEAD.unpack_from(blob, 0)
+    )
+    if version != DZ_VERSION:
+        sys.exit(f"unsupported engdict.dat version {version}")
+    preset = blob[DZ_HEAD.size : DZ_HEAD.size + preset_size]
+    directory = struct.unpack_from(f"<{block_count + 1}I", blob, DZ_HEAD.size + preset_size)
+    base = DZ_HEAD.size + preset_size + 4 * (block_count + 1)
+    out = bytearray()
+    for b in range(block_count):
+        block = blob[base + directory[b] : base + directory[b + 1]]
+        length = min(block_size, size - b * block_size)
+        out += decompress_block(block, length, preset, window_bits, lookahead_bits)
+    return bytes(out)
+
+
+def read_dat(path):
+    """engdict.dat contents, decompressed if needed."""
+    with open(path, "rb") as f:
+        data = f.read()
+    return decompress_dat(data) if data.startswith(DZ_MAGIC) else data
+
+
+def pair_encode(texts, first_code=HOT_FIRST_CODE, max_depth=HOT_MAX_DEPTH):
+    """Byte pair encoding: each code from first_code up stands for a pair of
+    bytes or earlier codes, the most frequent pair of the texts merged first.
+    Codes nest at most max_depth deep, so the device expands one with a small
+    fixed stack. Returns the pairs and the encoded texts."""
+    texts = list(texts)
+    depth = [0] * 256
+    pairs = []
+    for code in range(first_code, 256):
+        counts = Counter()
+        for text in texts:
+            counts.update(zip(text, text[1:]))
+        best = next(
+            (p for p, n in counts.most_common() if n > 1 and max(depth[p[0]], depth[p[1]]) < max_depth),
+            None,
+        )
+        if best is None:
+            break
+        pairs.append(best)
+        depth[code] = max(depth[best[0]], depth[best[1]]) + 1
+        texts = [text.replace(bytes(best), bytes([code])) for text in texts]
+    return pairs, texts
+
+
+def pair_decode(data, pairs, first_code=HOT_FIRST_CODE):
+    out = bytearray()
+    stack = list(reversed(data))
+    while stack:
+        b = stack.pop()
+        if b < first_code:
+            out.append(b)
+        else:
+            stack += reversed(pairs[b - first_code])
+    return bytes(out)
+
+
+def c_list(values, indent="    ", width=99):
+    """Comma-separated initializer items wrapped for C."""
+    lines, line = [], indent
+    for value in values:
+        item = f"{value}, "
+        if len(line) + len(item) > width:
+            lines.append(line.rstrip())
+            line = indent
+        line += item
+    if line.strip():
+        lines.append(line.rstrip())
+    return "\n".join(lines)
+
+
+def build_hot(records, dat, weights, count, max_length, idx_size):
+    """C header holding the definitions of the `count` heaviest records of at
+    most max_length bytes, pair encoded, for dictionary_hot.c. Returns the
+    header text and the sizes (entries, plain bytes, bytes in the .fap)."""
+    if any(b >= HOT_FIRST_CODE for b in dat):
+        sys.exit("engdict.dat is not 7-bit ASCII, the hot table cannot encode it")
+    candidates = [i for i, rec in enumerate(records) if rec.length <= max_length]
+    chosen = sorted(sorted(candidates, key=lambda i: (-weights[i], i))[:count])
+    texts = [dat[records[i].offset : records[i].offset + records[i].length] for i in chosen]
+    pairs, encoded = pair_encode(texts)
+    for text, data in zip(texts, encoded):
+        if pair_decode(data, pairs) != text:
+            sys.exit("hot table does not round-trip")
+
+    codes = range(HOT_FIRST_CODE, HOT_FIRST_CODE + len(pairs))
+    code_lengths = [len(pair_decode(bytes([code]), pairs)) for code in codes]
+    key_offsets = []
+    keys = bytearray()
+    for i in chosen:
+        key_offsets.append(len(keys))
+        keys += records[i].key + b"\0"
+    key_offsets.append(len(keys))
+    text_offsets = [0]
+    for data in encoded:
+        text_offsets.append(text_offsets[-1] + len(data))
+    if len(keys) > 0xFFFF or max_length > 0xFFFF:
+        sys.exit("hot table too large, lower --count or --max-length")
+    text = b"".join(encoded)
+    plain = sum(map(len, texts))
+
+    # One literal per key: escapes are read before adjacent literals join, so
+    # a key starting with a digit does not extend the \0 before it
+    literals = [
+        records[i].key.decode().replace("\\", "\\\\").replace('"', '\\"') for i in chosen
+    ]
+    # Empty arrays are not C; a padding element stands in
+    entries = [
+        f"    {{{k}, {records[i].length}, {i}, {t}}},"
+        for k, i, t in zip(key_offsets, chosen, text_offsets)
+    ]
+    entries.append(f"    {{{key_offsets[-1]}, 0, 0, {text_offsets[-1]}}},")
+    lines = [
+        "// Generated by tools/dictc.py hot; do not edit.",
+        f"// {len(chosen)} entries, {plain} bytes of text encoded to {len(text)}",
+        "",
+        "#pragma once",
+        "",
+        f"#define DICTIONARY_HOT_COUNT       {len(chosen)}",
+        f"#define DICTIONARY_HOT_IDX_RECORDS {len(records)}",
+        f"#define DICTIONARY_HOT_IDX_SIZE    {idx_size}",
+        "",
+        "static const uint8_t dictionary_hot_pairs[][2] = {",
+        c_list([f"{{{a}, {b}}}" for a, b in pairs] or ["{0, 0}"]),
+        "};",
+        "",
+        "static const uint16_t dictionary_hot_code_lengths[] = {",
+        c_list(code_lengths or [0]),
+        "};",
+        "",
+        "static const DictionaryHotEntry dictionary_hot_entries[DICTIONARY_HOT_COUNT + 1] = {",
+        *entries,
+        "};",
+        "",
+        "static const char dictionary_hot_keys[] =",
+        *([f'    "{key}\\0"' for key in literals] or ['    ""']),
+    ]
+    lines[-1] += ";"
+    lines += ["", "static const uint8_t dictionary_hot_text[] = {", c_list(text or b"\0"), "};"]
+    # Pairs, code lengths, entries (12 bytes each), keys and text
+    fap = 4 * max(1, len(pairs)) + 12 * len(entries) + len(keys) + 1 + max(1, len(text))
+    return "\n".join(lines) + "\n", (len(chosen), plain, fap)
+
+
+# --- Sources ---
+
+
+def parse_wordnet(directory, multiword):
+    """Lemma -> definitions from a WordNet database (index.* and data.*).
+
+    Senses are listed by part of speech, then in WordNet's sense order. A
+    gloss keeps its definition parts and drops its quoted examples, as NLTK's
+    Synset.definition() does. Multi-word lemmas (with underscores) are only
+    kept with `multiword`, spelled with spaces.
+    """
+    senses = {}
+    synsets = 0
+    for pos in WORDNET_POS:
+        glosses = {}
+        with open(os.path.join(directory, f"data.{pos}"), encoding="utf-8") as f:
+            for line in f:
+                if line.startswith("  "):
+                    continue  # licence header
+                fields, _, gloss = line.partition(" | ")
+                parts = [part.strip() for part in gloss.strip().split(";")]
+                glosses[fields.split(" ", 1)[0]] = "; ".join(
+                    part for part in parts if part and not part.startswith('"')
+                )
+        synsets += len(glosses)
+
+        with open(os.path.join(directory, f"index.{pos}"), encoding="utf-8") as f:
+            for line in f:
+                if line.startswith("  "):
+                    continue
+                fields = line.split()
+                lemma = fields[0]
+                if "_" in lemma:
+                    if not multiword:
+                        continue
+                    lemma = lemma.replace("_", " ")
+                offsets = fields[-int(fields[2]) :]
+                senses.setdefault(lemma, []).extend(glosses[o] for o in offsets if glosses.get(o))
+    return senses, synsets
+
+
+def parse_cmudict(path):
+    """Word -> phones of its first pronunciation (e.g. "R AY1 D")."""
+    phones = {}
+    with open(path, encoding="latin-1") as f:
+        for line in f:
+            if not line.strip() or line.startswith(";;;"):
+                continue
+            word, _, rest = line.partition(" ")
+            word = re.sub(r"\(\d+\)$", "", word).lower()
+            rest = rest.split("#", 1)[0].split()
+            if rest and word not in phones:
+                phones[word] = " ".join(rest)
+    return phones
+
+
+def read_word_list(path):
+    with open(path, encoding="utf-8") as f:
+        return [line.strip() for line in f if line.strip() and not line.startswith("#")]
+
+
+def compile_entries(senses, phones, words):
+    """Sorted (key, definition) pairs plus a report of what was left out.
+
+    Keys are lowercased and must be printable ASCII shorter than
+    MAX_WORD_LENGTH: the device stores them in fixed buffers and compares
+    with strcasecmp(), so longer or non-ASCII keys are rejected rather than
+    truncated or mis-sorted. Definitions are "[phones] gloss; gloss; ...".
+    """
+    report = {"too_long": [], "not_ascii": [], "too_long_definition": [], "not_found": [], "duplicates": 0}
+    merged = {}
+    for word in words if words is not None else senses:
+        key = word.lower()
+        if not key.isascii() or not key.isprintable():
+            report["not_ascii"].append(word)
+        elif len(key) >= MAX_WORD_LENGTH:
+            report["too_long"].append(word)
+        elif not senses.get(key):
+            report["not_found"].append(word)
+        elif key in merged:
+            report["duplicates"] += 1
+        else:
+            merged[key] = senses[key]
+
+    entries = []
+    for key in sorted(merged, key=device_key):
+        definition = "; ".join(merged[key])
+        if key in phones:
+            definition = f"[{phones[key]}] {definition}"
+        data = definition.encode("utf-8")
+        if len(data) > MAX_DEFINITION_LENGTH:
+            report["too_long_definition"].append(key)
+        else:
+            entries.append((key.encode("ascii"), data))
+    return entries, report
+
+
+def build_dat(entries):
+    """engdict.dat in key order, so the FCIX blocks never need offset gaps."""
+    records = []
+    dat = bytearray()
+    for key, data in entries:
+        records.append(Record(key, len(dat), len(data)))
+        dat += data
+    if len(dat) > 0xFFFFFFFF:
+        sys.exit("engdict.dat over 4 GB: offsets are u32")
+    return records, bytes(dat)
+
+
+SYNTH_ONSETS = "b bl br c ch cl cr d dr f fl fr g gl gr h j k l m n p pl pr qu r s sc sh sl sp st t th tr v w wh z".split()
+SYNTH_VOWELS = "a e i o u ai ea ee oa ou y".split()
+SYNTH_CODAS = ["", "", "", "n", "r", "s", "t", "l", "m", "nd", "ng", "nt", "rd", "sk", "st", "ck"]
+SYNTH_PHONES = "AA1 AE1 AH0 AO1 B CH D EH1 ER0 EY1 F G HH IH0 IY1 K L M N NG OW1 P R S SH T UW1 V W Z".split()
+
+
+def synth_word(rng, syllables):
+    return "".join(rng.choice(SYNTH_ONSETS) + rng.choice(SYNTH_VOWELS) + rng.choice(SYNTH_CODAS)
+                   for _ in range(syllables))
+
+
+def synth_entries(count, seed, multiword=0.3):
+    """`count` made-up entries shaped like a WordNet build: pronounceable
+    keys, a share of them multi-word, and "[phones] gloss; gloss" definitions
+    drawn Zipf-like from a fixed vocabulary, so every section scales as a
+    real dictionary of that size would."""
+    rng = random.Random(seed)
+    vocabulary = [synth_word(rng, rng.randint(1, 3)) for _ in range(8000)]
+    vocabulary_weights = [1.0 / (rank + 1) for rank in range(len(vocabulary))]
+    keys = set()
+    while len(keys) < count:
+        if rng.random() < multiword:
+            key = " ".join(synth_word(rng, rng.randint(1, 3)) for _ in range(rng.randint(2, 4)))
+        else:
+            key = synth_word(rng, rng.randint(1, 4))
+        if len(key) < MAX_WORD_LENGTH:
+            keys.add(key)
+
+    entries = []
+    for key in sorted(keys, key=device_key):
+        glosses = []
+        for _ in range(min(12, int(rng.expovariate(0.6)) + 1)):
+            words = rng.choices(vocabulary, vocabulary_weights, k=rng.randint(4, 14))
+            glosses.append(" ".join(words))
+        phones = " ".join(rng.choice(SYNTH_PHONES) for _ in range(rng.randint(2, 8)))
+        entries.append((key.encode("ascii"), f"[{phones}] {'; '.join(glosses)}".encode("ascii")))
+    return entries
+
+
+def verify_build(idx, dat, entries):
+    """Reads the files back the way the device does; returns the problems."""
+    problems = []
+    header = parse_sections(idx)
+    if not header:
+        return ["index header unreadable"]
+    records = parse_v2(idx, header)
+    if len(records) != len(entries):
+        problems.append(f"{len(records)} records for {len(entries)} entries")
+    plain = decompress_dat(dat) if dat.startswith(DZ_MAGIC) else dat
+    if b"GLOS" in header[3]:
+        offset, size = header[3][b"GLOS"]
+        plain = expand_glosses(idx[offset : offset + size], plain, records)
+    for rec, (key, data) in zip(records, entries):
+        if rec.key != key or plain[rec.offset : rec.offset + rec.length] != data:
+            problems.append(f"record {rec.key!r} does not read back")
+    for prev, cur in zip(records, records[1:]):
+        if device_key(prev.key) >= device_key(cur.key):
+            problems.append(f"not in strcasecmp order: {prev.key!r} >= {cur.key!r}")
+    stride = header[1]
+    for rec in records:
+        if not model_v2(records, stride, rec.key, OpCounter()):
+            problems.append(f"bisection misses {rec.key!r}")
+        if b"HASH" in header[3] and not model_hash(idx, header, rec.key, OpCounter()):
+            problems.append(f"hash misses {rec.key!r}")
+    return problems
+
+
+class OpCounter:
+    """Counts storage_file_* calls the way dictionary.c issues them."""
+
+    def __init__(self):
+        self.seeks = 0
+        self.reads = 0
+        self.bytes = 0
+
+    def read(self, size):
+        self.reads += 1
+        self.bytes += size
+
+
+def model_legacy(data, word, ops):
+    # Mirrors the byte-offset bisection that walks records forward from `low`
+    target = device_key(word)
+    low, high = 0, len(data)
+    while low < high:
+        mid = low + (high - low) // 2
+        ops.seeks += 1
+        pos = pivot = low
+        while pos < mid:
+            pivot = pos
+            ops.read(2)
+            (key_len,) = struct.unpack_from("<H", data, pos)
+            ops.seeks += 1
+            pos += 2 + key_len + 6
+        ops.seeks += 1
+        ops.read(2)
+        (key_len,) = struct.unpack_from("<H", data, pivot)
+        ops.read(key_len)
+        key = device_key(data[pivot + 2 : pivot + 2 + key_len])
+        if target == key:
+            ops.read(4)
+            ops.read(2)
+            return True
+        if target < key:
+            high = pivot
+        else:
+            low = pivot + 2 + key_len + 6
+    return False
+
+
+def model_v2(records, stride, word, ops):
+    target = device_key(word)
+    low, high = 0, len(records)
+    while low < high:
+        mid = low + (high - low) // 2
+        ops.seeks += 1
+        ops.read(stride)
+        key = device_key(records[mid].key)
+        if target == key:
+            return True
+        if target < key:
+            high = mid
+        else:
+            low = mid + 1
+    return False
+
+
+def model_fcix(records, block_sizes, word, ops, block_keys=FCIX_BLOCK_KEYS):
+    # Leaders are bisected in RAM; only the block itself is read (none resident)
+    target = device_key(word)
+    keys = [device_key(r.key) for r in records]
+    lo = bisect.bisect_right(keys[::block_keys], target)
+    if lo == 0:
+        return False
+    ops.seeks += 1
+    ops.read(block_sizes[lo - 1])
+    i = bisect.bisect_left(keys, target)
+    return i < len(keys) and keys[i] == target
+
+
+def model_hash(data, header, word, ops):
+    # Displacements in RAM: one slot read, which holds the key to verify
+    _, stride, key_width, sections, _ = header
+    offset, _ = sections[b"HASH"]
+    bucket_count, slot_count, seed, slot_stride = HASH_HEAD.unpack_from(data, offset)
+    key = device_key(word)
+    bucket = fnv1a(key, HASH_BASIS) % bucket_count
+    (d,) = struct.unpack_from("<H", data, offset + HASH_HEAD.size + 2 * bucket)
+    slots = offset + HASH_HEAD.size + (2 * bucket_count + 3) // 4 * 4
+    slot = slots + hash_slot(fnv1a(key, seed), d, slot_count) * slot_stride
+    ops.seeks += 1
+    ops.read(slot_stride)
+    key_pos = slot + 4 + stride - key_width
+    return device_key(data[key_pos : key_pos + data[key_pos - 1]]) == key
+
+
+def cmd_convert(args):
+    records = load_index(args.idx)
+    validate(records)
+    glossed = read_glosses(args.idx) is not None
+    weights = term_section = sound_section = gloss_section = None
+    dat_path = args.dat or os.path.join(os.path.dirname(args.idx), "engdict.dat")
+    reads_text = not (args.no_weights and args.no_terms and args.no_sounds) or args.layout
+    if reads_text or args.dedup or glossed:
+        dat = read_definitions(args.idx, dat_path, records)
+    if not args.no_weights:
+        weights, source = load_weights(records, dat, args.frequency)
+        print(f"random weights from {source}")
+    if not args.no_terms:
+        term_section, report = build_terms(records, dat)
+        print(term_report(report))
+    infl_section = None
+    if not args.no_inflections:
+        infl_section, report = build_infl(records, weights)
+        print(infl_report(report))
+    if not args.no_sounds:
+        sound_section, report = build_sounds(records, dat, weights)
+        print(sound_report(report))
+    line_section = None
+    if args.layout:
+        line_section, report = build_lines(records, dat)
+        print(line_report(report))
+    stored = dat if args.dedup or glossed else None
+    if args.dedup:
+        gloss_section, stored, report = build_glosses(records, dat)
+        print(gloss_report(report))
+    out = build_v2(
+        records,
+        weights,
+        term_section,
+        exact_hash=not args.no_hash,
+        infl_section=infl_section,
+        sound_section=sound_section,
+        signatures=not args.no_signatures,
+        gloss_section=gloss_section,
+        line_section=line_section,
+    )
+    # Going to or from the GLOS layout changes engdict.dat too
+    if stored is not None and stored != read_dat(dat_path):
+        dat_output = os.path.join(os.path.dirname(args.output or args.idx), "engdict.dat")
+        with open(dat_output, "wb") as f:
+            f.write(stored)
+        print(f"{dat_output}: {len(stored)} bytes, plain text")
+    with open(args.output or args.idx, "wb") as f:
+        f.write(out)
+    print(f"{len(records)} records, {len(out)} bytes")
+
+
+def cmd_stats(args):
+    records = load_index(args.idx)
+    legacy = build_legacy(records)
+    version, stride, key_width, recs = build_recs(records)
+    exact_hash = build_hash(records, recs, stride)
+    hash_header = (len(records), stride, key_width, {b"HASH": (0, len(exact_hash))}, version)
+    fcix = build_fcix(records)
+    block_keys, _, block_count, _, _, _ = FCIX_HEAD.unpack_from(fcix, 0)
+    offsets = struct.unpack_from(f"<{block_count + 1}I", fcix, FCIX_HEAD.size)
+    block_sizes = [b - a for a, b in zip(offsets, offsets[1:])]
+    rows = []
+    for name, model in (
+        ("legacy", lambda w, ops: model_legacy(legacy, w, ops)),
+        ("v2", lambda w, ops: model_v2(records, stride, w, ops)),
+        ("fcix", lambda w, ops: model_fcix(records, block_sizes, w, ops, block_keys)),
+        ("hash", lambda w, ops: model_hash(exact_hash, hash_header, w, ops)),
+    ):
+        total = OpCounter()
+        worst = 0
+        for rec in records:
+            ops = OpCounter()
+            if not model(rec.key, ops):
+                sys.exit(f"{name}: lookup failed for {rec.key!r}")
+            # Every hit then costs one seek + one read into engdict.dat
+            ops.seeks += 1
+            ops.read(rec.length)
+            total.seeks += ops.seeks
+            total.reads += ops.reads
+            total.bytes += ops.bytes
+            worst = max(worst, ops.seeks + ops.reads)
+        n = len(records)
+        rows.append((name, total.seeks / n, total.reads / n, total.bytes / n, worst))
+
+    print(f"{len(records)} lookups (every key in the index), {block_keys} keys per FCIX block, per lookup:")
+    print(f"{'layout':<8}{'seeks':>10}{'reads':>10}{'bytes':>10}{'worst ops':>11}")
+    for name, seeks, reads, nbytes, worst in rows:
+        print(f"{name:<8}{seeks:>10.1f}{reads:>10.1f}{nbytes:>10.0f}{worst:>11}")
+
+
+def cmd_compress(args):
+    data = read_dat(args.dat)
+    out = compress_dat(data, args.block_size, args.window, args.lookahead, args.preset)
+    if decompress_dat(out) != data:
+        sys.exit("compressed data does not round-trip")
+    with open(args.output or args.dat, "wb") as f:
+        f.write(out)
+    block_count = (len(data) + args.block_size - 1) // args.block_size
+    print(f"{len(data)} -> {len(out)} bytes ({100 * len(out) / len(data):.1f}%), {block_count} blocks")
+    ram = args.preset + args.block_size + 4 * (block_count + 1)
+    print(f"device RAM: {ram} bytes (preset, block buffer and block directory)")
+
+
+def cmd_hot(args):
+    records = load_index(args.idx)
+    dat_path = args.dat or os.path.join(os.path.dirname(args.idx), "engdict.dat")
+    dat = read_definitions(args.idx, dat_path, records)
+    weights, source = load_weights(records, dat, args.frequency)
+    idx_size = os.path.getsize(args.idx)
+    header, (count, plain, fap) = build_hot(records, dat, weights, args.count, args.max_length, idx_size)
+    with open(args.output, "w") as f:
+        f.write(header)
+    print(f"hot table: {count} words by {source}, {plain} bytes of text in {fap} bytes of the .fap")
+
+
+def cmd_synth(args):
+    entries = synth_entries(args.entries, args.seed)
+    records, dat = build_dat(entries)
+    weights, _ = load_weights(records, dat, None)
+    term_section, term_stats = build_terms(records, dat)
+    infl_section, infl_stats = build_infl(records, weights)
+    sound_section, sound_stats = build_sounds(records, dat, weights)
+    line_section = None
+    if args.layout:
+        line_section, line_stats = build_lines(records, dat)
+    idx = build_v2(
+        records,
+        weights,
+        term_section,
+        args.block_keys,
+        infl_section=infl_section,
+        sound_section=sound_section,
+        line_section=line_section,
+    )
+    block_keys = FCIX_HEAD.unpack_from(build_fcix(records, args.block_keys), 0)[0]
+    os.makedirs(args.output, exist_ok=True)
+    with open(os.path.join(args.output, "engdict.idx"), "wb") as f:
+        f.write(idx)
+    with open(os.path.join(args.output, "engdict.dat"), "wb") as f:
+        f.write(dat)
+    multiword = sum(1 for key, _ in entries if b" " in key)
+    print(f"{len(entries)} records, {multiword} multi-word, {block_keys} keys per FCIX block")
+    print(f"engdict.idx: {len(idx)} bytes, engdict.dat: {len(dat)} bytes")
+    print(term_report(term_stats))
+    print(infl_report(infl_stats))
+    print(sound_report(sound_stats))
+    if line_section:
+        print(line_report(line_stats))
+
+
+def cmd_build(args):
+    senses, synsets = parse_wordnet(args.wordnet, args.multiword)
+    phones = parse_cmudict(args.cmudict) if args.cmudict else {}
+    words = read_word_list(args.words) if args.words else None
+    entries, report = compile_entries(senses, phones, words)
+    if not entries:
+        sys.exit("no entries")
+
+    records, dat = build_dat(entries)
+    weights, source = load_weights(records, dat, args.frequency)
+    term_section, term_stats = build_terms(records, dat)
+    infl_section, infl_stats = build_infl(records, weights, parse_exceptions(args.wordnet))
+    sound_section, sound_stats = build_sounds(records, dat, weights)
+    line_section = None
+    if args.layout:
+        line_section, line_stats = build_lines(records, dat)
+    gloss_section = None
+    if args.dedup:
+        gloss_section, dat, gloss_stats = build_glosses(records, dat)
+    idx = build_v2(
+        records,
+        weights,
+        term_section,
+        infl_section=infl_section,
+        sound_section=sound_section,
+        gloss_section=gloss_section,
+        line_section=line_section,
+    )
+    plain_size = len(dat)
+    if args.compress:
+        dat = compress_dat(dat, DZ_BLOCK_SIZE, DZ_WINDOW_BITS, DZ_LOOKAHEAD_BITS, DZ_PRESET_SIZE)
+    problems = verify_build(idx, dat, entries)
+
+    key_lengths = [len(key) for key, _ in entries]
+    lengths = sorted(len(data) for _, data in entries)
+    lines = [
+        "EngDict build report",
+        f"sources: {len(senses)} WordNet lemmas in {synsets} synsets, {len(phones)} CMUdict words"
+        + (f", {len(words)} listed words" if words is not None else ""),
+        f"records: {len(entries)}, {sum(1 for k, _ in entries if k.decode() in phones)} with phonetics",
+        f"keys: longest {max(key_lengths)} of {MAX_WORD_LENGTH - 1} bytes",
+        f"definitions: median {lengths[len(lengths) // 2]}, longest {lengths[-1]} bytes",
+        f"engdict.idx: {len(idx)} bytes, random weights from {source}",
+        term_report(term_stats),
+        infl_report(infl_stats),
+        sound_report(sound_stats),
+    ]
+    if line_section:
+        lines.append(line_report(line_stats))
+    if gloss_section:
+        lines.append(gloss_report(gloss_stats))
+    lines += [
+        f"engdict.dat: {len(dat)} bytes" + (f" compressed from {plain_size}" if args.compress else ""),
+        f"duplicate words: {report['duplicates']}",
+    ]
+    for reason, label in (
+        ("too_long", f"rejected, key of {MAX_WORD_LENGTH} bytes or more"),
+        ("not_ascii", "rejected, key not printable ASCII"),
+        ("too_long_definition", f"rejected, definition over {MAX_DEFINITION_LENGTH} bytes"),
+        ("not_found", "listed words without a WordNet entry"),
+    ):
+        items = report[reason]
+        examples = ", ".join(items[:10]) + (", ..." if len(items) > 10 else "")
+        lines.append(f"{label}: {len(items)}" + (f" ({examples})" if items else ""))
+    lines.append("verification: " + ("passed" if not problems else f"{len(problems)} problems"))
+    lines += [f"  {p}" for p in problems[:20]]
+    text = "\n".join(lines) + "\n"
+    print(text, end="")
+    if args.report:
+        with open(args.report, "w") as f:
+            f.write(text)
+    if problems:
+        sys.exit("verification failed, nothing written")
+
+    os.makedirs(args.output, exist_ok=True)
+    with open(os.path.join(args.output, "engdict.idx"), "wb") as f:
+        f.write(idx)
+    with open(os.path.join(args.output, "engdict.dat"), "wb") as f:
+        f.write(dat)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("build", help="compile engdict.idx and engdict.dat from source corpora")
+    p.add_argument("--wordnet", required=True, help="WordNet database directory (index.*, data.*)")
+    p.add_argument("--cmudict", help="CMU Pronouncing Dictionary for the phonetics")
+    p.add_argument("--words", help="word list to restrict the dictionary to, one per line")
+    p.add_argument("--frequency", help="word list in frequency order for random weights")
+    p.add_argument("--multiword", action="store_true", help="keep multi-word WordNet lemmas")
+    p.add_argument("--compress", action="store_true", help="block-compress engdict.dat")
+    p.add_argument("--dedup", action="store_true", help="store each gloss once (GLOS section)")
+    p.add_argument("--layout", action="store_true", help="add the LINE section (wrapped result lines)")
+    p.add_argument("--report", help="also write the verification report here")
+    p.add_argument("-o", "--output", required=True, help="output directory")
+    p.set_defaults(func=cmd_build)
+
+    p = sub.add_parser("convert", help="rewrite an index in the current (v2) layout")
+    p.add_argument("idx")
+    p.add_argument("-o", "--output", help="output path (default: in place)")
+    p.add_argument("--dat", help="engdict.dat for sense-count weights (default: next to idx)")
+    p.add_argument("--frequency", help="word list in frequency order for random weights")
+    p.add_argument("--no-weights", action="store_true", help="omit the RAND section")
+    p.add_argument("--no-terms", action="store_true", help="omit the TERM section (reverse lookup)")
+    p.add_argument("--no-hash", action="store_true", help="omit the HASH section (exact lookups)")
+    p.add_argument("--no-inflections", action="store_true", help="omit the INFL section (inflected forms)")
+    p.add_argument("--no-sounds", action="store_true", help="omit the SNDX section (sound-alike suggestions)")
+    p.add_argument("--no-signatures", action="store_true", help="omit the SIGS section (wildcards, anagrams)")
+    p.add_argument("--layout", action="store_true", help="add the LINE section (wrapped result lines)")
+    p.add_argument("--dedup", action="store_true", help="store each gloss once (GLOS section)")
+    p.set_defaults(func=cmd_convert)
+
+    p = sub.add_parser("stats", help="model SD operations per lookup for each layout")
+    p.add_argument("idx")
+    p.set_defaults(func=cmd_stats)
+
+    p = sub.add_parser("hot", help="compile the most common entries into a C header for the .fap")
+    p.add_argument("idx")
+    p.add_argument("--dat", help="engdict.dat (default: next to idx)")
+    p.add_argument("--frequency", help="word list in frequency order (default: sense counts)")
+    p.add_argument("--count", type=int, default=HOT_COUNT, help="number of entries")
+    p.add_argument("--max-length", type=int, default=HOT_MAX_LENGTH, help="longest definition taken")
+    p.add_argument("-o", "--output", required=True, help="header to write")
+    p.set_defaults(func=cmd_hot)
+
+    p = sub.add_parser("synth", help="generate a made-up dictionary of any size, for benchmarks")
+    p.add_argument("--entries", type=int, required=True, help="number of records")
+    p.add_argument("--seed", type=int, default=1, help="random seed")
+    p.add_argument("--block-keys", type=int, help="keys per FCIX block (default: sized to the RAM target)")
+    p.add_argument("--layout", action="store_true", help="add the LINE section (wrapped result lines)")
+    p.add_argument("-o", "--output", required=True, help="output directory")
+    p.set_defaults(func=cmd_synth)
+
+    p = sub.add_parser("compress", help="block-compress engdict.dat (plain or compressed)")
+    p.add_argument("dat")
+    p.add_argument("-o", "--output", help="output path (default: in place)")
+    p.add_argument("--block-size", type=int, default=DZ_BLOCK_SIZE, help="uncompressed block size")
+    p.add_argument("--window", type=int, default=DZ_WINDOW_BITS, help="window size bits")
+    p.add_argument("--lookahead", type=int, default=DZ_LOOKAHEAD_BITS, help="match length bits")
+    p.add_argument("--preset", type=int, default=DZ_PRESET_SIZE, help="preset dictionary size")
+    p.set_defaults(func=cmd_compress)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,1077 @@
+// Host benchmark for the lookup core: looks up every headword in engdict.idx
+// (in a fixed shuffled order) through the POSIX backend and reports
+// throughput, latency and the SD operations each lookup would issue on the
+// device. With -c it types every headword into the prefix completer instead,
+// with -f it looks up misspelt headwords and checks the suggestions, with -k
+// it replays a browsing trace with history revisits through the result cache,
+// with -p it scrolls every result through the pager of the result view, with
+// -r it describes headwords by their first gloss and runs reverse lookups,
+// with -w it runs wildcard and anagram queries made from headwords, with -g
+// it writes glossaries of word lists and compares them with lookups one by one.
+
+#include "../../dictionary_batch.h"
+#include "../../dictionary_cache.h"
+#include "../../dictionary_complete.h"
+#include "../../dictionary_pager.h"
+#include "../../dictionary_pattern.h"
+#include "../../dictionary_reverse.h"
+#include "../../dictionary_suggest.h"
+#include "dictionary_storage_posix.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    const char* dir;
+    size_t ram_budget;
+    double seek_us; // modelled cost of one SD seek
+    double byte_us; // modelled cost of one byte read from SD
+    bool complete; // benchmark keystrokes instead of lookups
+    bool fuzzy; // benchmark suggestions for misspelt words
+    size_t cache_budget; // replay a history trace through the result cache
+    bool pager; // benchmark scrolling results line by line
+    bool reverse; // benchmark reverse lookups over the definitions
+    bool patterns; // benchmark wildcard and anagram searches
+    bool glossary; // benchmark glossaries of word lists
+} BenchOptions;
+
+typedef struct {
+    size_t bytes;
+} BenchSink;
+
+// Results at least this long count as long definitions in the summary
+#define BENCH_LONG_RESULT 1024
+
+static void bench_output_write(void* context, const char* text, size_t length) {
+    (void)text;
+    ((BenchSink*)context)->bytes += length;
+}
+
+static double bench_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int bench_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double bench_percentile(double* sorted, size_t count, double p) {
+    size_t i = (size_t)(p * (count - 1) + 0.5);
+    return sorted[i];
+}
+
+// Reads every headword from the RECS table
+static char* bench_load_words(DictionaryStorage* storage, const char* idx_path, uint32_t* count) {
+    DictionaryFile* file = dictionary_storage_open(storage, idx_path);
+    DictionaryIndexInfo info;
+    if(!file || !dictionary_index_read_header(storage, file, &info)) {
+        fprintf(stderr, "%s: missing or not a v2 index\n", idx_path);
+        exit(1);
+    }
+
+    char* words = malloc((size_t)info.record_count * MAX_WORD_LENGTH);
+    for(uint32_t i = 0; i < info.record_count; i++) {
+        DictionaryRecord record;
+        if(!dictionary_index_read_record(storage, file, &info, i, &record)) {
+            fprintf(stderr, "%s: bad record %u\n", idx_path, i);
+            exit(1);
+        }
+        memcpy(words + (size_t)i * MAX_WORD_LENGTH, record.key, MAX_WORD_LENGTH);
+    }
+    dictionary_storage_close(storage, file);
+    *count = info.record_count;
+    return words;
+}
+
+// Fisher-Yates with a fixed LCG so runs are comparable
+static void bench_shuffle(char* words, uint32_t count) {
+    uint32_t state = 12345;
+    char tmp[MAX_WORD_LENGTH];
+    for(uint32_t i = count - 1; i > 0; i--) {
+        state = state * 1103515245u + 12345u;
+        uint32_t j = (state >> 8) % (i + 1);
+        memcpy(tmp, words + (size_t)i * MAX_WORD_LENGTH, MAX_WORD_LENGTH);
+        memcpy(
+            words + (size_t)i * MAX_WORD_LENGTH,
+            words + (size_t)j * MAX_WORD_LENGTH,
+            MAX_WORD_LENGTH);
+        memcpy(words + (size_t)j * MAX_WORD_LENGTH, tmp, MAX_WORD_LENGTH);
+    }
+}
+
+static void bench_print_modelled(const BenchOptions* options, double* modelled, uint32_t count) {
+    double sum = 0;
+    for(uint32_t i = 0; i < count; i++)
+        sum += modelled[i];
+    qsort(modelled, count, sizeof(double), bench_compare_double);
+    printf(
+        "modelled SD us   mean %.0f  p50 %.0f  p99 %.0f  (%.0f us/seek, %.3f us/byte)\n",
+        sum / count,
+        bench_percentile(modelled, count, 0.50),
+        bench_percentile(modelled, count, 0.99),
+        options->seek_us,
+        options->byte_us);
+}
+
+// Types every word one character at a time; the word itself must come up as
+// the first completion once fully typed.
+static int bench_complete(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    uint32_t count) {
+    uint32_t keystrokes = 0;
+    for(uint32_t i = 0; i < count; i++)
+        keystrokes += strlen(words + (size_t)i * MAX_WORD_LENGTH);
+
+    double* latency = malloc(keystrokes * sizeof(double));
+    double* modelled = malloc(keystrokes * sizeof(double));
+    DictionaryStorageStats total = {0};
+    uint32_t max_reads = 0, truncated = 0, misses = 0, k = 0;
+    DictionaryCompleter* completer = dictionary_completer_alloc(dict);
+    DictionaryCompletions completions;
+
+    double start = bench_now_us();
+    for(uint32_t i = 0; i < count; i++) {
+        const char* word = words + (size_t)i * MAX_WORD_LENGTH;
+        char prefix[MAX_WORD_LENGTH];
+        size_t len = strlen(word);
+        for(size_t n = 1; n <= len; n++, k++) {
+            memcpy(prefix, word, n);
+            prefix[n] = '\0';
+            memset(&storage->stats, 0, sizeof(storage->stats));
+            double t0 = bench_now_us();
+            dictionary_completer_update(completer, prefix, &completions);
+            latency[k] = bench_now_us() - t0;
+
+            const DictionaryStorageStats* s = &storage->stats;
+            modelled[k] = s->seeks * options->seek_us + s->bytes_read * options->byte_us;
+            total.seeks += s->seeks;
+            total.reads += s->reads;
+            total.bytes_read += s->bytes_read;
+            if(s->reads > max_reads) max_reads = s->reads;
+            if(completions.truncated) truncated++;
+        }
+        if(completions.count == 0 || strcmp(completions.words[0], word) != 0) misses++;
+    }
+    double elapsed = bench_now_us() - start;
+    dictionary_completer_free(completer);
+
+    qsort(latency, keystrokes, sizeof(double), bench_compare_double);
+    printf("keystrokes       %u over %u words (%u misses)\n", keystrokes, count, misses);
+    printf("keystrokes/sec   %.0f\n", keystrokes / (elapsed / 1e6));
+    printf(
+        "latency us       p50 %.2f  p99 %.2f  max %.2f\n",
+        bench_percentile(latency, keystrokes, 0.50),
+        bench_percentile(latency, keystrokes, 0.99),
+        latency[keystrokes - 1]);
+    printf(
+        "per keystroke    %.2f seeks  %.2f reads (max %u)  %.0f bytes, %u truncated\n",
+        (double)total.seeks / keystrokes,
+        (double)total.reads / keystrokes,
+        max_reads,
+        (double)total.bytes_read / keystrokes,
+        truncated);
+    bench_print_modelled(options, modelled, keystrokes);
+
+    free(latency);
+    free(modelled);
+    return misses ? 1 : 0;
+}
+
+static uint32_t bench_random(uint32_t* state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
+
+static int bench_compare_word(const void* a, const void* b) {
+    return strcmp(a, b);
+}
+
+// Applies one random substitution, deletion, insertion or transposition
+static void bench_misspell(char* word, uint32_t* state) {
+    size_t len = strlen(word);
+    size_t pos = bench_random(state) % len;
+    char letter = 'a' + bench_random(state) % 26;
+    switch(bench_random(state) % 4) {
+    case 0:
+        word[pos] = letter;
+        break;
+    case 1:
+        memmove(word + pos, word + pos + 1, len - pos);
+        break;
+    case 2:
+        if(len + 1 >= MAX_WORD_LENGTH) break;
+        memmove(word + pos + 1, word + pos, len - pos + 1);
+        word[pos] = letter;
+        break;
+    default:
+        if(pos + 1 < len) {
+            char tmp = word[pos];
+            word[pos] = word[pos + 1];
+            word[pos + 1] = tmp;
+        }
+        break;
+    }
+}
+
+// Misspells every headword of 4+ letters with `edits` random edits (skipping
+// results that are headwords themselves) and checks that the original comes
+// back as a suggestion.
+static void bench_fuzzy_pass(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    const char* sorted,
+    uint32_t count,
+    uint8_t edits) {
+    double* latency = malloc(count * sizeof(double));
+    double* modelled = malloc(count * sizeof(double));
+    DictionaryStorageStats total = {0};
+    uint32_t queries = 0, found = 0, first = 0, empty = 0, max_reads = 0;
+    uint32_t state = 777 + edits;
+
+    for(uint32_t i = 0; i < count; i++) {
+        const char* word = words + (size_t)i * MAX_WORD_LENGTH;
+        if(strlen(word) < 4) continue;
+        char typo[MAX_WORD_LENGTH];
+        memcpy(typo, word, MAX_WORD_LENGTH);
+        for(uint8_t e = 0; e < edits; e++)
+            bench_misspell(typo, &state);
+        if(typo[0] == '\0' ||
+           bsearch(typo, sorted, count, MAX_WORD_LENGTH, bench_compare_word)) {
+            continue;
+        }
+
+        DictionarySuggestions suggestions;
+        memset(&storage->stats, 0, sizeof(storage->stats));
+        double t0 = bench_now_us();
+        dictionary_suggest(dict, typo, &suggestions);
+        latency[queries] = bench_now_us() - t0;
+
+        const DictionaryStorageStats* s = &storage->stats;
+        modelled[queries] = s->seeks * options->seek_us + s->bytes_read * options->byte_us;
+        total.seeks += s->seeks;
+        total.reads += s->reads;
+        total.bytes_read += s->bytes_read;
+        if(s->reads > max_reads) max_reads = s->reads;
+        queries++;
+
+        if(suggestions.count == 0) empty++;
+        for(uint8_t k = 0; k < suggestions.count; k++) {
+            if(strcmp(suggestions.words[k], word) == 0) {
+                found++;
+                if(k == 0) first++;
+                break;
+            }
+        }
+    }
+
+    qsort(latency, queries, sizeof(double), bench_compare_double);
+    printf("%u edit(s)        %u misspellings\n", edits, queries);
+    printf(
+        "  recall         %.1f%% suggested, %.1f%% first, %.1f%% no suggestion\n",
+        100.0 * found / queries,
+        100.0 * first / queries,
+        100.0 * empty / queries);
+    printf(
+        "  latency us     p50 %.2f  p99 %.2f\n",
+        bench_percentile(latency, queries, 0.50),
+        bench_percentile(latency, queries, 0.99));
+    printf(
+        "  per query      %.2f seeks  %.2f reads (max %u)  %.0f bytes\n",
+        (double)total.seeks / queries,
+        (double)total.reads / queries,
+        max_reads,
+        (double)total.bytes_read / queries);
+    printf("  ");
+    bench_print_modelled(options, modelled, queries);
+
+    free(latency);
+    free(modelled);
+}
+
+static int bench_fuzzy(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    uint32_t count) {
+    char* sorted = malloc((size_t)count * MAX_WORD_LENGTH);
+    memcpy(sorted, words, (size_t)count * MAX_WORD_LENGTH);
+    qsort(sorted, count, MAX_WORD_LENGTH, bench_compare_word);
+    bench_fuzzy_pass(options, dict, storage, words, sorted, count, 1);
+    bench_fuzzy_pass(options, dict, storage, words, sorted, count, 2);
+    free(sorted);
+    return 0;
+}
+
+// A cache miss in the app: the definition is read into a new cache entry, or
+// formatted straight from SD when it is too long to cache
+static bool bench_fetch(
+    Dictionary* dict,
+    DictionaryCache* cache,
+    const char* word,
+    DictionaryOutput* out,
+    uint32_t* streamed) {
+    DictionaryEntry entry = {.dict = dict};
+    if(dictionary_find(dict, word, &entry.record) != DictionaryStatusOk) return false;
+
+    const DictionaryRecord* record = &entry.record;
+    char* text = dictionary_cache_reserve(cache, word, record->length);
+    if(text) {
+        return dictionary_read_definition(dict, record, 0, text, record->length) ==
+               record->length;
+    }
+    DictionaryTextSource source;
+    DictionaryFormatter formatter;
+    dictionary_entry_get_source(&entry, &source);
+    dictionary_formatter_init(&formatter, &source, record->key);
+    (*streamed)++;
+    return dictionary_formatter_write_all(&formatter, out);
+}
+
+// Looks every word up once, revisiting one of the last ten (the History
+// menu) after 30% of them, the way the app does: cache first, SD on a miss,
+// with definitions too long to cache formatted straight from SD.
+static int bench_history(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    uint32_t count) {
+    DictionaryCache* cache = dictionary_cache_alloc(options->cache_budget);
+    BenchSink sink = {0};
+    DictionaryOutput out = {bench_output_write, &sink};
+    DictionaryStorageStats total = {0};
+    double modelled_sum = 0;
+    uint32_t lookups = 0, misses = 0, streamed = 0, state = 99;
+
+    double start = bench_now_us();
+    for(uint32_t i = 0; i < count; i++) {
+        for(int step = 0; step < 2; step++) {
+            const char* word = words + (size_t)i * MAX_WORD_LENGTH;
+            if(step == 1) {
+                if(i == 0 || bench_random(&state) % 10 >= 3) break;
+                uint32_t back = bench_random(&state) % (i < 10 ? i : 10) + 1;
+                word = words + (size_t)(i - back) * MAX_WORD_LENGTH;
+            }
+            memset(&storage->stats, 0, sizeof(storage->stats));
+            lookups++;
+            if(!dictionary_cache_get(cache, word, NULL) &&
+               !bench_fetch(dict, cache, word, &out, &streamed)) {
+                misses++;
+            }
+            const DictionaryStorageStats* s = &storage->stats;
+            modelled_sum += s->seeks * options->seek_us + s->bytes_read * options->byte_us;
+            total.seeks += s->seeks;
+            total.reads += s->reads;
+            total.bytes_read += s->bytes_read;
+        }
+    }
+    double elapsed = bench_now_us() - start;
+
+    const DictionaryCacheStats* stats = dictionary_cache_get_stats(cache);
+    printf(
+        "lookups          %u (%u misses), %u revisits, %u streamed\n",
+        lookups,
+        misses,
+        lookups - count,
+        streamed);
+    printf("lookups/sec      %.0f\n", lookups / (elapsed / 1e6));
+    printf(
+        "cache            %zu byte budget: %u hits (%.1f%%), %u evictions, %u entries / %zu B\n",
+        stats->budget,
+        stats->hits,
+        100.0 * stats->hits / lookups,
+        stats->evictions,
+        stats->entries,
+        stats->bytes);
+    printf(
+        "per lookup       %.2f seeks  %.2f reads  %.0f bytes, modelled SD mean %.0f us\n",
+        (double)total.seeks / lookups,
+        (double)total.reads / lookups,
+        (double)total.bytes_read / lookups,
+        modelled_sum / lookups);
+
+    dictionary_cache_free(cache);
+    return misses ? 1 : 0;
+}
+
+// Opens every result in the pager and scrolls it a line at a time to the
+// end and back a page at a time to the top, as on the result screen. With
+// the LINE section the pager knows the line count, which has to be where
+// scrolling ends.
+static int bench_pager(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    uint32_t count) {
+    static DictionaryPager pager;
+    DictionaryStorageStats open = {0}, scroll = {0};
+    uint32_t errors = 0, scrolls = 0, longest = 0, laid_out = 0;
+    double open_modelled = 0, scroll_modelled = 0, scroll_max = 0;
+
+    double start = bench_now_us();
+    for(uint32_t i = 0; i < count; i++) {
+        DictionaryEntry entry = {.dict = dict};
+        DictionaryTextSource source;
+        memset(&storage->stats, 0, sizeof(storage->stats));
+        if(dictionary_find(dict, words + (size_t)i * MAX_WORD_LENGTH, &entry.record) !=
+           DictionaryStatusOk) {
+            errors++;
+            continue;
+        }
+        if(dictionary_entry_load_layout(&entry)) laid_out++;
+        dictionary_entry_get_source(&entry, &source);
+        if(!dictionary_pager_init(&pager, &source, entry.record.key)) errors++;
+        uint32_t lines = dictionary_pager_get_line_count(&pager);
+        if(entry.record.length > longest) longest = entry.record.length;
+        const DictionaryStorageStats* s = &storage->stats;
+        open_modelled += s->seeks * options->seek_us + s->bytes_read * options->byte_us;
+        open.seeks += s->seeks;
+        open.reads += s->reads;
+        open.bytes_read += s->bytes_read;
+
+        for(int32_t step = 1; step != 0;) {
+            if(step > 0 && pager.at_end) {
+                if(lines > 0 && pager.top + pager.line_count != lines) errors++;
+                step = -DICTIONARY_PAGER_LINES;
+            }
+            if(step < 0 && pager.top == 0) break;
+            memset(&storage->stats, 0, sizeof(storage->stats));
+            if(!dictionary_pager_scroll(&pager, step)) errors++;
+            double modelled = s->seeks * options->seek_us + s->bytes_read * options->byte_us;
+            scroll_modelled += modelled;
+            if(modelled > scroll_max) scroll_max = modelled;
+            scroll.seeks += s->seeks;
+            scroll.reads += s->reads;
+            scroll.bytes_read += s->bytes_read;
+            scrolls++;
+        }
+    }
+    double elapsed = bench_now_us() - start;
+
+    printf("results          %u (%u errors), %u scrolls\n", count, errors, scrolls);
+    printf("laid out         %u results\n", laid_out);
+    printf("results/sec      %.0f\n", count / (elapsed / 1e6));
+    printf(
+        "per open         %.2f seeks  %.2f reads  %.0f bytes, modelled SD mean %.0f us\n",
+        (double)open.seeks / count,
+        (double)open.reads / count,
+        (double)open.bytes_read / count,
+        open_modelled / count);
+    printf(
+        "per scroll       %.2f seeks  %.2f reads  %.0f bytes, modelled SD mean %.0f max %.0f us\n",
+        (double)scroll.seeks / scrolls,
+        (double)scroll.reads / scrolls,
+        (double)scroll.bytes_read / scrolls,
+        scroll_modelled / scrolls,
+        scroll_max);
+    printf(
+        "pager RAM        %zu bytes, longest definition %u bytes\n",
+        sizeof(DictionaryPager),
+        longest);
+    return errors ? 1 : 0;
+}
+
+// Reverse queries per headword: one for every BENCH_REVERSE_STRIDE-th word
+#define BENCH_REVERSE_STRIDE 10
+// Words of the first gloss used as the query
+#define BENCH_REVERSE_WORDS 2
+
+// Builds a query from the first words of 4+ letters of the first gloss of
+// `record`, the way a user might describe the word; false if it has none
+static bool bench_reverse_query(Dictionary* dict, const DictionaryRecord* record, char* query) {
+    char text[256];
+    size_t length = dictionary_read_definition(dict, record, 0, text, sizeof(text) - 1);
+    text[length] = '\0';
+    char* gloss = text[0] == '[' && strchr(text, ']') ? strchr(text, ']') + 1 : text;
+    gloss[strcspn(gloss, ";")] = '\0';
+
+    query[0] = '\0';
+    uint8_t words = 0;
+    for(char* c = gloss; *c && words < BENCH_REVERSE_WORDS;) {
+        size_t run = 0;
+        while((c[run] >= 'a' && c[run] <= 'z') || (c[run] >= 'A' && c[run] <= 'Z'))
+            run++;
+        if(run >= 4 && strlen(query) + run + 2 < MAX_WORD_LENGTH) {
+            if(words++) strcat(query, " ");
+            strncat(query, c, run);
+        }
+        c += run ? run : 1;
+    }
+    return words == BENCH_REVERSE_WORDS;
+}
+
+// Describes every tenth headword by the first words of its first gloss and
+// checks that it comes back among the results.
+static int bench_reverse(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    uint32_t count) {
+    double* latency = malloc(count * sizeof(double));
+    double* modelled = malloc(count * sizeof(double));
+    DictionaryStorageStats total = {0};
+    uint32_t queries = 0, found = 0, first = 0, empty = 0, all_terms = 0, max_reads = 0;
+    uint64_t matches = 0;
+
+    for(uint32_t i = 0; i < count; i += BENCH_REVERSE_STRIDE) {
+        const char* word = words + (size_t)i * MAX_WORD_LENGTH;
+        DictionaryRecord record;
+        char query[MAX_WORD_LENGTH];
+        if(dictionary_find(dict, word, &record) != DictionaryStatusOk ||
+           !bench_reverse_query(dict, &record, query)) {
+            continue;
+        }
+
+        DictionaryReverseResults results;
+        memset(&storage->stats, 0, sizeof(storage->stats));
+        double t0 = bench_now_us();
+        DictionaryStatus status = dictionary_reverse_search(dict, query, &results);
+        latency[queries] = bench_now_us() - t0;
+        if(status != DictionaryStatusOk && status != DictionaryStatusNotFound) {
+            fprintf(stderr, "\"%s\": %s\n", query, dictionary_status_get_text(status));
+            free(latency);
+            free(modelled);
+            return 1;
+        }
+
+        const DictionaryStorageStats* s = &storage->stats;
+        modelled[queries] = s->seeks * options->seek_us + s->bytes_read * options->byte_us;
+        total.seeks += s->seeks;
+        total.reads += s->reads;
+        total.bytes_read += s->bytes_read;
+        if(s->reads > max_reads) max_reads = s->reads;
+        if(queries < 3) {
+            printf("example          \"%s\" (%s):", query, word);
+            for(uint8_t k = 0; k < results.count; k++)
+                printf(" %s", results.words[k]);
+            printf("\n");
+        }
+        queries++;
+
+        matches += results.matches;
+        if(results.matches > 0) all_terms++;
+        if(results.count == 0) empty++;
+        for(uint8_t k = 0; k < results.count; k++) {
+            if(strcmp(results.words[k], record.key) == 0) {
+                found++;
+                if(k == 0) first++;
+                break;
+            }
+        }
+    }
+
+    qsort(latency, queries, sizeof(double), bench_compare_double);
+    printf("queries          %u, %u words from the first gloss\n", queries, BENCH_REVERSE_WORDS);
+    printf(
+        "recall           %.1f%% listed, %.1f%% first, %.1f%% no result\n",
+        100.0 * found / queries,
+        100.0 * first / queries,
+        100.0 * empty / queries);
+    printf(
+        "matches          %.1f entries use every term on average\n",
+        (double)matches / queries);
+    printf(
+        "latency us       p50 %.2f  p99 %.2f\n",
+        bench_percentile(latency, queries, 0.50),
+        bench_percentile(latency, queries, 0.99));
+    printf(
+        "per query        %.2f seeks  %.2f reads (max %u)  %.0f bytes\n",
+        (double)total.seeks / queries,
+        (double)total.reads / queries,
+        max_reads,
+        (double)total.bytes_read / queries);
+    bench_print_modelled(options, modelled, queries);
+
+    free(latency);
+    free(modelled);
+    return 0;
+}
+
+// Pattern queries per headword: one of each kind for every
+// BENCH_PATTERN_STRIDE-th word of three or more letters
+#define BENCH_PATTERN_STRIDE 10
+#define BENCH_PATTERN_KINDS  3
+
+static const char* const bench_pattern_kinds[BENCH_PATTERN_KINDS] = {
+    "anagram",
+    "c?t?",
+    "ab*on",
+};
+
+static int bench_compare_char(const void* a, const void* b) {
+    return *(const char*)a - *(const char*)b;
+}
+
+// Makes a query of `kind` that `word` must match: its letters sorted, every
+// other letter replaced by '?', or its first and last two letters around a
+// '*'. False if the word is not suited to it.
+static bool bench_pattern_query(const char* word, uint8_t kind, char* query) {
+    size_t length = strlen(word);
+    if(length < 3 || dictionary_pattern_signature(word) == 0) return false;
+    strcpy(query, word);
+    if(kind == 0) {
+        qsort(query, length, 1, bench_compare_char);
+        return strcmp(query, word) != 0; // the query itself is never listed
+    }
+    if(kind == 1) {
+        for(size_t i = 1; i < length; i += 2)
+            query[i] = '?';
+        return true;
+    }
+    if(length < 5) return false;
+    memcpy(query + 2, "*", 2);
+    strcat(query, word + length - 2);
+    return true;
+}
+
+// Runs each kind of query over every tenth headword, first with the
+// signature table in RAM and then read from the card per query, and checks
+// that the word is listed unless the search was cut short.
+static int bench_patterns(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    uint32_t count) {
+    double* latency = malloc(count * sizeof(double));
+    double* modelled = malloc(count * sizeof(double));
+
+    for(uint8_t resident = 2; resident-- > 0;) {
+        memset(&storage->stats, 0, sizeof(storage->stats));
+        DictionaryPatterns* patterns = dictionary_patterns_alloc(dict, resident ? SIZE_MAX : 0);
+        if(!patterns) {
+            fprintf(stderr, "no SIGS section in the index\n");
+            free(latency);
+            free(modelled);
+            return 1;
+        }
+        printf(
+            "signatures       %s, %zu bytes of RAM, load %u reads\n",
+            resident ? "in RAM" : "on SD",
+            dictionary_patterns_get_size(patterns),
+            storage->stats.reads);
+
+        for(uint8_t kind = 0; kind < BENCH_PATTERN_KINDS; kind++) {
+            DictionaryStorageStats total = {0};
+            uint32_t queries = 0, found = 0, truncated = 0, max_reads = 0;
+            uint64_t candidates = 0;
+            for(uint32_t i = 0; i < count; i += BENCH_PATTERN_STRIDE) {
+                const char* word = words + (size_t)i * MAX_WORD_LENGTH;
+                char query[MAX_WORD_LENGTH];
+                if(!bench_pattern_query(word, kind, query)) continue;
+
+                DictionaryPatternResults results;
+                memset(&storage->stats, 0, sizeof(storage->stats));
+                double t0 = bench_now_us();
+                DictionaryStatus status =
+                    dictionary_patterns_search(patterns, query, kind == 0, &results);
+                latency[queries] = bench_now_us() - t0;
+                if(status != DictionaryStatusOk && status != DictionaryStatusNotFound) {
+                    fprintf(stderr, "\"%s\": %s\n", query, dictionary_status_get_text(status));
+                    dictionary_patterns_free(patterns);
+                    free(latency);
+                    free(modelled);
+                    return 1;
+                }
+
+                const DictionaryStorageStats* s = &storage->stats;
+                modelled[queries] = s->seeks * options->seek_us + s->bytes_read * options->byte_us;
+                total.seeks += s->seeks;
+                total.reads += s->reads;
+                total.bytes_read += s->bytes_read;
+                if(s->reads > max_reads) max_reads = s->reads;
+                if(resident && queries < 2) {
+                    printf("example          \"%s\" (%s):", query, word);
+                    for(uint8_t k = 0; k < results.count; k++)
+                        printf(" %s", results.words[k]);
+                    printf("\n");
+                }
+                queries++;
+
+                candidates += results.candidates;
+                bool listed = false;
+                for(uint8_t k = 0; k < results.count && !listed; k++)
+                    listed = strcmp(results.words[k], word) == 0;
+                if(listed) found++;
+                if(results.truncated) {
+                    truncated++;
+                } else if(!listed) {
+                    fprintf(stderr, "\"%s\": %s not listed\n", query, word);
+                    dictionary_patterns_free(patterns);
+                    free(latency);
+                    free(modelled);
+                    return 1;
+                }
+            }
+
+            qsort(latency, queries, sizeof(double), bench_compare_double);
+            printf(
+                "%-16s %u queries, %.1f%% listed, %.1f%% cut short, %.1f candidates\n",
+                bench_pattern_kinds[kind],
+                queries,
+                100.0 * found / queries,
+                100.0 * truncated / queries,
+                (double)candidates / queries);
+            printf(
+                "latency us       p50 %.2f  p99 %.2f\n",
+                bench_percentile(latency, queries, 0.50),
+                bench_percentile(latency, queries, 0.99));
+            printf(
+                "per query        %.2f seeks  %.2f reads (max %u)  %.0f bytes\n",
+                (double)total.seeks / queries,
+                (double)total.reads / queries,
+                max_reads,
+                (double)total.bytes_read / queries);
+            bench_print_modelled(options, modelled, queries);
+        }
+        dictionary_patterns_free(patterns);
+    }
+
+    free(latency);
+    free(modelled);
+    return 0;
+}
+
+// Word lists of these sizes, one word in BENCH_GLOSSARY_MISSPELT misspelt
+static const uint32_t bench_glossary_sizes[] = {100, 1000, 10000};
+#define BENCH_GLOSSARY_MISSPELT 10
+// As the app's default DICTIONARY_GLOSSARY_RAM_BUDGET
+#define BENCH_GLOSSARY_RAM_BUDGET (16 * 1024)
+
+// Bytes written to the runs file are costed as bytes read
+static double bench_modelled_total(const BenchOptions* options, const DictionaryStorageStats* s) {
+    return s->seeks * options->seek_us + (s->bytes_read + s->bytes_written) * options->byte_us;
+}
+
+// Writes lists of shuffled headwords to a temporary file, then looks them up
+// one by one in list order and as a glossary (sorted runs merged into one
+// join), and checks both write the same number of entries and bytes.
+static int bench_glossary(
+    const BenchOptions* options,
+    Dictionary* dict,
+    DictionaryStorage* storage,
+    const char* words,
+    uint32_t count) {
+    char path[] = "/tmp/dictionary_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if(fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+    char runs_path[] = "/tmp/dictionary_bench_runs_XXXXXX";
+    fd = mkstemp(runs_path);
+    if(fd < 0) {
+        perror("mkstemp");
+        unlink(path);
+        return 1;
+    }
+    close(fd);
+
+    uint32_t state = 4242;
+    for(size_t k = 0; k < sizeof(bench_glossary_sizes) / sizeof(*bench_glossary_sizes); k++) {
+        uint32_t size = bench_glossary_sizes[k];
+        if(size > count) break;
+        FILE* list = fopen(path, "w");
+        for(uint32_t i = 0; i < size; i++) {
+            char word[MAX_WORD_LENGTH];
+            strcpy(word, words + (size_t)i * MAX_WORD_LENGTH);
+            if(i % BENCH_GLOSSARY_MISSPELT == 0) bench_misspell(word, &state);
+            fprintf(list, "%s\n", word);
+        }
+        fclose(list);
+
+        // One by one: a lookup per distinct word, as the app would run them
+        BenchSink single = {0};
+        DictionaryOutput out = {bench_output_write, &single};
+        memset(&storage->stats, 0, sizeof(storage->stats));
+        double t0 = bench_now_us();
+        char* seen = calloc(size, MAX_WORD_LENGTH);
+        uint32_t distinct = 0, found = 0;
+        FILE* again = fopen(path, "r");
+        char line[MAX_WORD_LENGTH + 2];
+        while(fgets(line, sizeof(line), again)) {
+            line[strcspn(line, "\n")] = '\0';
+            bool repeat = line[0] == '\0';
+            for(uint32_t j = 0; j < distinct && !repeat; j++)
+                repeat = strcasecmp(seen + (size_t)j * MAX_WORD_LENGTH, line) == 0;
+            if(repeat) continue;
+            strcpy(seen + (size_t)distinct++ * MAX_WORD_LENGTH, line);
+            if(dictionary_search(dict, line, &out) == DictionaryStatusOk) found++;
+        }
+        fclose(again);
+        free(seen);
+        double single_us = bench_now_us() - t0;
+        DictionaryStorageStats single_stats = storage->stats;
+
+        BenchSink joined = {0};
+        out.context = &joined;
+        DictionaryBatchProgress progress;
+        memset(&storage->stats, 0, sizeof(storage->stats));
+        t0 = bench_now_us();
+        DictionaryStatus status = dictionary_batch_write(
+            dict, path, runs_path, BENCH_GLOSSARY_RAM_BUDGET, &out, NULL, NULL, &progress);
+        double joined_us = bench_now_us() - t0;
+        if(status != DictionaryStatusOk || progress.done != distinct || progress.found != found) {
+            fprintf(
+                stderr,
+                "glossary of %u words: %s, %u of %u written, %u of %u found\n",
+                size,
+                dictionary_status_get_text(status),
+                progress.done,
+                distinct,
+                progress.found,
+                found);
+            unlink(path);
+            unlink(runs_path);
+            return 1;
+        }
+
+        const DictionaryStorageStats* s = &storage->stats;
+        printf("glossary         %u words, %u found, %u runs\n", distinct, found, progress.runs);
+        printf(
+            "  one by one     %u seeks  %u reads  %u bytes  %.0f us, modelled SD %.0f ms\n",
+            single_stats.seeks,
+            single_stats.reads,
+            single_stats.bytes_read,
+            single_us,
+            bench_modelled_total(options, &single_stats) / 1000);
+        printf(
+            "  merge join     %u seeks  %u reads  %u bytes  %u written  %.0f us,"
+            " modelled SD %.0f ms\n",
+            s->seeks,
+            s->reads,
+            s->bytes_read,
+            s->bytes_written,
+            joined_us,
+            bench_modelled_total(options, s) / 1000);
+        // The glossary also notes the missing words
+        printf(
+            "  output         %zu bytes, %zu of entries one by one\n", joined.bytes, single.bytes);
+    }
+    unlink(path);
+    unlink(runs_path);
+    return 0;
+}
+
+static void bench_usage(const char* name) {
+    fprintf(
+        stderr,
+        "usage: %s [-c | -f | -g | -k cache_budget | -p | -r | -w] [-d dir] [-b ram_budget]\n"
+        "          [-s seek_us] [-B byte_us]\n"
+        "  -c  benchmark prefix completion, one update per typed character\n"
+        "  -f  benchmark \"did you mean\" suggestions for misspelt words\n"
+        "  -g  benchmark glossaries of word lists against lookups one by one\n"
+        "  -k  replay lookups with history revisits through a result cache of this size\n"
+        "  -p  benchmark scrolling every result line by line in the result pager\n"
+        "  -r  benchmark reverse lookups, describing headwords by their first gloss\n"
+        "  -w  benchmark wildcard and anagram searches made from headwords\n"
+        "  -d  directory holding engdict.idx/.dat (default: files)\n"
+        "  -b  RAM budget of the key and hash indexes, 0 disables the key index\n"
+        "      (default: 49152)\n"
+        "  -s  modelled SD cost per seek in microseconds (default: 250)\n"
+        "  -B  modelled SD cost per byte in microseconds (default: 0.5)\n",
+        name);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options = {
+        "files", 48 * 1024, 250.0, 0.5, false, false, 0, false, false, false, false};
+    int opt;
+    while((opt = getopt(argc, argv, "cfgk:prwd:b:s:B:h")) != -1) {
+        switch(opt) {
+        case 'c':
+            options.complete = true;
+            break;
+        case 'f':
+            options.fuzzy = true;
+            break;
+        case 'g':
+            options.glossary = true;
+            break;
+        case 'k':
+            options.cache_budget = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            options.pager = true;
+            break;
+        case 'r':
+            options.reverse = true;
+            break;
+        case 'w':
+            options.patterns = true;
+            break;
+        case 'd':
+            options.dir = optarg;
+            break;
+        case 'b':
+            options.ram_budget = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            options.seek_us = strtod(optarg, NULL);
+            break;
+        case 'B':
+            options.byte_us = strtod(optarg, NULL);
+            break;
+        default:
+            bench_usage(argv[0]);
+        }
+    }
+
+    char idx_path[512], dat_path[512];
+    snprintf(idx_path, sizeof(idx_path), "%s/engdict.idx", options.dir);
+    snprintf(dat_path, sizeof(dat_path), "%s/engdict.dat", options.dir);
+
+    DictionaryStorage* storage = dictionary_storage_posix_alloc();
+    uint32_t count;
+    char* words = bench_load_words(storage, idx_path, &count);
+    bench_shuffle(words, count);
+
+    memset(&storage->stats, 0, sizeof(storage->stats));
+    Dictionary* dict = dictionary_alloc(storage, idx_path, dat_path, options.ram_budget);
+    DictionaryStorageStats load = storage->stats;
+    const DictionaryKeyIndex* key_index = dictionary_get_key_index(dict);
+    if(key_index) {
+        printf(
+            "key index        %u/%u blocks resident, load %u reads / %u bytes\n",
+            dictionary_key_index_get_resident_blocks(key_index),
+            dictionary_key_index_get_block_count(key_index),
+            load.reads,
+            load.bytes_read);
+    } else {
+        printf("key index        off\n");
+    }
+    const DictionaryHashIndex* hash_index = dictionary_get_hash_index(dict);
+    if(hash_index) {
+        printf(
+            "hash index       displacements %s, %zu bytes of RAM\n",
+            dictionary_hash_index_is_resident(hash_index) ? "in RAM" : "on SD",
+            dictionary_hash_index_get_size(hash_index));
+    } else {
+        printf("hash index       off\n");
+    }
+    const DictionaryInflections* inflections = dictionary_get_inflections(dict);
+    if(inflections) {
+        printf("inflections      %u forms\n", dictionary_inflections_get_count(inflections));
+    } else {
+        printf("inflections      off\n");
+    }
+    printf(
+        "gloss lists      %s\n",
+        dictionary_get_index_info(dict)->glosses_offset ? "on, each gloss stored once" :
+                                                          "off, one definition per record");
+    if(dictionary_uses_hot_table(dict)) {
+        printf(
+            "hot table        %u words, %zu bytes in the .fap\n",
+            dictionary_hot_get_count(),
+            dictionary_hot_get_size());
+    } else {
+        printf("hot table        off\n");
+    }
+
+    if(options.complete || options.fuzzy || options.cache_budget || options.pager ||
+       options.reverse || options.patterns || options.glossary) {
+        int result = options.complete ? bench_complete(&options, dict, storage, words, count) :
+                     options.fuzzy    ? bench_fuzzy(&options, dict, storage, words, count) :
+                     options.pager    ? bench_pager(&options, dict, storage, words, count) :
+                     options.reverse  ? bench_reverse(&options, dict, storage, words, count) :
+                     options.patterns ? bench_patterns(&options, dict, storage, words, count) :
+                     options.glossary ? bench_glossary(&options, dict, storage, words, count) :
+                                        bench_history(&options, dict, storage, words, count);
+        dictionary_free(dict);
+        dictionary_storage_posix_free(storage);
+        free(words);
+        return result;
+    }
+
+    double* latency = malloc(count * sizeof(double));
+    double* modelled = malloc(count * sizeof(double));
+    DictionaryStorageStats total = {0};
+    BenchSink sink = {0};
+    DictionaryOutput out = {bench_output_write, &sink};
+    uint32_t misses = 0, long_count = 0;
+    double long_sum = 0;
+
+    double start = bench_now_us();
+    for(uint32_t i = 0; i < count; i++) {
+        memset(&storage->stats, 0, sizeof(storage->stats));
+        size_t sink_bytes = sink.bytes;
+        double t0 = bench_now_us();
+        if(dictionary_search(dict, words + (size_t)i * MAX_WORD_LENGTH, &out) !=
+           DictionaryStatusOk) {
+            misses++;
+        }
+        latency[i] = bench_now_us() - t0;
+
+        const DictionaryStorageStats* s = &storage->stats;
+        modelled[i] = s->seeks * options.seek_us + s->bytes_read * options.byte_us;
+        if(sink.bytes - sink_bytes >= BENCH_LONG_RESULT) {
+            long_count++;
+            long_sum += modelled[i];
+        }
+        total.opens += s->opens;
+        total.seeks += s->seeks;
+        total.reads += s->reads;
+        total.bytes_read += s->bytes_read;
+    }
+    double elapsed = bench_now_us() - start;
+
+    qsort(latency, count, sizeof(double), bench_compare_double);
+    printf("lookups          %u (%u misses)\n", count, misses);
+    printf("lookups/sec      %.0f\n", count / (elapsed / 1e6));
+    printf(
+        "latency us       p50 %.2f  p99 %.2f\n",
+        bench_percentile(latency, count, 0.50),
+        bench_percentile(latency, count, 0.99));
+    printf(
+        "per lookup       %.2f opens  %.2f seeks  %.2f reads  %.0f bytes\n",
+        (double)total.opens / count,
+        (double)total.seeks / count,
+        (double)total.reads / count,
+        (double)total.bytes_read / count);
+    bench_print_modelled(&options, modelled, count);
+    if(long_count) {
+        printf(
+            "long results     %u of %u bytes or more, modelled SD mean %.0f us\n",
+            long_count,
+            BENCH_LONG_RESULT,
+            long_sum / long_count);
+    }
+    const DictionaryBlocks* blocks = dictionary_get_blocks(dict);
+    if(blocks) {
+        const DictionaryBlocksStats* b = dictionary_blocks_get_stats(blocks);
+        printf(
+            "engdict.dat      %u blocks of %u bytes, %zu bytes RAM\n",
+            b->block_count,
+            b->block_size,
+            b->ram);
+        printf(
+            "per lookup       %.2f blocks decoded (%u reused), %.0f bytes decoded\n",
+            (double)b->blocks_decoded / count,
+            b->blocks_reused,
+            (double)b->bytes_decoded / count);
+    }
+
+    dictionary_free(dict);
+    dictionary_storage_posix_free(storage);
+    free(latency);
+    free(modelled);
+    free(words);
+    return misses ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+#include "dictionary_storage_posix.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct DictionaryFile {
+    int fd;
+    bool failed;
+};
+
+static DictionaryFile* dictionary_storage_posix_open_flags(const char* path, int flags) {
+    int fd = open(path, flags, 0644);
+    if(fd < 0) return NULL;
+    DictionaryFile* file = malloc(sizeof(DictionaryFile));
+    file->fd = fd;
+    file->failed = false;
+    return file;
+}
+
+static DictionaryFile* dictionary_storage_posix_open(void* context, const char* path) {
+    (void)context;
+    return dictionary_storage_posix_open_flags(path, O_RDONLY);
+}
+
+static DictionaryFile* dictionary_storage_posix_create(void* context, const char* path) {
+    (void)context;
+    return dictionary_storage_posix_open_flags(path, O_RDWR | O_CREAT | O_TRUNC);
+}
+
+static void dictionary_storage_posix_close(void* context, DictionaryFile* file) {
+    (void)context;
+    close(file->fd);
+    free(file);
+}
+
+static bool dictionary_storage_posix_seek(void* context, DictionaryFile* file, uint32_t offset) {
+    (void)context;
+    if(lseek(file->fd, (off_t)offset, SEEK_SET) == (off_t)offset) return true;
+    file->failed = true;
+    return false;
+}
+
+static size_t
+    dictionary_storage_posix_read(void* context, DictionaryFile* file, void* buffer, size_t size) {
+    (void)context;
+    size_t total = 0;
+    while(total < size) {
+        ssize_t got = read(file->fd, (char*)buffer + total, size - total);
+        if(got < 0) file->failed = true;
+        if(got <= 0) break;
+        total += (size_t)got;
+    }
+    return total;
+}
+
+static size_t dictionary_storage_posix_write(
+    void* context,
+    DictionaryFile* file,
+    const void* buffer,
+    size_t size) {
+    (void)context;
+    size_t total = 0;
+    while(total < size) {
+        ssize_t put = write(file->fd, (const char*)buffer + total, size - total);
+        if(put <= 0) {
+            file->failed = true;
+            break;
+        }
+        total += (size_t)put;
+    }
+    return total;
+}
+
+static uint32_t dictionary_storage_posix_size(void* context, DictionaryFile* file) {
+    (void)context;
+    struct stat st;
+    return fstat(file->fd, &st) == 0 ? (uint32_t)st.st_size : 0;
+}
+
+static bool dictionary_storage_posix_failed(void* context, DictionaryFile* file) {
+    (void)context;
+    return file->failed;
+}
+
+static void dictionary_storage_posix_reset(void* context, DictionaryFile* file) {
+    (void)context;
+    file->failed = false;
+}
+
+static bool dictionary_storage_posix_remove(void* context, const char* path) {
+    (void)context;
+    return unlink(path) == 0;
+}
+
+static const DictionaryStorageApi dictionary_storage_posix_api = {
+    .open = dictionary_storage_posix_open,
+    .close = dictionary_storage_posix_close,
+    .seek = dictionary_storage_posix_seek,
+    .read = dictionary_storage_posix_read,
+    .size = dictionary_storage_posix_size,
+    .failed = dictionary_storage_posix_failed,
+    .reset = dictionary_storage_posix_reset,
+    .create = dictionary_storage_posix_create,
+    .write = dictionary_storage_posix_write,
+    .remove = dictionary_storage_posix_remove,
+};
+
+DictionaryStorage* dictionary_storage_posix_alloc(void) {
+    DictionaryStorage* storage = calloc(1, sizeof(DictionaryStorage));
+    storage->api = &dictionary_storage_posix_api;
+    return storage;
+}
+
+void dictionary_storage_posix_free(DictionaryStorage* storage) {
+    free(storage);
+}
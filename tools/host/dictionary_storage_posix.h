@@ -0,0 +1,8 @@
+#pragma once
+
+#include "../../dictionary_storage.h"
+
+// DictionaryStorage over POSIX file descriptors; paths are used as given
+DictionaryStorage* dictionary_storage_posix_alloc(void);
+
+void dictionary_storage_posix_free(DictionaryStorage* storage);